@@ -84,6 +84,9 @@ typedef enum {
  * add_quad callbacks will then be called for each new vertex and
  * quad, and the callback should add the new mesh elements to the
  * structure.
+ *
+ * The octree is built and the output generated by 'threads' threads,
+ * zero uses all cores.
  */
 void *dualcon(const DualConInput *input_mesh,
               /* callbacks for output */
@@ -98,7 +101,8 @@ void *dualcon(const DualConInput *input_mesh,
               float threshold,
               float hermite_num,
               float scale,
-              int depth);
+              int depth,
+              int threads);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,147 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Threads which are started once and reused for every parallel loop.
+ * The calling thread takes part in the loops too.
+ */
+class WorkerPool
+{
+ public:
+	/* A thread count of zero or less uses all cores */
+	WorkerPool(int num_threads)
+		: func(NULL), tot(0), next(0), generation(0), busy(0), quit(false)
+	{
+		if (num_threads <= 0) {
+			num_threads = (int)std::thread::hardware_concurrency();
+		}
+		for (int t = 1; t < num_threads; t++) {
+			threads.push_back(std::thread(&WorkerPool::worker, this));
+		}
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		start_cond.notify_all();
+		for (size_t t = 0; t < threads.size(); t++) {
+			threads[t].join();
+		}
+	}
+
+	int getNumThreads() const
+	{
+		return (int)threads.size() + 1;
+	}
+
+	/**
+	 * Call loop_func(i) for every i in [0, loop_tot), returns when all calls are done.
+	 * The calls run in no particular order.
+	 */
+	void parallel_for(int loop_tot, const std::function<void(int)>& loop_func)
+	{
+		if (threads.empty() || loop_tot <= 1) {
+			for (int i = 0; i < loop_tot; i++) {
+				loop_func(i);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			func = &loop_func;
+			tot = loop_tot;
+			next = 0;
+			busy = (int)threads.size();
+			generation++;
+		}
+		start_cond.notify_all();
+
+		run();
+
+		/* every worker finishes the loop before the next one can start */
+		std::unique_lock<std::mutex> lock(mutex);
+		done_cond.wait(lock, [this] { return busy == 0; });
+		func = NULL;
+	}
+
+ private:
+	void run()
+	{
+		int i;
+		while ((i = next++) < tot) {
+			(*func)(i);
+		}
+	}
+
+	void worker()
+	{
+		int seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+			start_cond.wait(lock, [&] { return quit || generation != seen; });
+			if (quit) {
+				return;
+			}
+			seen = generation;
+
+			lock.unlock();
+			run();
+			lock.lock();
+
+			if (--busy == 0) {
+				done_cond.notify_one();
+			}
+		}
+	}
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable start_cond, done_cond;
+
+	/* the current loop */
+	const std::function<void(int)> *func;
+	int tot;
+	std::atomic<int> next;
+
+	int generation;
+	int busy;
+	bool quit;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("DUALCON:WorkerPool")
+#endif
+};
+
+#endif /* __WORKERPOOL_H__ */
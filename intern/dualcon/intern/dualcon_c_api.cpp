@@ -177,11 +177,12 @@ void *dualcon(const DualConInput *input_mesh,
               float threshold,
               float hermite_num,
               float scale,
-              int depth)
+              int depth,
+              int threads)
 {
 	DualConInputReader r(input_mesh, scale);
 	Octree o(&r, alloc_output, add_vert, add_quad,
-	         flags, mode, depth, threshold, hermite_num);
+	         flags, mode, depth, threshold, hermite_num, threads);
 	o.scanConvert();
 	return o.getOutputMesh();
 }
@@ -26,8 +26,8 @@
 
 #include "octree.h"
 #include <Eigen/Dense>
+#include <chrono>
 #include <limits>
-#include <time.h>
 
 /**
  * Implementations of Octree member functions.
@@ -46,13 +46,32 @@
 #define dc_printf(...) do {} while (0)
 #endif
 
+/* Number of triangles which are projected at once while scan converting */
+#define TRIANGLE_BATCH_SIZE 4096
+
+/* Subtrees at this level are built by separate threads while scan converting */
+#define SCAN_PARALLEL_LEVEL 2
+
+/* Subtrees at this level are written out by separate threads */
+#define OUTPUT_PARALLEL_LEVEL 2
+
+#if DC_DEBUG
+/* Wall clock time, clock() adds up the time of all threads */
+static double time_seconds()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
 Octree::Octree(ModelReader *mr,
                DualConAllocOutput alloc_output_func,
                DualConAddVert add_vert_func,
                DualConAddQuad add_quad_func,
                DualConFlags flags, DualConMode dualcon_mode, int depth,
-               float threshold, float sharpness)
-	: use_flood_fill(flags & DUALCON_FLOOD_FILL),
+               float threshold, float sharpness, int num_threads)
+	: pool(num_threads),
+	use_flood_fill(flags & DUALCON_FLOOD_FILL),
 	/* note on `use_manifold':
 
 	   After playing around with this option, the only case I could
@@ -114,8 +133,9 @@ void Octree::scanConvert()
 {
 	// Scan triangles
 #if DC_DEBUG
-	clock_t start, finish;
-	start = clock();
+	double start, finish;
+	start = time_seconds();
+	dc_printf("Using %d threads\n", pool.getNumThreads());
 #endif
 
 	addAllTriangles();
@@ -123,21 +143,21 @@ void Octree::scanConvert()
 	preparePrimalEdgesMask(&root->internal);
 
 #if DC_DEBUG
-	finish = clock();
+	finish = time_seconds();
 	dc_printf("Time taken: %f seconds                   \n",
-	          (double)(finish - start) / CLOCKS_PER_SEC);
+	          finish - start);
 #endif
 
 	// Generate signs
 	// Find holes
 #if DC_DEBUG
 	dc_printf("Patching...\n");
-	start = clock();
+	start = time_seconds();
 #endif
 	trace();
 #if DC_DEBUG
-	finish = clock();
-	dc_printf("Time taken: %f seconds \n",  (double)(finish - start) / CLOCKS_PER_SEC);
+	finish = time_seconds();
+	dc_printf("Time taken: %f seconds \n",  finish - start);
 #ifdef IN_VERBOSE_MODE
 	dc_printf("Holes: %d Average Length: %f Max Length: %d \n", numRings, (float)totRingLengths / (float) numRings, maxRingLength);
 #endif
@@ -153,17 +173,17 @@ void Octree::scanConvert()
 
 #if DC_DEBUG
 	dc_printf("Building signs...\n");
-	start = clock();
+	start = time_seconds();
 #endif
 	buildSigns();
 #if DC_DEBUG
-	finish = clock();
-	dc_printf("Time taken: %f seconds \n",  (double)(finish - start) / CLOCKS_PER_SEC);
+	finish = time_seconds();
+	dc_printf("Time taken: %f seconds \n",  finish - start);
 #endif
 
 	if (use_flood_fill) {
 		/*
-		   start = clock();
+		   start = time_seconds();
 		   floodFill();
 		   // Check again
 		   tnumRings = numRings;
@@ -171,11 +191,11 @@ void Octree::scanConvert()
 		   dc_printf("Holes after filling: %d \n", numRings);
 		   numRings = tnumRings;
 		   buildSigns();
-		   finish = clock();
-		   dc_printf("Time taken: %f seconds \n",	(double)(finish - start) / CLOCKS_PER_SEC);
+		   finish = time_seconds();
+		   dc_printf("Time taken: %f seconds \n",	finish - start);
 		 */
 #if DC_DEBUG
-		start = clock();
+		start = time_seconds();
 		dc_printf("Removing components...\n");
 #endif
 		floodFill();
@@ -183,20 +203,20 @@ void Octree::scanConvert()
 		//	dc_printf("Checking...\n");
 		//	floodFill();
 #if DC_DEBUG
-		finish = clock();
-		dc_printf("Time taken: %f seconds \n", (double)(finish - start) / CLOCKS_PER_SEC);
+		finish = time_seconds();
+		dc_printf("Time taken: %f seconds \n", finish - start);
 #endif
 	}
 
 	// Output
 #if DC_DEBUG
-	start = clock();
+	start = time_seconds();
 #endif
 	writeOut();
 #if DC_DEBUG
-	finish = clock();
+	finish = time_seconds();
+	dc_printf("Time taken: %f seconds \n", finish - start);
 #endif
-	// dc_printf("Time taken: %f seconds \n",	(double)(finish - start) / CLOCKS_PER_SEC);
 
 	// Print info
 #ifdef IN_VERBOSE_MODE
@@ -269,61 +289,174 @@ void Octree::addAllTriangles()
 
 #if DC_DEBUG
 	int total = reader->getNumTriangles();
-	int unitcount = 1000;
 	dc_printf("\nScan converting to depth %d...\n", maxDepth);
 #endif
 
 	srand(0);
 
-	while ((trian = reader->getNextTriangle()) != NULL) {
-		// Drop triangles
-		{
-			addTriangle(trian, count);
+	/* Triangles are added in batches: their projections are calculated in parallel,
+	 * then the subtrees SCAN_PARALLEL_LEVEL levels below the root are built in parallel.
+	 * Every subtree gets the triangles in the same order as when adding them one by one,
+	 * so the octree doesn't depend on the number of threads. */
+	const int level = std::min(maxDepth, SCAN_PARALLEL_LEVEL);
+	const int totcell = 1 << (3 * level);
+	std::vector<Triangle *> trians;
+	std::vector<CubeTriangleIsect *> projs;
+	std::vector<uint64_t> masks;
+	std::vector<int> cells;
+	trians.reserve(TRIANGLE_BATCH_SIZE);
+
+	bool done = false;
+	while (!done) {
+		trians.clear();
+		while (trians.size() < TRIANGLE_BATCH_SIZE) {
+			if ((trian = reader->getNextTriangle()) == NULL) {
+				done = true;
+				break;
+			}
+			trians.push_back(trian);
+		}
+
+		const int tot = (int)trians.size();
+		projs.resize(tot);
+		masks.resize(tot);
+
+		/* Project the triangles and find the subtrees they intersect,
+		 * cell j * 8 + k is child k of child j of the root */
+		pool.parallel_for(tot, [&](int i) {
+			CubeTriangleIsect *proj = projectTriangle(trians[i], count + i);
+			unsigned char boxmask = proj->getBoxMask();
+			uint64_t mask = 0;
+
+			for (int j = 0; j < 8; j++) {
+				if (boxmask & (1 << j)) {
+					CubeTriangleIsect subp(proj);
+					int off[3] = {vertmap[j][0], vertmap[j][1], vertmap[j][2]};
+					subp.shift(off);
+					if (!subp.isIntersecting()) {
+						continue;
+					}
+					if (level == 1) {
+						mask |= (uint64_t)1 << j;
+						continue;
+					}
+
+					unsigned char subboxmask = subp.getBoxMask();
+					for (int k = 0; k < 8; k++) {
+						if (subboxmask & (1 << k)) {
+							CubeTriangleIsect subsubp(&subp);
+							int suboff[3] = {vertmap[k][0], vertmap[k][1], vertmap[k][2]};
+							subsubp.shift(suboff);
+							if (subsubp.isIntersecting()) {
+								mask |= (uint64_t)1 << (j * 8 + k);
+							}
+						}
+					}
+				}
+			}
+
+			projs[i] = proj;
+			masks[i] = mask;
+			delete trians[i];
+		});
+
+		uint64_t mask_all = 0;
+		for (int i = 0; i < tot; i++) {
+			mask_all |= masks[i];
 		}
-		delete trian;
 
-		count++;
+		/* Nodes down to the subtrees are created beforehand, adding a child reallocates its parent */
+		InternalNode *rnode = &root->internal;
+		cells.clear();
+		for (int c = 0; c < totcell; c++) {
+			if (!(mask_all & ((uint64_t)1 << c))) {
+				continue;
+			}
+			cells.push_back(c);
+
+			const int j = (level == 2) ? c / 8 : c;
+			if (!rnode->has_child(j)) {
+				int chd_count = rnode->get_child_count(j);
+				if (maxDepth == 1)
+					rnode = addLeafChild(rnode, j, chd_count, createLeaf(0));
+				else
+					rnode = addInternalChild(rnode, j, chd_count, createInternal(0));
+			}
 
-#if DC_DEBUG
-		if (count % unitcount == 0) {
-			putchar(13);
-
-			switch ((count / unitcount) % 4) {
-				case 0: dc_printf("-");
-					break;
-				case 1: dc_printf("/");
-					break;
-				case 2: dc_printf("|");
-					break;
-				case 3: dc_printf("\\");
-					break;
+			if (level == 2) {
+				const int k = c % 8;
+				const int chd_count = rnode->get_child_count(j);
+				InternalNode *node = &rnode->get_child(chd_count)->internal;
+				if (!node->has_child(k)) {
+					int subchd_count = node->get_child_count(k);
+					if (maxDepth == 2)
+						node = addLeafChild(node, k, subchd_count, createLeaf(0));
+					else
+						node = addInternalChild(node, k, subchd_count, createInternal(0));
+					rnode->set_child(chd_count, (Node *)node);
+				}
+			}
+		}
+		root = (Node *)rnode;
+
+		/* Add the triangles to the subtrees */
+		pool.parallel_for((int)cells.size(), [&](int i) {
+			const int c = cells[i];
+			const uint64_t bit = (uint64_t)1 << c;
+			InternalNode *node = &root->internal;
+			int path[2] = {c, 0};
+
+			if (level == 2) {
+				path[0] = c / 8;
+				path[1] = c % 8;
+				node = &node->get_child(node->get_child_count(path[0]))->internal;
 			}
 
-			float percent = (float) count / total;
+			const int j = path[level - 1];
+			const int chd_count = node->get_child_count(j);
+			Node *chd = node->get_child(chd_count);
+			int off[3] = {vertmap[path[0]][0], vertmap[path[0]][1], vertmap[path[0]][2]};
+			int suboff[3] = {vertmap[path[1]][0], vertmap[path[1]][1], vertmap[path[1]][2]};
 
-			/*
-			   int totbars = 50;
-			   int bars =(int)(percent * totbars);
-			   for(int i = 0; i < bars; i ++) {
-			    putchar(219);
-			   }
-			   for(i = bars; i < totbars; i ++) {
-			    putchar(176);
-			   }
-			 */
+			for (int t = 0; t < tot; t++) {
+				if (!(masks[t] & bit)) {
+					continue;
+				}
+
+				CubeTriangleIsect subp(projs[t]);
+				subp.shift(off);
+				CubeTriangleIsect subsubp(&subp);
+				subsubp.shift(suboff);
+				CubeTriangleIsect *p = (level == 2) ? &subsubp : &subp;
 
-			dc_printf(" %d triangles: ", count);
-			dc_printf(" %f%% complete.", 100 * percent);
+				if (node->is_child_leaf(j))
+					chd = (Node *)updateCell(&chd->leaf, p);
+				else
+					chd = (Node *)addTriangle(&chd->internal, p, maxDepth - level);
+			}
+
+			node->set_child(chd_count, chd);
+		});
+
+		for (int i = 0; i < tot; i++) {
+			delete projs[i]->inherit;
+			delete projs[i];
 		}
-#endif
 
+		count += tot;
+
+#if DC_DEBUG
+		dc_printf(" %d triangles: ", count);
+		dc_printf(" %f%% complete.", 100 * (float)count / total);
+		putchar(13);
+#endif
 	}
 	putchar(13);
 }
 
-/* Prepare a triangle for insertion into the octree; call the other
-   addTriangle() to (recursively) build the octree */
-void Octree::addTriangle(Triangle *trian, int triind)
+/* Prepare a triangle for insertion into the octree, the projection
+   is passed to addTriangle() to (recursively) build the octree */
+CubeTriangleIsect *Octree::projectTriangle(Triangle *trian, int triind)
 {
 	int i, j;
 
@@ -341,13 +474,8 @@ void Octree::addTriangle(Triangle *trian, int triind)
 			trig[i][j] = (int64_t)(trian->vt[i][j]);
 	}
 
-	/* Add triangle to the octree */
 	int64_t errorvec = (int64_t)(0);
-	CubeTriangleIsect *proj = new CubeTriangleIsect(cube, trig, errorvec, triind);
-	root = (Node *)addTriangle(&root->internal, proj, maxDepth);
-
-	delete proj->inherit;
-	delete proj;
+	return new CubeTriangleIsect(cube, trig, errorvec, triind);
 }
 
 #if 0
@@ -2045,27 +2173,214 @@ int Octree::floodFill(Node *node, int st[3], int len, int height, int threshold)
 
 }
 
+/* A subtree for counting and generating vertices */
+struct Octree::CellJob {
+	Node *node;
+	int st[3];
+	int len;
+	int height;
+
+	/* Counts and the index of the first vertex in the subtree */
+	int nedge, ncell, nface;
+	int offset;
+};
+
+enum {
+	CONTOUR_JOB_CELL,
+	CONTOUR_JOB_FACE,
+	CONTOUR_JOB_EDGE,
+};
+
+/* A cell, face or edge call of the contour traversal, with the quads it generates */
+struct Octree::ContourJob {
+	int type;
+	Node *node[4];
+	int leaf[4];
+	int depth[4];
+	int maxdep;
+	int dir;
+
+	std::vector<int> quads;
+};
+
 void Octree::writeOut()
 {
 	int numQuads = 0;
 	int numVertices = 0;
 	int numEdges = 0;
+	int st[3] = {0, 0, 0};
 
-	countIntersection(root, maxDepth, numQuads, numVertices, numEdges);
+	/* Subtrees are counted and their vertices generated in parallel,
+	 * the vertices are added in the same order as a single traversal would. */
+	std::vector<CellJob> cell_jobs;
+	collectCellJobs(root, st, dimen, maxDepth, OUTPUT_PARALLEL_LEVEL, cell_jobs);
+
+	pool.parallel_for((int)cell_jobs.size(), [&](int i) {
+		CellJob &job = cell_jobs[i];
+		job.nedge = job.ncell = job.nface = 0;
+		countIntersection(job.node, job.height, job.nedge, job.ncell, job.nface);
+	});
+
+	for (size_t i = 0; i < cell_jobs.size(); i++) {
+		cell_jobs[i].offset = numVertices;
+		numQuads += cell_jobs[i].nedge;
+		numVertices += cell_jobs[i].ncell;
+		numEdges += cell_jobs[i].nface;
+	}
 
 	dc_printf("Vertices counted: %d Polys counted: %d \n", numVertices, numQuads);
 	output_mesh = alloc_output(numVertices, numQuads);
-	int offset = 0;
-	int st[3] = {0, 0, 0};
 
 	// First, output vertices
-	offset = 0;
 	actualVerts = 0;
 	actualQuads = 0;
 
-	generateMinimizer(root, st, dimen, maxDepth, offset);
-	cellProcContour(root, 0, maxDepth);
-	dc_printf("Vertices written: %d Quads written: %d \n", offset, actualQuads);
+	float (*verts)[3] = new float[numVertices][3];
+
+	/* the minimizers use Eigen from multiple threads */
+	Eigen::initParallel();
+
+	pool.parallel_for((int)cell_jobs.size(), [&](int i) {
+		CellJob &job = cell_jobs[i];
+		int offset = job.offset;
+		generateMinimizer(job.node, job.st, job.len, job.height, offset, verts);
+	});
+
+	for (actualVerts = 0; actualVerts < numVertices; actualVerts++) {
+		add_vert(output_mesh, verts[actualVerts]);
+	}
+
+	delete[] verts;
+
+	/* Then the quads, each job writes into its own array,
+	 * these are added in the order of a single traversal. */
+	std::vector<ContourJob> contour_jobs;
+	collectContourJobs(root, 0, maxDepth, OUTPUT_PARALLEL_LEVEL, contour_jobs);
+
+	pool.parallel_for((int)contour_jobs.size(), [&](int i) {
+		ContourJob &job = contour_jobs[i];
+		switch (job.type) {
+			case CONTOUR_JOB_CELL:
+				cellProcContour(job.node[0], job.leaf[0], job.depth[0], job.quads);
+				break;
+			case CONTOUR_JOB_FACE:
+				faceProcContour(job.node, job.leaf, job.depth, job.maxdep, job.dir, job.quads);
+				break;
+			case CONTOUR_JOB_EDGE:
+				edgeProcContour(job.node, job.leaf, job.depth, job.maxdep, job.dir, job.quads);
+				break;
+		}
+	});
+
+	for (size_t i = 0; i < contour_jobs.size(); i++) {
+		std::vector<int> &quads = contour_jobs[i].quads;
+		for (size_t j = 0; j < quads.size(); j += 4) {
+			add_quad(output_mesh, &quads[j]);
+		}
+		actualQuads += (int)(quads.size() / 4);
+		std::vector<int>().swap(quads);
+	}
+
+	dc_printf("Vertices written: %d Quads written: %d \n", actualVerts, actualQuads);
+}
+
+void Octree::collectCellJobs(Node *node, int st[3], int len, int height, int level,
+                             std::vector<CellJob>& jobs)
+{
+	if (height == 0 || level == 0) {
+		CellJob job;
+		job.node = node;
+		job.st[0] = st[0];
+		job.st[1] = st[1];
+		job.st[2] = st[2];
+		job.len = len;
+		job.height = height;
+		jobs.push_back(job);
+		return;
+	}
+
+	int count = 0;
+	len >>= 1;
+	for (int i = 0; i < 8; i++) {
+		if (node->internal.has_child(i)) {
+			int nst[3];
+			nst[0] = st[0] + vertmap[i][0] * len;
+			nst[1] = st[1] + vertmap[i][1] * len;
+			nst[2] = st[2] + vertmap[i][2] * len;
+
+			collectCellJobs(node->internal.get_child(count), nst, len, height - 1, level - 1, jobs);
+			count++;
+		}
+	}
+}
+
+/* Same traversal as cellProcContour(), down to 'level' */
+void Octree::collectContourJobs(Node *node, int leaf, int depth, int level,
+                                std::vector<ContourJob>& jobs)
+{
+	if (node == NULL || leaf) {
+		return;
+	}
+
+	if (level == 0) {
+		ContourJob job = ContourJob();
+		job.type = CONTOUR_JOB_CELL;
+		job.node[0] = node;
+		job.leaf[0] = leaf;
+		job.depth[0] = depth;
+		jobs.push_back(job);
+		return;
+	}
+
+	int i;
+
+	// Fill children nodes
+	Node *chd[8];
+	for (i = 0; i < 8; i++) {
+		chd[i] = node->internal.has_child(i) ?
+		         node->internal.get_child(node->internal.get_child_count(i)) : NULL;
+	}
+
+	// 8 Cell calls
+	for (i = 0; i < 8; i++) {
+		collectContourJobs(chd[i], node->internal.is_child_leaf(i), depth - 1, level - 1, jobs);
+	}
+
+	// 12 face calls
+	for (i = 0; i < 12; i++) {
+		int c[2] = {cellProcFaceMask[i][0], cellProcFaceMask[i][1]};
+
+		if (chd[c[0]] && chd[c[1]]) {
+			ContourJob job = ContourJob();
+			job.type = CONTOUR_JOB_FACE;
+			for (int j = 0; j < 2; j++) {
+				job.node[j] = chd[c[j]];
+				job.leaf[j] = node->internal.is_child_leaf(c[j]);
+				job.depth[j] = depth - 1;
+			}
+			job.maxdep = depth - 1;
+			job.dir = cellProcFaceMask[i][2];
+			jobs.push_back(job);
+		}
+	}
+
+	// 6 edge calls
+	for (i = 0; i < 6; i++) {
+		int c[4] = {cellProcEdgeMask[i][0], cellProcEdgeMask[i][1], cellProcEdgeMask[i][2], cellProcEdgeMask[i][3]};
+
+		if (chd[c[0]] && chd[c[1]] && chd[c[2]] && chd[c[3]]) {
+			ContourJob job = ContourJob();
+			job.type = CONTOUR_JOB_EDGE;
+			for (int j = 0; j < 4; j++) {
+				job.node[j] = chd[c[j]];
+				job.leaf[j] = node->internal.is_child_leaf(c[j]);
+				job.depth[j] = depth - 1;
+			}
+			job.maxdep = depth - 1;
+			job.dir = cellProcEdgeMask[i][4];
+			jobs.push_back(job);
+		}
+	}
 }
 
 void Octree::countIntersection(Node *node, int height, int& nedge, int& ncell, int& nface)
@@ -2257,7 +2572,8 @@ void Octree::computeMinimizer(const LeafNode *leaf, int st[3], int len,
 	}
 }
 
-void Octree::generateMinimizer(Node *node, int st[3], int len, int height, int& offset)
+void Octree::generateMinimizer(Node *node, int st[3], int len, int height, int& offset,
+                               float (*verts)[3])
 {
 	int i, j;
 
@@ -2290,7 +2606,9 @@ void Octree::generateMinimizer(Node *node, int st[3], int len, int height, int&
 		}
 
 		for (j = 0; j < mult; j++) {
-			add_vert(output_mesh, rvalue);
+			verts[offset + j][0] = rvalue[0];
+			verts[offset + j][1] = rvalue[1];
+			verts[offset + j][2] = rvalue[2];
 		}
 
 		// Store the index
@@ -2310,14 +2628,15 @@ void Octree::generateMinimizer(Node *node, int st[3], int len, int height, int&
 				nst[2] = st[2] + vertmap[i][2] * len;
 
 				generateMinimizer(node->internal.get_child(count),
-				                  nst, len, height - 1, offset);
+				                  nst, len, height - 1, offset, verts);
 				count++;
 			}
 		}
 	}
 }
 
-void Octree::processEdgeWrite(Node *node[4], int /*depth*/[4], int /*maxdep*/, int dir)
+void Octree::processEdgeWrite(Node *node[4], int /*depth*/[4], int /*maxdep*/, int dir,
+                              std::vector<int>& quads)
 {
 	//int color = 0;
 
@@ -2369,7 +2688,7 @@ void Octree::processEdgeWrite(Node *node[4], int /*depth*/[4], int /*maxdep*/, i
 						ind[3] = getMinimizerIndex((LeafNode *)(node[2]));
 					}
 
-					add_quad(output_mesh, ind);
+					quads.insert(quads.end(), ind, ind + 4);
 				}
 			}
 			return;
@@ -2381,13 +2700,14 @@ void Octree::processEdgeWrite(Node *node[4], int /*depth*/[4], int /*maxdep*/, i
 }
 
 
-void Octree::edgeProcContour(Node *node[4], int leaf[4], int depth[4], int maxdep, int dir)
+void Octree::edgeProcContour(Node *node[4], int leaf[4], int depth[4], int maxdep, int dir,
+                             std::vector<int>& quads)
 {
 	if (!(node[0] && node[1] && node[2] && node[3])) {
 		return;
 	}
 	if (leaf[0] && leaf[1] && leaf[2] && leaf[3]) {
-		processEdgeWrite(node, depth, maxdep, dir);
+		processEdgeWrite(node, depth, maxdep, dir, quads);
 	}
 	else {
 		int i, j;
@@ -2423,13 +2743,14 @@ void Octree::edgeProcContour(Node *node[4], int leaf[4], int depth[4], int maxde
 				}
 			}
 
-			edgeProcContour(ne, le, de, maxdep - 1, edgeProcEdgeMask[dir][i][4]);
+			edgeProcContour(ne, le, de, maxdep - 1, edgeProcEdgeMask[dir][i][4], quads);
 		}
 
 	}
 }
 
-void Octree::faceProcContour(Node *node[2], int leaf[2], int depth[2], int maxdep, int dir)
+void Octree::faceProcContour(Node *node[2], int leaf[2], int depth[2], int maxdep, int dir,
+                             std::vector<int>& quads)
 {
 	if (!(node[0] && node[1])) {
 		return;
@@ -2465,7 +2786,7 @@ void Octree::faceProcContour(Node *node[2], int leaf[2], int depth[2], int maxde
 					df[j] = depth[j] - 1;
 				}
 			}
-			faceProcContour(nf, lf, df, maxdep - 1, faceProcFaceMask[dir][i][2]);
+			faceProcContour(nf, lf, df, maxdep - 1, faceProcFaceMask[dir][i][2], quads);
 		}
 
 		// 4 edge calls
@@ -2492,13 +2813,13 @@ void Octree::faceProcContour(Node *node[2], int leaf[2], int depth[2], int maxde
 				}
 			}
 
-			edgeProcContour(ne, le, de, maxdep - 1, faceProcEdgeMask[dir][i][5]);
+			edgeProcContour(ne, le, de, maxdep - 1, faceProcEdgeMask[dir][i][5], quads);
 		}
 	}
 }
 
 
-void Octree::cellProcContour(Node *node, int leaf, int depth)
+void Octree::cellProcContour(Node *node, int leaf, int depth, std::vector<int>& quads)
 {
 	if (node == NULL) {
 		return;
@@ -2516,7 +2837,7 @@ void Octree::cellProcContour(Node *node, int leaf, int depth)
 
 		// 8 Cell calls
 		for (i = 0; i < 8; i++) {
-			cellProcContour(chd[i], node->internal.is_child_leaf(i), depth - 1);
+			cellProcContour(chd[i], node->internal.is_child_leaf(i), depth - 1, quads);
 		}
 
 		// 12 face calls
@@ -2532,7 +2853,7 @@ void Octree::cellProcContour(Node *node, int leaf, int depth)
 			nf[0] = chd[c[0]];
 			nf[1] = chd[c[1]];
 
-			faceProcContour(nf, lf, df, depth - 1, cellProcFaceMask[i][2]);
+			faceProcContour(nf, lf, df, depth - 1, cellProcFaceMask[i][2], quads);
 		}
 
 		// 6 edge calls
@@ -2547,7 +2868,7 @@ void Octree::cellProcContour(Node *node, int leaf, int depth)
 				ne[j] = chd[c[j]];
 			}
 
-			edgeProcContour(ne, le, de, depth - 1, cellProcEdgeMask[i][4]);
+			edgeProcContour(ne, le, de, depth - 1, cellProcEdgeMask[i][4], quads);
 		}
 	}
 
@@ -25,6 +25,8 @@
 
 #include <cassert>
 #include <cstring>
+#include <mutex>
+#include <vector>
 #include <stdio.h>
 #include <math.h>
 #include "GeoCommon.h"
@@ -34,6 +36,7 @@
 #include "cubes.h"
 #include "Queue.h"
 #include "manifold_table.h"
+#include "WorkerPool.h"
 #include "dualcon.h"
 
 /**
@@ -234,6 +237,11 @@ class Octree
 	/// Memory allocators
 	VirtualMemoryAllocator *alloc[9];
 	VirtualMemoryAllocator *leafalloc[4];
+	/// Lock for the allocators, nodes are created from multiple threads while scan converting
+	std::mutex alloc_mutex;
+
+	/// Threads for scan converting and writing out
+	WorkerPool pool;
 
 	/// Root node
 	Node *root;
@@ -286,7 +294,7 @@ class Octree
 		   DualConAddVert add_vert_func,
 		   DualConAddQuad add_quad_func,
 		   DualConFlags flags, DualConMode mode, int depth,
-		   float threshold, float hermite_num);
+		   float threshold, float hermite_num, int num_threads);
 
 	/**
 	 * Destructor
@@ -336,7 +344,7 @@ class Octree
 	 * Add triangles to the tree
 	 */
 	void addAllTriangles();
-	void addTriangle(Triangle *trian, int triind);
+	CubeTriangleIsect *projectTriangle(Triangle *trian, int triind);
 	InternalNode *addTriangle(InternalNode *node, CubeTriangleIsect *p, int height);
 
 	/**
@@ -421,17 +429,28 @@ class Octree
 	void writeOut();
 
 	void countIntersection(Node *node, int height, int& nedge, int& ncell, int& nface);
-	void generateMinimizer(Node *node, int st[3], int len, int height, int& offset);
+	void generateMinimizer(Node *node, int st[3], int len, int height, int& offset,
+	                       float (*verts)[3]);
 	void computeMinimizer(const LeafNode * leaf, int st[3], int len,
 	                      float rvalue[3]) const;
 	/**
-	 * Traversal functions to generate polygon model
-	 * op: 0 for counting, 1 for writing OBJ, 2 for writing OFF, 3 for writing PLY
+	 * Traversal functions to generate polygon model,
+	 * the vertex indices of the quads are appended to 'quads'
+	 */
+	void cellProcContour(Node *node, int leaf, int depth, std::vector<int>& quads);
+	void faceProcContour(Node * node[2], int leaf[2], int depth[2], int maxdep, int dir, std::vector<int>& quads);
+	void edgeProcContour(Node * node[4], int leaf[4], int depth[4], int maxdep, int dir, std::vector<int>& quads);
+	void processEdgeWrite(Node * node[4], int depths[4], int maxdep, int dir, std::vector<int>& quads);
+
+	/**
+	 * Split the output traversals into jobs which can run in parallel
 	 */
-	void cellProcContour(Node *node, int leaf, int depth);
-	void faceProcContour(Node * node[2], int leaf[2], int depth[2], int maxdep, int dir);
-	void edgeProcContour(Node * node[4], int leaf[4], int depth[4], int maxdep, int dir);
-	void processEdgeWrite(Node * node[4], int depths[4], int maxdep, int dir);
+	struct CellJob;
+	struct ContourJob;
+	void collectCellJobs(Node *node, int st[3], int len, int height, int level,
+	                     std::vector<CellJob>& jobs);
+	void collectContourJobs(Node *node, int leaf, int depth, int level,
+	                        std::vector<ContourJob>& jobs);
 
 	/* output callbacks/data */
 	DualConAllocOutput alloc_output;
@@ -1309,7 +1328,11 @@ class Octree
 	/// Allocate a node
 	InternalNode *createInternal(int length)
 	{
-		InternalNode *inode = (InternalNode *)alloc[length]->allocate();
+		InternalNode *inode;
+		{
+			std::lock_guard<std::mutex> lock(alloc_mutex);
+			inode = (InternalNode *)alloc[length]->allocate();
+		}
 		inode->has_child_bitfield = 0;
 		inode->child_is_leaf_bitfield = 0;
 		return inode;
@@ -1319,7 +1342,11 @@ class Octree
 	{
 		assert(length <= 3);
 
-		LeafNode *lnode = (LeafNode *)leafalloc[length]->allocate();
+		LeafNode *lnode;
+		{
+			std::lock_guard<std::mutex> lock(alloc_mutex);
+			lnode = (LeafNode *)leafalloc[length]->allocate();
+		}
 		lnode->edge_parity = 0;
 		lnode->primary_edge_intersections = 0;
 		lnode->signs = 0;
@@ -1329,12 +1356,14 @@ class Octree
 
 	void removeInternal(int num, InternalNode *node)
 	{
+		std::lock_guard<std::mutex> lock(alloc_mutex);
 		alloc[num]->deallocate(node);
 	}
 
 	void removeLeaf(int num, LeafNode *leaf)
 	{
 		assert(num >= 0 && num <= 3);
+		std::lock_guard<std::mutex> lock(alloc_mutex);
 		leafalloc[num]->deallocate(leaf);
 	}
 
@@ -37,6 +37,7 @@
 typedef Eigen::SparseMatrix<double, Eigen::ColMajor> EigenSparseMatrix;
 typedef Eigen::SparseLU<EigenSparseMatrix> EigenSparseLU;
 typedef Eigen::VectorXd EigenVectorX;
+typedef Eigen::MatrixXd EigenMatrixX;
 typedef Eigen::Triplet<double> EigenTriplet;
 
 /* Linear Solver data structure */
@@ -310,7 +311,9 @@ bool EIG_linear_solver_solve(LinearSolver *solver)
 	}
 
 	if (result) {
-		/* solve for each right hand side */
+		/* solve all right hand sides in a single pass over the factorization */
+		EigenMatrixX B(solver->n, solver->num_rhs);
+
 		for (int rhs = 0; rhs < solver->num_rhs; rhs++) {
 			/* modify for locked variables */
 			EigenVectorX& b = solver->b[rhs];
@@ -326,20 +329,21 @@ bool EIG_linear_solver_solve(LinearSolver *solver)
 				}
 			}
 
-			/* solve */
-			if (solver->least_squares) {
-				EigenVectorX Mtb = solver->M.transpose() * b;
-				solver->x[rhs] = solver->sparseLU->solve(Mtb);
-			}
-			else {
-				EigenVectorX& b = solver->b[rhs];
-				solver->x[rhs] = solver->sparseLU->solve(b);
-			}
-
-			if (solver->sparseLU->info() != Eigen::Success)
-				result = false;
+			if (solver->least_squares)
+				B.col(rhs) = solver->M.transpose() * b;
+			else
+				B.col(rhs) = b;
 		}
 
+		/* solve */
+		EigenMatrixX X = solver->sparseLU->solve(B);
+
+		if (solver->sparseLU->info() != Eigen::Success)
+			result = false;
+
+		for (int rhs = 0; rhs < solver->num_rhs; rhs++)
+			solver->x[rhs] = X.col(rhs);
+
 		if (result)
 			linear_solver_vector_to_variables(solver);
 	}
@@ -34,6 +34,7 @@ typedef struct Gwn_VertBuf {
 	unsigned vertex_ct;    // number of verts we want to draw
 	unsigned vertex_alloc; // number of verts data
 	bool dirty;
+	unsigned dirty_first, dirty_end; // range of verts to upload when not entirely dirty
 	GLubyte* data; // NULL indicates data in VRAM (unmapped)
 	GLuint vbo_id; // 0 indicates not yet allocated
 	Gwn_UsageType usage; // usage hint for GL optimisation
@@ -96,6 +97,17 @@ GWN_INLINE unsigned GWN_vertbuf_raw_used(Gwn_VertBufRaw *a)
 
 void GWN_vertbuf_attr_get_raw_data(Gwn_VertBuf*, unsigned a_idx, Gwn_VertBufRaw *access);
 
+// Partial updates of buffers which keep their data (GWN_USAGE_DYNAMIC):
+// write through raw access without tagging the whole buffer dirty, then tag
+// the modified verts. Only the range spanning all tagged verts is uploaded.
+void GWN_vertbuf_attr_get_raw_data_ex(Gwn_VertBuf*, unsigned a_idx, Gwn_VertBufRaw *access, bool tag_dirty);
+void GWN_vertbuf_dirty_range_tag(Gwn_VertBuf*, unsigned v_first, unsigned v_ct);
+
+// Keeping the data costs as much memory as the buffer itself. Switching to
+// GWN_USAGE_STATIC frees it once uploaded, switching back to dynamic keeps the
+// data of the next allocation.
+void GWN_vertbuf_usage_set(Gwn_VertBuf*, Gwn_UsageType);
+
 // TODO: decide whether to keep the functions below
 // doesn't immediate mode satisfy these needs?
 
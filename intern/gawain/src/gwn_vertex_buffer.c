@@ -206,6 +206,11 @@ void GWN_vertbuf_attr_fill_stride(Gwn_VertBuf* verts, unsigned a_idx, unsigned s
 	}
 
 void GWN_vertbuf_attr_get_raw_data(Gwn_VertBuf* verts, unsigned a_idx, Gwn_VertBufRaw *access)
+	{
+	GWN_vertbuf_attr_get_raw_data_ex(verts, a_idx, access, true);
+	}
+
+void GWN_vertbuf_attr_get_raw_data_ex(Gwn_VertBuf* verts, unsigned a_idx, Gwn_VertBufRaw *access, bool tag_dirty)
 	{
 	const Gwn_VertFormat* format = &verts->format;
 	const Gwn_VertAttr* a = format->attribs + a_idx;
@@ -215,7 +220,8 @@ void GWN_vertbuf_attr_get_raw_data(Gwn_VertBuf* verts, unsigned a_idx, Gwn_VertB
 	assert(verts->data != NULL);
 #endif
 
-	verts->dirty = true;
+	if (tag_dirty)
+		verts->dirty = true;
 
 	access->size = a->sz;
 	access->stride = format->stride;
@@ -226,6 +232,43 @@ void GWN_vertbuf_attr_get_raw_data(Gwn_VertBuf* verts, unsigned a_idx, Gwn_VertB
 #endif
 	}
 
+void GWN_vertbuf_dirty_range_tag(Gwn_VertBuf* verts, unsigned v_first, unsigned v_ct)
+	{
+#if TRUST_NO_ONE
+	assert(verts->data != NULL); // only for dynamic data
+	assert(v_first + v_ct <= verts->vertex_ct);
+#endif
+
+	if (verts->dirty || v_ct == 0)
+		return; // whole buffer is uploaded anyway
+
+	const unsigned v_end = v_first + v_ct;
+	if (verts->dirty_first == verts->dirty_end)
+		{
+		verts->dirty_first = v_first;
+		verts->dirty_end = v_end;
+		}
+	else
+		{
+		if (v_first < verts->dirty_first)
+			verts->dirty_first = v_first;
+		if (v_end > verts->dirty_end)
+			verts->dirty_end = v_end;
+		}
+	}
+
+void GWN_vertbuf_usage_set(Gwn_VertBuf* verts, Gwn_UsageType usage)
+	{
+	verts->usage = usage;
+
+	// otherwise freed after the pending upload
+	if (usage == GWN_USAGE_STATIC && verts->data && !verts->dirty && verts->dirty_first == verts->dirty_end)
+		{
+		free(verts->data);
+		verts->data = NULL;
+		}
+	}
+
 static void VertBuffer_upload_data(Gwn_VertBuf* verts)
 	{
 	unsigned buffer_sz = GWN_vertbuf_size_get(verts);
@@ -242,6 +285,26 @@ static void VertBuffer_upload_data(Gwn_VertBuf* verts)
 		}
 
 	verts->dirty = false;
+	verts->dirty_first = verts->dirty_end = 0;
+	}
+
+static void VertBuffer_upload_range(Gwn_VertBuf* verts)
+	{
+	const unsigned stride = verts->format.stride;
+	const unsigned offset = verts->dirty_first * stride;
+	const unsigned v_end = (verts->dirty_end < verts->vertex_ct) ? verts->dirty_end : verts->vertex_ct;
+
+	// no orphaning, the rest of the buffer is still in use
+	if (v_end > verts->dirty_first)
+		glBufferSubData(GL_ARRAY_BUFFER, offset, (v_end - verts->dirty_first) * stride, verts->data + offset);
+
+	if (verts->usage == GWN_USAGE_STATIC)
+		{
+		free(verts->data);
+		verts->data = NULL;
+		}
+
+	verts->dirty_first = verts->dirty_end = 0;
 	}
 
 void GWN_vertbuf_use(Gwn_VertBuf* verts)
@@ -250,6 +313,8 @@ void GWN_vertbuf_use(Gwn_VertBuf* verts)
 
 	if (verts->dirty)
 		VertBuffer_upload_data(verts);
+	else if (verts->dirty_first != verts->dirty_end)
+		VertBuffer_upload_range(verts);
 	}
 
 unsigned GWN_vertbuf_get_memory_usage(void)
@@ -127,6 +127,10 @@ class DATA_PT_modifiers(ModifierButtonsPanel, Panel):
         layout.prop(md, "start_cap")
         layout.prop(md, "end_cap")
 
+        layout.separator()
+
+        layout.prop(md, "use_instancing")
+
     def BEVEL(self, layout, ob, md):
         split = layout.split()
 
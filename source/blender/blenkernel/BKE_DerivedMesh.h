@@ -579,6 +579,7 @@ DerivedMesh *editbmesh_get_derived_cage_and_final(
         DerivedMesh **r_final);
 
 DerivedMesh *object_get_derived_final(struct Object *ob, const bool for_render);
+DerivedMesh *object_get_derived_final_realized(struct Object *ob);
 
 float (*editbmesh_get_vertex_cos(struct BMEditMesh *em, int *r_numVerts))[3];
 bool editbmesh_modifier_is_enabled(struct Scene *scene, struct ModifierData *md, DerivedMesh *dm);
@@ -246,6 +246,26 @@ void CustomData_interp(
         const struct CustomData *source, struct CustomData *dest,
         const int *src_indices, const float *weights, const float *sub_weights,
         int count, int dest_index);
+
+/* interpolation of many elements at once, for each dest element its sources are
+ * src_indices[offsets[i]] .. src_indices[offsets[i + 1] - 1] with matching weights,
+ * sub-weights are not supported.
+ * key is not used by the CustomData API, it lets callers which keep the plan
+ * check it was built for the same topology */
+typedef struct CustomDataInterpPlan {
+	int totelem, totsrc;
+	int *offsets;
+	int *src_indices;
+	float *weights;
+	uint32_t key;
+} CustomDataInterpPlan;
+
+CustomDataInterpPlan *CustomData_interp_plan_new(int totelem, int totsrc);
+void CustomData_interp_plan_free(CustomDataInterpPlan *plan);
+void CustomData_interp_plan_apply(
+        const struct CustomData *source, struct CustomData *dest,
+        const CustomDataInterpPlan *plan, int dest_index);
+
 void CustomData_bmesh_interp_n(
         struct CustomData *data, const void **src_blocks, const float *weights,
         const float *sub_weights, int count, void *dst_block_ofs, int n);
@@ -42,6 +42,7 @@ struct ListBase;
 struct LinkNode;
 struct BLI_Stack;
 struct MemArena;
+struct MeshElemMap;
 struct BMesh;
 struct MLoopTri;
 struct Main;
@@ -109,6 +110,9 @@ struct Mesh * BKE_mesh_from_template(
 bool BKE_mesh_ensure_edit_data(struct Mesh *me);
 bool BKE_mesh_clear_edit_data(struct Mesh *me);
 
+const struct MeshElemMap *BKE_mesh_vert_loop_map_ensure(struct Mesh *me);
+void BKE_mesh_vert_loop_map_clear(struct Mesh *me);
+
 bool BKE_mesh_ensure_facemap_customdata(struct Mesh *me);
 bool BKE_mesh_clear_facemap_customdata(struct Mesh *me);
 
@@ -200,6 +204,11 @@ void BKE_mesh_calc_normals_poly(
         const struct MLoop *mloop, const struct MPoly *mpolys,
         int numLoops, int numPolys, float (*r_polyNors)[3],
         const bool only_face_normals);
+void BKE_mesh_calc_normals_poly_ex(
+        struct MVert *mverts, float (*r_vertnors)[3], int numVerts,
+        const struct MLoop *mloop, const struct MPoly *mpolys,
+        int numLoops, int numPolys, float (*r_polyNors)[3],
+        const bool only_face_normals, const struct MeshElemMap *vert_loop_map);
 void BKE_mesh_calc_normals(struct Mesh *me);
 void BKE_mesh_calc_normals_tessface(
         struct MVert *mverts, int numVerts,
@@ -482,6 +491,8 @@ enum {
 	BKE_MESH_BATCH_DIRTY_SELECT,
 	BKE_MESH_BATCH_DIRTY_SHADING,
 	BKE_MESH_BATCH_DIRTY_SCULPT_COORDS,
+	/* Not dirty, but data kept for in place updates during strokes can be freed. */
+	BKE_MESH_BATCH_DIRTY_SCULPT_STROKE_DONE,
 };
 void BKE_mesh_batch_cache_dirty(struct Mesh *me, int mode);
 void BKE_mesh_batch_cache_free(struct Mesh *me);
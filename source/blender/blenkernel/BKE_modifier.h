@@ -125,6 +125,11 @@ typedef enum ModifierApplyFlag {
 	                                * Render pipeline (including viewport render) should
 	                                * have DM on the CPU.
 	                                */
+	MOD_APPLY_ALLOW_INSTANCES = 1 << 5, /* Allow modifier to output parts of its result as instances
+	                                     * of the object, see OB_DUPLIARRAY. Only used when building
+	                                     * the object's own derivedFinal, everything else (applying,
+	                                     * exporters, to_mesh) gets the full geometry.
+	                                     */
 } ModifierApplyFlag;
 
 typedef struct ModifierUpdateDepsgraphContext {
@@ -421,6 +426,7 @@ bool          modifiers_isModifierEnabled(struct Object *ob, int modifierType);
 bool          modifiers_isSoftbodyEnabled(struct Object *ob);
 bool          modifiers_isClothEnabled(struct Object *ob);
 bool          modifiers_isParticleEnabled(struct Object *ob);
+struct ArrayModifierData *modifiers_findInstancedArray(struct Object *ob);
 
 struct Object *modifiers_isDeformedByArmature(struct Object *ob);
 struct Object *modifiers_isDeformedByLattice(struct Object *ob);
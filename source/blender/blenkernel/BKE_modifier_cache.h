@@ -0,0 +1,60 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BKE_MODIFIER_CACHE_H__
+#define __BKE_MODIFIER_CACHE_H__
+
+/** \file BKE_modifier_cache.h
+ *  \ingroup bke
+ *
+ * Results of constructive modifiers, kept between evaluations of the modifier
+ * stack. Results are looked up by a key which covers everything the result
+ * depends on, see mesh_calc_modifiers(). The cache is owned by the depsgraph.
+ */
+
+#include "BLI_sys_types.h"
+
+struct DerivedMesh;
+struct ModifierResultCache;
+
+/* Default memory limit of a cache, in bytes. */
+#define MODIFIER_RESULT_CACHE_DEFAULT_LIMIT ((size_t)256 * 1024 * 1024)
+/* Default time a result must have taken to compute to be stored, in seconds. */
+#define MODIFIER_RESULT_CACHE_DEFAULT_MIN_TIME 0.002
+
+struct ModifierResultCache *BKE_modifier_result_cache_new(void);
+void BKE_modifier_result_cache_free(struct ModifierResultCache *cache);
+void BKE_modifier_result_cache_clear(struct ModifierResultCache *cache);
+
+void BKE_modifier_result_cache_limit_set(struct ModifierResultCache *cache, size_t limit);
+void BKE_modifier_result_cache_min_time_set(struct ModifierResultCache *cache, double min_time);
+size_t BKE_modifier_result_cache_memory_get(struct ModifierResultCache *cache);
+
+/* Returns a copy of the result stored for exactly the same key data, or NULL. */
+struct DerivedMesh *BKE_modifier_result_cache_lookup(
+        struct ModifierResultCache *cache, const void *key_data, size_t key_len);
+/* Stores a copy of the result and the key if computing it took at least the
+ * minimum time, least recently used results are freed to stay within the
+ * memory limit. */
+void BKE_modifier_result_cache_store(
+        struct ModifierResultCache *cache, const void *key_data, size_t key_len,
+        struct DerivedMesh *dm, double time);
+
+#endif  /* __BKE_MODIFIER_CACHE_H__ */
@@ -980,6 +980,8 @@ void            ntreeGPUMaterialDomain(struct bNodeTree *ntree, bool *has_surfac
 void ntreeCompositExecTree(struct Scene *scene, struct bNodeTree *ntree, struct RenderData *rd, int rendering, int do_previews,
                            const struct ColorManagedViewSettings *view_settings, const struct ColorManagedDisplaySettings *display_settings,
                            const char *view_name);
+void ntreeCompositBatchBegin(int prefetch_frames, int frame_step);
+void ntreeCompositBatchEnd(void);
 void ntreeCompositTagRender(struct Scene *sce);
 int ntreeCompositTagAnimated(struct bNodeTree *ntree);
 void ntreeCompositTagGenerators(struct bNodeTree *ntree);
@@ -48,9 +48,18 @@ struct Main;
 struct RigidBodyWorld;
 struct HookModifierData;
 struct ModifierData;
+struct DerivedMesh;
 
 #include "DNA_object_enums.h"
 
+/* Runtime data of an object whose array modifier outputs its copies as instances, see #OB_DUPLIARRAY. */
+typedef struct ObjectArrayInstances {
+	float offset[4][4];  /* transform from one copy to the next */
+	int count;           /* number of copies including the object's own mesh */
+	/* derivedFinal with all copies, created on demand for code which needs the full geometry */
+	struct DerivedMesh *dm_realized;
+} ObjectArrayInstances;
+
 void BKE_object_workob_clear(struct Object *workob);
 void BKE_object_workob_calc_parent(struct Depsgraph *depsgraph, struct Scene *scene, struct Object *ob, struct Object *workob);
 
@@ -62,6 +71,7 @@ void BKE_object_copy_softbody(struct Object *ob_dst, const struct Object *ob_src
 void BKE_object_free_particlesystems(struct Object *ob);
 void BKE_object_free_softbody(struct Object *ob);
 void BKE_object_free_curve_cache(struct Object *ob);
+void BKE_object_free_array_instances(struct Object *ob);
 
 void BKE_object_free(struct Object *ob);
 void BKE_object_free_derived_caches(struct Object *ob);
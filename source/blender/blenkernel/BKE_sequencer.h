@@ -103,6 +103,7 @@ typedef struct SeqRenderData {
 	float motion_blur_shutter;
 	bool skip_cache;
 	bool is_proxy_render;
+	bool is_prefetch_render;
 	int view_id;
 
 	/* special case for OpenGL render */
@@ -189,10 +190,8 @@ struct SeqEffectHandle {
  * ********************************************************************** */
 
 struct ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int chanshown);
-struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown);
 struct ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, struct Sequence *seq);
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chan_shown, struct ListBase *seqbasep);
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chan_shown);
 
 /* **********************************************************************
  * sequencer.c
@@ -210,6 +209,7 @@ void BKE_sequencer_pixel_from_sequencer_space_v4(struct Scene *scene, float pixe
 struct Editing  *BKE_sequencer_editing_get(struct Scene *scene, bool alloc);
 struct Editing  *BKE_sequencer_editing_ensure(struct Scene *scene);
 void             BKE_sequencer_editing_free(struct Scene *scene);
+void             BKE_sequencer_editing_free_ex(struct Scene *scene, const bool do_cache);
 
 void             BKE_sequencer_sort(struct Scene *scene);
 
@@ -289,6 +289,19 @@ void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, struct S
 void BKE_sequencer_preprocessed_cache_cleanup(void);
 void BKE_sequencer_preprocessed_cache_cleanup_sequence(struct Sequence *seq);
 
+/* **********************************************************************
+ * seqprefetch.c
+ *
+ * Render upcoming frames in a background thread during playback
+ * ********************************************************************** */
+
+void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, int chanshown);
+void BKE_sequencer_prefetch_stop(void);
+
+/* used by the cache to store frames rendered by the prefetch job for the original scene */
+bool BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context, SeqRenderData *r_context);
+struct Sequence *BKE_sequencer_prefetch_get_original_sequence(struct Sequence *seq);
+
 /* **********************************************************************
  * seqeffects.c
  *
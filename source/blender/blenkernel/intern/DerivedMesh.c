@@ -36,20 +36,24 @@
 #include "MEM_guardedalloc.h"
 
 #include "DNA_cloth_types.h"
+#include "DNA_color_types.h"
 #include "DNA_key_types.h"
 #include "DNA_material_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
 #include "BLI_array.h"
 #include "BLI_blenlib.h"
 #include "BLI_bitmap.h"
+#include "BLI_hash_md5.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_linklist.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_cdderivedmesh.h"
 #include "BKE_colorband.h"
@@ -59,6 +63,7 @@
 #include "BKE_library.h"
 #include "BKE_material.h"
 #include "BKE_modifier.h"
+#include "BKE_modifier_cache.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_mapping.h"
 #include "BKE_mesh_tangent.h"
@@ -72,6 +77,8 @@
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#include "PIL_time.h"
+
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
@@ -1742,12 +1749,440 @@ static void dm_ensure_display_normals(DerivedMesh *dm)
 	}
 }
 
+/* Modifier result cache.
+ *
+ * Results of expensive constructive modifiers are kept in the depsgraph between
+ * evaluations, see BKE_modifier_cache.h. The key of a result is built from the
+ * input mesh, settings and data masks of all modifiers up to it and geometry
+ * of the objects they use. Editing a modifier late in the stack reuses results
+ * of the earlier ones.
+ *
+ * Settings are held in the key as they are and compared in full. Mesh data
+ * is added as an MD5 digest of each layer, a copy of it would make the key as
+ * large as the mesh.
+ */
+
+typedef struct ModifierCacheKey {
+	char *data;
+	size_t len, alloc;
+	/* false once anything the result depends on can't be added */
+	bool valid;
+} ModifierCacheKey;
+
+static void modifier_cache_key_init(ModifierCacheKey *key)
+{
+	key->alloc = 1024;
+	key->data = MEM_mallocN(key->alloc, "modifier cache key");
+	key->len = 0;
+	key->valid = true;
+}
+
+static void modifier_cache_key_free(ModifierCacheKey *key)
+{
+	MEM_freeN(key->data);
+	key->data = NULL;
+}
+
+static void modifier_cache_key_add(ModifierCacheKey *key, const void *data, size_t len)
+{
+	if (!key->valid) {
+		return;
+	}
+	if (key->len + len > key->alloc) {
+		key->alloc = max_zz(key->alloc * 2, key->len + len);
+		key->data = MEM_reallocN(key->data, key->alloc);
+	}
+	memcpy(key->data + key->len, data, len);
+	key->len += len;
+}
+
+static void modifier_cache_key_add_digest(ModifierCacheKey *key, const void *data, size_t len)
+{
+	char digest[16];
+
+	if (!key->valid) {
+		return;
+	}
+	BLI_hash_md5_buffer(data, len, digest);
+	modifier_cache_key_add(key, digest, sizeof(digest));
+}
+
+static void modifier_cache_key_add_int(ModifierCacheKey *key, int data)
+{
+	modifier_cache_key_add(key, &data, sizeof(data));
+}
+
+static void modifier_cache_key_add_float(ModifierCacheKey *key, float data)
+{
+	modifier_cache_key_add(key, &data, sizeof(data));
+}
+
+static void modifier_cache_key_add_string(ModifierCacheKey *key, const char *str)
+{
+	modifier_cache_key_add(key, str, strlen(str) + 1);
+}
+
+static void modifier_cache_key_add_mask(ModifierCacheKey *key, CustomDataMask mask)
+{
+	modifier_cache_key_add(key, &mask, sizeof(mask));
+}
+
+static void modifier_cache_key_add_customdata(ModifierCacheKey *key, const CustomData *data, int totelem)
+{
+	int i, j;
+
+	modifier_cache_key_add_int(key, totelem);
+	for (i = 0; i < data->totlayer; i++) {
+		const CustomDataLayer *layer = &data->layers[i];
+
+		modifier_cache_key_add_int(key, layer->type);
+		modifier_cache_key_add_int(key, layer->active);
+		modifier_cache_key_add_int(key, layer->active_rnd);
+		modifier_cache_key_add_string(key, layer->name);
+
+		if (layer->data == NULL) {
+			continue;
+		}
+		if (layer->type == CD_MDEFORMVERT) {
+			/* weights are stored per vertex, gather them to hash them at once */
+			const MDeformVert *dvert = layer->data;
+			size_t len = 0;
+			char *buf, *cp;
+
+			for (j = 0; j < totelem; j++) {
+				len += sizeof(dvert[j].totweight) + sizeof(*dvert[j].dw) * dvert[j].totweight;
+			}
+			cp = buf = MEM_mallocN(max_zz(len, 1), __func__);
+			for (j = 0; j < totelem; j++) {
+				memcpy(cp, &dvert[j].totweight, sizeof(dvert[j].totweight));
+				cp += sizeof(dvert[j].totweight);
+				memcpy(cp, dvert[j].dw, sizeof(*dvert[j].dw) * dvert[j].totweight);
+				cp += sizeof(*dvert[j].dw) * dvert[j].totweight;
+			}
+			modifier_cache_key_add_digest(key, buf, len);
+			MEM_freeN(buf);
+		}
+		else if (ELEM(layer->type, CD_MDISPS, CD_GRID_PAINT_MASK)) {
+			/* multires data is edited in place */
+			key->valid = false;
+		}
+		else {
+			modifier_cache_key_add_digest(key, layer->data, (size_t)CustomData_sizeof(layer->type) * totelem);
+		}
+	}
+}
+
+static void modifier_cache_key_add_mesh(ModifierCacheKey *key, const Mesh *me)
+{
+	modifier_cache_key_add_customdata(key, &me->vdata, me->totvert);
+	modifier_cache_key_add_customdata(key, &me->edata, me->totedge);
+	modifier_cache_key_add_customdata(key, &me->fdata, me->totface);
+	modifier_cache_key_add_customdata(key, &me->ldata, me->totloop);
+	modifier_cache_key_add_customdata(key, &me->pdata, me->totpoly);
+}
+
+typedef struct ModifierCacheKeyWalkData {
+	ModifierCacheKey *key;
+	Object *ob;
+} ModifierCacheKeyWalkData;
+
+static void modifier_cache_key_add_id_walk(void *userData, Object *UNUSED(ob), ID **idpoin, int UNUSED(cb_flag))
+{
+	ModifierCacheKeyWalkData *data = userData;
+	ModifierCacheKey *key = data->key;
+	ID *id = *idpoin;
+	Object *object;
+
+	if (id == NULL || !key->valid) {
+		return;
+	}
+	if (GS(id->name) != ID_OB) {
+		/* textures and other data are not added to the key */
+		key->valid = false;
+		return;
+	}
+
+	/* objects are used relative to the modified one */
+	object = (Object *)id;
+	modifier_cache_key_add(key, &object, sizeof(object));
+	modifier_cache_key_add(key, object->obmat, sizeof(object->obmat));
+	modifier_cache_key_add(key, data->ob->obmat, sizeof(data->ob->obmat));
+
+	if (object == data->ob || object->type == OB_EMPTY) {
+		/* only the transform is used */
+	}
+	else if (object->type == OB_MESH && object->derivedFinal && object->derivedFinal->type == DM_TYPE_CDDM) {
+		DerivedMesh *dm = object->derivedFinal;
+		modifier_cache_key_add_customdata(key, &dm->vertData, dm->numVertData);
+		modifier_cache_key_add_customdata(key, &dm->edgeData, dm->numEdgeData);
+		modifier_cache_key_add_customdata(key, &dm->loopData, dm->numLoopData);
+		modifier_cache_key_add_customdata(key, &dm->polyData, dm->numPolyData);
+	}
+	else {
+		key->valid = false;
+	}
+}
+
+static void modifier_cache_key_add_curvemapping(ModifierCacheKey *key, const CurveMapping *cumap)
+{
+	int i, j;
+
+	if (cumap == NULL) {
+		modifier_cache_key_add_int(key, -1);
+		return;
+	}
+
+	modifier_cache_key_add_int(key, cumap->flag);
+	modifier_cache_key_add(key, &cumap->clipr, sizeof(cumap->clipr));
+	for (i = 0; i < CM_TOT; i++) {
+		const CurveMap *cuma = &cumap->cm[i];
+
+		modifier_cache_key_add_int(key, cuma->totpoint);
+		modifier_cache_key_add_int(key, cuma->flag);
+		for (j = 0; j < cuma->totpoint; j++) {
+			modifier_cache_key_add_float(key, cuma->curve[j].x);
+			modifier_cache_key_add_float(key, cuma->curve[j].y);
+			modifier_cache_key_add_int(key, cuma->curve[j].flag);
+		}
+	}
+}
+
+/* Settings are added one by one, modifier structs also hold runtime data
+ * (caches, evaluated results) which must not be part of the key. Types which
+ * are not listed here are not cached. */
+static void modifier_cache_key_add_settings(ModifierCacheKey *key, ModifierData *md, ModifierApplyFlag flag)
+{
+	switch (md->type) {
+		case eModifierType_Subsurf:
+		{
+			SubsurfModifierData *smd = (SubsurfModifierData *)md;
+			modifier_cache_key_add_int(key, smd->subdivType);
+			modifier_cache_key_add_int(key, smd->levels);
+			modifier_cache_key_add_int(key, smd->renderLevels);
+			modifier_cache_key_add_int(key, smd->flags);
+			modifier_cache_key_add_int(key, smd->use_opensubdiv);
+			break;
+		}
+		case eModifierType_Array:
+		{
+			ArrayModifierData *amd = (ArrayModifierData *)md;
+			modifier_cache_key_add(key, amd->offset, sizeof(amd->offset));
+			modifier_cache_key_add(key, amd->scale, sizeof(amd->scale));
+			modifier_cache_key_add_float(key, amd->length);
+			modifier_cache_key_add_float(key, amd->merge_dist);
+			modifier_cache_key_add_int(key, amd->fit_type);
+			modifier_cache_key_add_int(key, amd->offset_type);
+			modifier_cache_key_add_int(key, amd->flags);
+			modifier_cache_key_add_int(key, amd->count);
+			modifier_cache_key_add(key, amd->uv_offset, sizeof(amd->uv_offset));
+			if ((amd->flags & MOD_ARR_INSTANCE) && (flag & MOD_APPLY_ALLOW_INSTANCES)) {
+				/* the instances are stored on the object by the modifier itself */
+				key->valid = false;
+			}
+			break;
+		}
+		case eModifierType_Mirror:
+		{
+			MirrorModifierData *mmd = (MirrorModifierData *)md;
+			modifier_cache_key_add_int(key, mmd->flag);
+			modifier_cache_key_add_float(key, mmd->tolerance);
+			modifier_cache_key_add(key, mmd->uv_offset, sizeof(mmd->uv_offset));
+			modifier_cache_key_add(key, mmd->uv_offset_copy, sizeof(mmd->uv_offset_copy));
+			break;
+		}
+		case eModifierType_Bevel:
+		{
+			BevelModifierData *bmd = (BevelModifierData *)md;
+			modifier_cache_key_add_float(key, bmd->value);
+			modifier_cache_key_add_int(key, bmd->res);
+			modifier_cache_key_add_int(key, bmd->flags);
+			modifier_cache_key_add_int(key, bmd->val_flags);
+			modifier_cache_key_add_int(key, bmd->lim_flags);
+			modifier_cache_key_add_int(key, bmd->e_flags);
+			modifier_cache_key_add_int(key, bmd->mat);
+			modifier_cache_key_add_float(key, bmd->profile);
+			modifier_cache_key_add_float(key, bmd->bevel_angle);
+			modifier_cache_key_add_string(key, bmd->defgrp_name);
+			break;
+		}
+		case eModifierType_Solidify:
+		{
+			SolidifyModifierData *smd = (SolidifyModifierData *)md;
+			modifier_cache_key_add_string(key, smd->defgrp_name);
+			modifier_cache_key_add_float(key, smd->offset);
+			modifier_cache_key_add_float(key, smd->offset_fac);
+			modifier_cache_key_add_float(key, smd->offset_fac_vg);
+			modifier_cache_key_add_float(key, smd->offset_clamp);
+			modifier_cache_key_add_float(key, smd->crease_inner);
+			modifier_cache_key_add_float(key, smd->crease_outer);
+			modifier_cache_key_add_float(key, smd->crease_rim);
+			modifier_cache_key_add_int(key, smd->flag);
+			modifier_cache_key_add_int(key, smd->mat_ofs);
+			modifier_cache_key_add_int(key, smd->mat_ofs_rim);
+			break;
+		}
+		case eModifierType_Decimate:
+		{
+			DecimateModifierData *dmd = (DecimateModifierData *)md;
+			modifier_cache_key_add_float(key, dmd->percent);
+			modifier_cache_key_add_int(key, dmd->iter);
+			modifier_cache_key_add_int(key, dmd->delimit);
+			modifier_cache_key_add_int(key, dmd->symmetry_axis);
+			modifier_cache_key_add_float(key, dmd->angle);
+			modifier_cache_key_add_string(key, dmd->defgrp_name);
+			modifier_cache_key_add_float(key, dmd->defgrp_factor);
+			modifier_cache_key_add_int(key, dmd->flag);
+			modifier_cache_key_add_int(key, dmd->mode);
+			break;
+		}
+		case eModifierType_Remesh:
+		{
+			RemeshModifierData *rmd = (RemeshModifierData *)md;
+			modifier_cache_key_add_float(key, rmd->threshold);
+			modifier_cache_key_add_float(key, rmd->scale);
+			modifier_cache_key_add_float(key, rmd->hermite_num);
+			modifier_cache_key_add_int(key, rmd->depth);
+			modifier_cache_key_add_int(key, rmd->flag);
+			modifier_cache_key_add_int(key, rmd->mode);
+			break;
+		}
+		case eModifierType_Triangulate:
+		{
+			TriangulateModifierData *tmd = (TriangulateModifierData *)md;
+			modifier_cache_key_add_int(key, tmd->flag);
+			modifier_cache_key_add_int(key, tmd->quad_method);
+			modifier_cache_key_add_int(key, tmd->ngon_method);
+			break;
+		}
+		case eModifierType_Wireframe:
+		{
+			WireframeModifierData *wmd = (WireframeModifierData *)md;
+			modifier_cache_key_add_string(key, wmd->defgrp_name);
+			modifier_cache_key_add_float(key, wmd->offset);
+			modifier_cache_key_add_float(key, wmd->offset_fac);
+			modifier_cache_key_add_float(key, wmd->offset_fac_vg);
+			modifier_cache_key_add_float(key, wmd->crease_weight);
+			modifier_cache_key_add_int(key, wmd->flag);
+			modifier_cache_key_add_int(key, wmd->mat_ofs);
+			break;
+		}
+		case eModifierType_EdgeSplit:
+		{
+			EdgeSplitModifierData *emd = (EdgeSplitModifierData *)md;
+			modifier_cache_key_add_float(key, emd->split_angle);
+			modifier_cache_key_add_int(key, emd->flags);
+			break;
+		}
+		case eModifierType_Screw:
+		{
+			ScrewModifierData *smd = (ScrewModifierData *)md;
+			modifier_cache_key_add_int(key, (int)smd->steps);
+			modifier_cache_key_add_int(key, (int)smd->render_steps);
+			modifier_cache_key_add_int(key, (int)smd->iter);
+			modifier_cache_key_add_float(key, smd->screw_ofs);
+			modifier_cache_key_add_float(key, smd->angle);
+			modifier_cache_key_add_float(key, smd->merge_dist);
+			modifier_cache_key_add_int(key, smd->flag);
+			modifier_cache_key_add_int(key, smd->axis);
+			break;
+		}
+		case eModifierType_Boolean:
+		{
+			BooleanModifierData *bmd = (BooleanModifierData *)md;
+			modifier_cache_key_add_int(key, bmd->operation);
+			modifier_cache_key_add_int(key, bmd->bm_flag);
+			modifier_cache_key_add_float(key, bmd->double_threshold);
+			break;
+		}
+		case eModifierType_Skin:
+		{
+			SkinModifierData *smd = (SkinModifierData *)md;
+			modifier_cache_key_add_float(key, smd->branch_smoothing);
+			modifier_cache_key_add_int(key, smd->flag);
+			modifier_cache_key_add_int(key, smd->symmetry_axes);
+			break;
+		}
+		case eModifierType_WeightVGEdit:
+		{
+			WeightVGEditModifierData *wmd = (WeightVGEditModifierData *)md;
+			modifier_cache_key_add_string(key, wmd->defgrp_name);
+			modifier_cache_key_add_int(key, wmd->edit_flags);
+			modifier_cache_key_add_int(key, wmd->falloff_type);
+			modifier_cache_key_add_float(key, wmd->default_weight);
+			modifier_cache_key_add_curvemapping(key, wmd->cmap_curve);
+			modifier_cache_key_add_float(key, wmd->add_threshold);
+			modifier_cache_key_add_float(key, wmd->rem_threshold);
+			modifier_cache_key_add_float(key, wmd->mask_constant);
+			modifier_cache_key_add_string(key, wmd->mask_defgrp_name);
+			modifier_cache_key_add_int(key, wmd->mask_tex_use_channel);
+			modifier_cache_key_add_int(key, wmd->mask_tex_mapping);
+			modifier_cache_key_add_string(key, wmd->mask_tex_uvlayer_name);
+			break;
+		}
+		default:
+			key->valid = false;
+			break;
+	}
+}
+
+static void modifier_cache_key_add_modifier(
+        ModifierCacheKey *key, Object *ob, ModifierData *md, ModifierApplyFlag flag)
+{
+	const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+	ModifierCacheKeyWalkData data = {key, ob};
+
+	if (mti->dependsOnTime && mti->dependsOnTime(md)) {
+		key->valid = false;
+		return;
+	}
+
+	modifier_cache_key_add_int(key, md->type);
+	modifier_cache_key_add_int(key, md->mode);
+	modifier_cache_key_add_settings(key, md, flag);
+
+	if (mti->foreachIDLink) {
+		mti->foreachIDLink(md, ob, modifier_cache_key_add_id_walk, &data);
+	}
+	else if (mti->foreachObjectLink) {
+		mti->foreachObjectLink(md, ob, (ObjectWalkFunc)modifier_cache_key_add_id_walk, &data);
+	}
+}
+
+/* Apply the modifier or get its result from the cache, variant tells apart
+ * results of different derived meshes evaluated for the same key. */
+static DerivedMesh *modifier_apply_cached(
+        struct ModifierResultCache *cache, ModifierCacheKey *key, int variant,
+        ModifierData *md, const ModifierEvalContext *mectx, DerivedMesh *dm)
+{
+	DerivedMesh *ndm;
+	double start_time;
+
+	if (cache == NULL || !key->valid) {
+		return modwrap_applyModifier(md, mectx, dm);
+	}
+
+	/* the variant is only appended for the lookup */
+	modifier_cache_key_add_int(key, variant);
+
+	ndm = BKE_modifier_result_cache_lookup(cache, key->data, key->len);
+	if (ndm == NULL) {
+		start_time = PIL_check_seconds_timer();
+		ndm = modwrap_applyModifier(md, mectx, dm);
+		if (ndm && ndm->type == DM_TYPE_CDDM) {
+			BKE_modifier_result_cache_store(cache, key->data, key->len, ndm, PIL_check_seconds_timer() - start_time);
+		}
+	}
+
+	key->len -= sizeof(variant);
+	return ndm;
+}
+
 static void mesh_calc_modifiers(
         struct Depsgraph *depsgraph, Scene *scene, Object *ob, float (*inputVertexCos)[3],
         const bool useRenderParams, int useDeform,
         const bool need_mapping, CustomDataMask dataMask,
         const int index, const bool useCache, const bool build_shapekey_layers,
-        const bool allow_gpu,
+        const bool allow_gpu, const bool allow_instances,
         /* return args */
         DerivedMesh **r_deform, DerivedMesh **r_final)
 {
@@ -1786,6 +2221,10 @@ static void mesh_calc_modifiers(
 
 	VirtualModifierData virtualModifierData;
 
+	struct ModifierResultCache *result_cache = NULL;
+	ModifierCacheKey cache_key;
+	bool cache_key_has_mesh = false;
+
 	ModifierApplyFlag app_flags = useRenderParams ? MOD_APPLY_RENDER : 0;
 	ModifierApplyFlag deform_app_flags = app_flags;
 
@@ -1794,6 +2233,8 @@ static void mesh_calc_modifiers(
 		app_flags |= MOD_APPLY_USECACHE;
 	if (allow_gpu)
 		app_flags |= MOD_APPLY_ALLOW_GPU;
+	if (allow_instances)
+		app_flags |= MOD_APPLY_ALLOW_INSTANCES;
 	if (useDeform)
 		deform_app_flags |= MOD_APPLY_USECACHE;
 
@@ -1825,6 +2266,31 @@ static void mesh_calc_modifiers(
 	datamasks = modifiers_calcDataMasks(scene, ob, md, dataMask, required_mode, previewmd, previewmask);
 	curr = datamasks;
 
+	/* sculpting and weight preview use data which is not covered by the cache key */
+	if (depsgraph && !sculpt_mode && !has_multires && !do_init_wmcol && !do_mod_wmcol) {
+		result_cache = DEG_get_modifier_result_cache(depsgraph);
+	}
+	if (result_cache) {
+		modifier_cache_key_init(&cache_key);
+		modifier_cache_key_add_int(&cache_key, useRenderParams);
+		modifier_cache_key_add_int(&cache_key, useDeform);
+		modifier_cache_key_add_int(&cache_key, need_mapping);
+		modifier_cache_key_add_int(&cache_key, build_shapekey_layers);
+		modifier_cache_key_add_int(&cache_key, draw_flag);
+		modifier_cache_key_add_int(&cache_key, (scene->r.mode & R_SIMPLIFY) != 0);
+		modifier_cache_key_add_int(&cache_key, scene->r.simplify_subsurf);
+		modifier_cache_key_add_int(&cache_key, scene->r.simplify_subsurf_render);
+		modifier_cache_key_add_mask(&cache_key, dataMask);
+		/* modifiers look up vertex groups by name */
+		for (bDeformGroup *dg = ob->defbase.first; dg; dg = dg->next) {
+			modifier_cache_key_add_string(&cache_key, dg->name);
+		}
+		if (build_shapekey_layers && me->key) {
+			/* shape key layers are not hashed */
+			cache_key.valid = false;
+		}
+	}
+
 	if (r_deform) {
 		*r_deform = NULL;
 	}
@@ -2068,7 +2534,25 @@ static void mesh_calc_modifiers(
 				}
 			}
 
-			ndm = modwrap_applyModifier(md, &mectx_apply, dm);
+			/* extend the cache key by the input and settings of this modifier,
+			 * the mesh is only hashed once a constructive modifier is reached */
+			if (result_cache) {
+				if (!cache_key_has_mesh) {
+					modifier_cache_key_add_mesh(&cache_key, me);
+					cache_key_has_mesh = true;
+				}
+				if (deformedVerts) {
+					modifier_cache_key_add(&cache_key, deformedVerts, sizeof(*deformedVerts) * numVerts);
+				}
+				else {
+					modifier_cache_key_add_int(&cache_key, 0);
+				}
+				modifier_cache_key_add_modifier(&cache_key, ob, md, app_flags);
+				modifier_cache_key_add_mask(&cache_key, mask);
+				modifier_cache_key_add_mask(&cache_key, nextmask);
+			}
+
+			ndm = modifier_apply_cached(result_cache, &cache_key, 0, md, &mectx_apply, dm);
 			ASSERT_IS_VALID_DM(ndm);
 
 			if (ndm) {
@@ -2095,7 +2579,7 @@ static void mesh_calc_modifiers(
 				                 (mti->requiredDataMask ?
 				                  mti->requiredDataMask(ob, md) : 0));
 
-				ndm = modwrap_applyModifier(md, &mectx_orco, orcodm);
+				ndm = modifier_apply_cached(result_cache, &cache_key, CD_ORCO, md, &mectx_orco, orcodm);
 				ASSERT_IS_VALID_DM(ndm);
 
 				if (ndm) {
@@ -2113,7 +2597,7 @@ static void mesh_calc_modifiers(
 				nextmask &= ~CD_MASK_CLOTH_ORCO;
 				DM_set_only_copy(clothorcodm, nextmask | CD_MASK_ORIGINDEX);
 
-				ndm = modwrap_applyModifier(md, &mectx_orco, clothorcodm);
+				ndm = modifier_apply_cached(result_cache, &cache_key, CD_CLOTH_ORCO, md, &mectx_orco, clothorcodm);
 				ASSERT_IS_VALID_DM(ndm);
 
 				if (ndm) {
@@ -2243,6 +2727,10 @@ static void mesh_calc_modifiers(
 	if (deformedVerts && deformedVerts != inputVertexCos)
 		MEM_freeN(deformedVerts);
 
+	if (result_cache) {
+		modifier_cache_key_free(&cache_key);
+	}
+
 	BLI_linklist_free((LinkNode *)datamasks, NULL);
 }
 
@@ -2645,9 +3133,14 @@ static void mesh_build_data(
 
 	mesh_calc_modifiers(
 	        depsgraph, scene, ob, NULL, false, 1, need_mapping, dataMask, -1, true, build_shapekey_layers,
-	        true,
+	        true, true,
 	        &ob->derivedDeform, &ob->derivedFinal);
 
+	/* the array modifier may output a single copy, the others are added as duplis */
+	if (ob->array_instances) {
+		ob->transflag |= OB_DUPLIARRAY;
+	}
+
 	DM_set_object_boundbox(ob, ob->derivedFinal);
 
 	ob->derivedFinal->needsFree = 0;
@@ -2766,7 +3259,7 @@ DerivedMesh *mesh_get_derived_final(
 	}
 
 	if (ob->derivedFinal) { BLI_assert(!(ob->derivedFinal->dirty & DM_DIRTY_NORMALS)); }
-	return ob->derivedFinal;
+	return object_get_derived_final_realized(ob);
 }
 
 DerivedMesh *mesh_get_derived_deform(struct Depsgraph *depsgraph, Scene *scene, Object *ob, CustomDataMask dataMask)
@@ -2793,7 +3286,7 @@ DerivedMesh *mesh_create_derived_render(struct Depsgraph *depsgraph, Scene *scen
 	DerivedMesh *final;
 	
 	mesh_calc_modifiers(
-	        depsgraph, scene, ob, NULL, true, 1, false, dataMask, -1, false, false, false,
+	        depsgraph, scene, ob, NULL, true, 1, false, dataMask, -1, false, false, false, false,
 	        NULL, &final);
 
 	return final;
@@ -2804,7 +3297,7 @@ DerivedMesh *mesh_create_derived_index_render(struct Depsgraph *depsgraph, Scene
 	DerivedMesh *final;
 
 	mesh_calc_modifiers(
-	        depsgraph, scene, ob, NULL, true, 1, false, dataMask, index, false, false, false,
+	        depsgraph, scene, ob, NULL, true, 1, false, dataMask, index, false, false, false, false,
 	        NULL, &final);
 
 	return final;
@@ -2823,7 +3316,7 @@ DerivedMesh *mesh_create_derived_view(
 	ob->transflag |= OB_NO_PSYS_UPDATE;
 
 	mesh_calc_modifiers(
-	        depsgraph, scene, ob, NULL, false, 1, false, dataMask, -1, false, false, false,
+	        depsgraph, scene, ob, NULL, false, 1, false, dataMask, -1, false, false, false, false,
 	        NULL, &final);
 
 	ob->transflag &= ~OB_NO_PSYS_UPDATE;
@@ -2838,7 +3331,7 @@ DerivedMesh *mesh_create_derived_no_deform(
 	DerivedMesh *final;
 	
 	mesh_calc_modifiers(
-	        depsgraph, scene, ob, vertCos, false, 0, false, dataMask, -1, false, false, false,
+	        depsgraph, scene, ob, vertCos, false, 0, false, dataMask, -1, false, false, false, false,
 	        NULL, &final);
 
 	return final;
@@ -2852,7 +3345,7 @@ DerivedMesh *mesh_create_derived_no_deform_render(
 	DerivedMesh *final;
 
 	mesh_calc_modifiers(
-	        depsgraph, scene, ob, vertCos, true, 0, false, dataMask, -1, false, false, false,
+	        depsgraph, scene, ob, vertCos, true, 0, false, dataMask, -1, false, false, false, false,
 	        NULL, &final);
 
 	return final;
@@ -2907,12 +3400,100 @@ DerivedMesh *editbmesh_get_derived_base(Object *obedit, BMEditMesh *em, CustomDa
 
 /***/
 
+static ThreadMutex array_instances_lock = BLI_MUTEX_INITIALIZER;
+
+/* Copy the base mesh for every instance, the same way the array modifier does without merging. */
+static DerivedMesh *array_instances_realize(DerivedMesh *dm, const ObjectArrayInstances *instances)
+{
+	const int totvert = dm->getNumVerts(dm);
+	const int totedge = dm->getNumEdges(dm);
+	const int totloop = dm->getNumLoops(dm);
+	const int totpoly = dm->getNumPolys(dm);
+	DerivedMesh *result;
+	MVert *mv;
+	MEdge *me;
+	MLoop *ml;
+	MPoly *mp;
+	float offset[4][4];
+	int c, i;
+
+	result = CDDM_from_template(
+	        dm, totvert * instances->count, totedge * instances->count, 0,
+	        totloop * instances->count, totpoly * instances->count);
+
+	DM_copy_vert_data(dm, result, 0, 0, totvert);
+	DM_copy_edge_data(dm, result, 0, 0, totedge);
+	DM_copy_loop_data(dm, result, 0, 0, totloop);
+	DM_copy_poly_data(dm, result, 0, 0, totpoly);
+
+	/* subsurf for eg doesn't store the geometry in its custom data */
+	dm->copyVertArray(dm, CDDM_get_verts(result));
+	dm->copyEdgeArray(dm, CDDM_get_edges(result));
+	dm->copyLoopArray(dm, CDDM_get_loops(result));
+	dm->copyPolyArray(dm, CDDM_get_polys(result));
+
+	unit_m4(offset);
+	for (c = 1; c < instances->count; c++) {
+		mul_m4_m4m4(offset, offset, instances->offset);
+
+		CustomData_copy_data(&result->vertData, &result->vertData, 0, c * totvert, totvert);
+		CustomData_copy_data(&result->edgeData, &result->edgeData, 0, c * totedge, totedge);
+		CustomData_copy_data(&result->loopData, &result->loopData, 0, c * totloop, totloop);
+		CustomData_copy_data(&result->polyData, &result->polyData, 0, c * totpoly, totpoly);
+
+		for (i = 0, mv = CDDM_get_verts(result) + c * totvert; i < totvert; i++, mv++) {
+			mul_m4_v3(offset, mv->co);
+		}
+		for (i = 0, me = CDDM_get_edges(result) + c * totedge; i < totedge; i++, me++) {
+			me->v1 += c * totvert;
+			me->v2 += c * totvert;
+		}
+		for (i = 0, ml = CDDM_get_loops(result) + c * totloop; i < totloop; i++, ml++) {
+			ml->v += c * totvert;
+			ml->e += c * totedge;
+		}
+		for (i = 0, mp = CDDM_get_polys(result) + c * totpoly; i < totpoly; i++, mp++) {
+			mp->loopstart += c * totloop;
+		}
+	}
+
+	result->dirty |= DM_DIRTY_NORMALS;
+	DM_ensure_normals(result);
+
+	return result;
+}
+
+/**
+ * Final derived mesh of an object including the copies which the array modifier
+ * output as instances (see #OB_DUPLIARRAY), for code which needs the full geometry.
+ * The result is owned by the object.
+ */
+DerivedMesh *object_get_derived_final_realized(Object *ob)
+{
+	ObjectArrayInstances *instances = ob->array_instances;
+
+	if (instances == NULL || ob->derivedFinal == NULL) {
+		return ob->derivedFinal;
+	}
+
+	/* modifiers of several objects may use it as an operand at the same time */
+	BLI_mutex_lock(&array_instances_lock);
+	if (instances->dm_realized == NULL) {
+		DerivedMesh *dm = array_instances_realize(ob->derivedFinal, instances);
+		dm->needsFree = 0;
+		instances->dm_realized = dm;
+	}
+	BLI_mutex_unlock(&array_instances_lock);
+
+	return instances->dm_realized;
+}
+
 /* get derived mesh from an object, using editbmesh if available. */
 DerivedMesh *object_get_derived_final(Object *ob, const bool for_render)
 {
 	if (for_render) {
 		/* TODO(sergey): use proper derived render here in the future. */
-		return ob->derivedFinal;
+		return object_get_derived_final_realized(ob);
 	}
 
 	/* only return the editmesh if its from this object because
@@ -2926,7 +3507,7 @@ DerivedMesh *object_get_derived_final(Object *ob, const bool for_render)
 		}
 	}
 
-	return ob->derivedFinal;
+	return object_get_derived_final_realized(ob);
 }
 
 
@@ -411,7 +411,7 @@ static void contarget_get_mesh_mat(Object *ob, const char *substring, float mat[
 		/* when not in EditMode, use the 'final' derived mesh, depsgraph
 		 * ensures we build with CD_MDEFORMVERT layer 
 		 */
-		dm = (DerivedMesh *)ob->derivedFinal;
+		dm = object_get_derived_final_realized(ob);
 	}
 	
 	/* only continue if there's a valid DerivedMesh */
@@ -47,6 +47,7 @@
 #include "BLI_math.h"
 #include "BLI_math_color_blend.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -2306,6 +2307,194 @@ void CustomData_interp(const CustomData *source, CustomData *dest,
 	if (count > SOURCE_BUF_SIZE) MEM_freeN((void *)sources);
 }
 
+/* -------------------------------------------------------------------- */
+/* interpolation plans
+ *
+ * CustomData_interp() looks up the matching layers and goes through the layer callbacks
+ * for every element. A plan stores sources and weights of many elements up-front,
+ * so they can be interpolated a layer at a time, using dedicated loops for common layer types.
+ */
+
+CustomDataInterpPlan *CustomData_interp_plan_new(int totelem, int totsrc)
+{
+	CustomDataInterpPlan *plan = MEM_callocN(sizeof(*plan), __func__);
+
+	plan->totelem = totelem;
+	plan->totsrc = totsrc;
+	plan->offsets = MEM_malloc_arrayN((size_t)totelem + 1, sizeof(*plan->offsets), __func__);
+	plan->src_indices = MEM_malloc_arrayN((size_t)totsrc, sizeof(*plan->src_indices), __func__);
+	plan->weights = MEM_malloc_arrayN((size_t)totsrc, sizeof(*plan->weights), __func__);
+
+	plan->offsets[0] = 0;
+	plan->offsets[totelem] = totsrc;
+
+	return plan;
+}
+
+void CustomData_interp_plan_free(CustomDataInterpPlan *plan)
+{
+	MEM_freeN(plan->offsets);
+	MEM_freeN(plan->src_indices);
+	MEM_freeN(plan->weights);
+	MEM_freeN(plan);
+}
+
+typedef struct InterpPlanLayerData {
+	const CustomDataInterpPlan *plan;
+	const LayerTypeInfo *typeInfo;
+	const void *src_data;
+	void *dst_data;
+} InterpPlanLayerData;
+
+/* same as layerInterp_mloopuv() without sub-weights */
+static void interp_plan_mloopuv_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const InterpPlanLayerData *data = userdata;
+	const CustomDataInterpPlan *plan = data->plan;
+	const MLoopUV *src = data->src_data;
+	MLoopUV *dst = (MLoopUV *)data->dst_data + i;
+	float uv[2] = {0.0f, 0.0f};
+	int flag = 0;
+
+	for (int j = plan->offsets[i]; j < plan->offsets[i + 1]; j++) {
+		const MLoopUV *luv = &src[plan->src_indices[j]];
+		const float weight = plan->weights[j];
+		madd_v2_v2fl(uv, luv->uv, weight);
+		if (weight > 0.0f) {
+			flag |= luv->flag;
+		}
+	}
+
+	copy_v2_v2(dst->uv, uv);
+	dst->flag = flag;
+}
+
+/* same as layerInterp_mloopcol() without sub-weights */
+static void interp_plan_mloopcol_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const InterpPlanLayerData *data = userdata;
+	const CustomDataInterpPlan *plan = data->plan;
+	const MLoopCol *src = data->src_data;
+	MLoopCol *dst = (MLoopCol *)data->dst_data + i;
+	float col[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+	for (int j = plan->offsets[i]; j < plan->offsets[i + 1]; j++) {
+		const MLoopCol *mcol = &src[plan->src_indices[j]];
+		const float weight = plan->weights[j];
+		col[0] += mcol->r * weight;
+		col[1] += mcol->g * weight;
+		col[2] += mcol->b * weight;
+		col[3] += mcol->a * weight;
+	}
+
+	dst->r = round_fl_to_uchar_clamp(col[0]);
+	dst->g = round_fl_to_uchar_clamp(col[1]);
+	dst->b = round_fl_to_uchar_clamp(col[2]);
+	dst->a = round_fl_to_uchar_clamp(col[3]);
+}
+
+/* any other type, through its interp callback */
+static void interp_plan_generic_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const InterpPlanLayerData *data = userdata;
+	const CustomDataInterpPlan *plan = data->plan;
+	const LayerTypeInfo *typeInfo = data->typeInfo;
+	const int offset = plan->offsets[i];
+	const int count = plan->offsets[i + 1] - offset;
+	const void *source_buf[SOURCE_BUF_SIZE];
+	const void **sources = source_buf;
+
+	if (count > SOURCE_BUF_SIZE)
+		sources = MEM_malloc_arrayN(count, sizeof(*sources), __func__);
+
+	for (int j = 0; j < count; j++) {
+		sources[j] = POINTER_OFFSET(data->src_data, (size_t)plan->src_indices[offset + j] * typeInfo->size);
+	}
+
+	typeInfo->interp(sources, &plan->weights[offset], NULL, count,
+	                 POINTER_OFFSET(data->dst_data, (size_t)i * typeInfo->size));
+
+	if (count > SOURCE_BUF_SIZE) MEM_freeN((void *)sources);
+}
+
+/**
+ * Interpolate all layers like #CustomData_interp, for the \a plan->totelem elements
+ * starting at \a dest_index.
+ *
+ * \note \a source and \a dest must not share layer data.
+ */
+void CustomData_interp_plan_apply(
+        const CustomData *source, CustomData *dest,
+        const CustomDataInterpPlan *plan, int dest_index)
+{
+	int src_i, dest_i;
+
+	if (plan->totelem == 0)
+		return;
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (plan->totelem > 10000);
+
+	/* interpolates a layer at a time */
+	dest_i = 0;
+	for (src_i = 0; src_i < source->totlayer; ++src_i) {
+		const int type = source->layers[src_i].type;
+		const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+		if (!typeInfo->interp) continue;
+
+		/* find the first dest layer with type >= the source type
+		 * (this should work because layers are ordered by type)
+		 */
+		while (dest_i < dest->totlayer && dest->layers[dest_i].type < type) {
+			dest_i++;
+		}
+
+		/* if there are no more dest layers, we're done */
+		if (dest_i >= dest->totlayer) break;
+
+		/* if we found a matching layer, interpolate all elements */
+		if (dest->layers[dest_i].type == type) {
+			InterpPlanLayerData data = {
+				.plan = plan,
+				.typeInfo = typeInfo,
+				.src_data = source->layers[src_i].data,
+				.dst_data = POINTER_OFFSET(dest->layers[dest_i].data, (size_t)dest_index * typeInfo->size),
+			};
+			TaskParallelRangeFunc func;
+
+			switch (type) {
+				case CD_MLOOPUV:
+					func = interp_plan_mloopuv_cb;
+					break;
+				case CD_MLOOPCOL:
+					func = interp_plan_mloopcol_cb;
+					break;
+				default:
+					func = interp_plan_generic_cb;
+					break;
+			}
+
+			BLI_task_parallel_range(0, plan->totelem, &data, func, &settings);
+
+			/* if there are multiple source & dest layers of the same type,
+			 * we don't want to copy all source layers to the same dest, so
+			 * increment dest_i
+			 */
+			dest_i++;
+		}
+	}
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data (e.g. corner data [UVs, VCol, ...] of
@@ -1150,7 +1150,7 @@ bool BKE_object_data_transfer_dm(
 	 *     Also, we need to make a local copy of dm_src, otherwise we may end with concurrent creation
 	 *     of data in it (multi-threaded evaluation of the modifier stack, see T46672).
 	 */
-	dm_src = dm_dst ? ob_src->derivedFinal : mesh_get_derived_final(depsgraph, scene, ob_src, dm_src_mask);
+	dm_src = dm_dst ? object_get_derived_final_realized(ob_src) : mesh_get_derived_final(depsgraph, scene, ob_src, dm_src_mask);
 	if (!dm_src) {
 		return changed;
 	}
@@ -4131,6 +4131,63 @@ bool BKE_image_has_ibuf(Image *ima, ImageUser *iuser)
 	return ibuf != NULL;
 }
 
+/**
+ * Load a frame of an image sequence into the image cache ahead of time,
+ * can be called from any thread.
+ *
+ * Unlike #BKE_image_acquire_ibuf the file is decoded into a private buffer
+ * without holding the image lock, and without changing the current frame
+ * of the image. Only plain image sequences are handled, multi-view and
+ * multi-layer images are left to regular loading.
+ */
+void BKE_image_prefetch_sequence_frame(Image *ima, const ImageUser *iuser, int frame)
+{
+	ImageUser iuser_t = *iuser;
+	ImBuf *ibuf;
+	char name[FILE_MAX];
+	char colorspace[MAX_COLORSPACE_NAME];
+	const int index = IMA_MAKE_INDEX(frame, 0);
+	int flag;
+
+	iuser_t.framenr = frame;
+
+	BLI_spin_lock(&image_spin);
+	if (ima->source != IMA_SRC_SEQUENCE || ima->type != IMA_TYPE_IMAGE ||
+	    BKE_image_is_multiview(ima) || imagecache_get(ima, index))
+	{
+		BLI_spin_unlock(&image_spin);
+		return;
+	}
+	BKE_image_user_file_path(&iuser_t, ima, name);
+	BLI_strncpy(colorspace, ima->colorspace_settings.name, sizeof(colorspace));
+	flag = IB_rect | IB_multilayer | imbuf_alpha_flags_for_image(ima);
+	BLI_spin_unlock(&image_spin);
+
+	ibuf = IMB_loadiffname(name, flag, colorspace);
+	if (ibuf == NULL) {
+		return;
+	}
+
+#ifdef WITH_OPENEXR
+	if (ibuf->ftype == IMB_FTYPE_OPENEXR && ibuf->userdata) {
+		/* multi-layer file, the image type changes on regular loading */
+		IMB_exr_close(ibuf->userdata);
+		ibuf->userdata = NULL;
+		IMB_freeImBuf(ibuf);
+		return;
+	}
+#endif
+
+	BLI_spin_lock(&image_spin);
+	/* the main thread may have loaded the frame meanwhile */
+	if (imagecache_get(ima, index) == NULL) {
+		image_initialize_after_load(ima, ibuf);
+		image_assign_ibuf(ima, ibuf, 0, frame);
+	}
+	IMB_freeImBuf(ibuf);
+	BLI_spin_unlock(&image_spin);
+}
+
 /* ******** Pool for image buffers ********  */
 
 typedef struct ImagePoolEntry {
@@ -419,6 +419,57 @@ bool BKE_mesh_clear_edit_data(struct Mesh *me)
 	return true;
 }
 
+/**
+ * Vertex to loop map for gathering vertex normals, see #BKE_mesh_calc_normals_poly_ex.
+ *
+ * Building the map costs about as much as one normal calculation, so it is only
+ * built once the same topology is seen a second time, meshes which are only
+ * evaluated once never pay for it. Returns NULL while the map isn't built.
+ */
+const MeshElemMap *BKE_mesh_vert_loop_map_ensure(Mesh *me)
+{
+	MeshRuntime *runtime = &me->runtime;
+
+	if (runtime->vert_loop_map_mloop != me->mloop ||
+	    runtime->vert_loop_map_mpoly != me->mpoly ||
+	    runtime->vert_loop_map_totvert != me->totvert ||
+	    runtime->vert_loop_map_totloop != me->totloop)
+	{
+		BKE_mesh_vert_loop_map_clear(me);
+		runtime->vert_loop_map_mloop = me->mloop;
+		runtime->vert_loop_map_mpoly = me->mpoly;
+		runtime->vert_loop_map_totvert = me->totvert;
+		runtime->vert_loop_map_totloop = me->totloop;
+		return NULL;
+	}
+
+	if (runtime->vert_loop_map == NULL) {
+		MeshElemMap *map;
+		int *mem;
+
+		BKE_mesh_vert_loop_map_create(&map, &mem, me->mpoly, me->mloop, me->totvert, me->totpoly, me->totloop);
+		runtime->vert_loop_map = map;
+		runtime->vert_loop_map_mem = mem;
+	}
+	return runtime->vert_loop_map;
+}
+
+/**
+ * Free the vertex to loop map, needed when loops are modified in place.
+ * Reallocated loops are detected by #BKE_mesh_vert_loop_map_ensure.
+ */
+void BKE_mesh_vert_loop_map_clear(Mesh *me)
+{
+	MeshRuntime *runtime = &me->runtime;
+
+	MEM_SAFE_FREE(runtime->vert_loop_map);
+	MEM_SAFE_FREE(runtime->vert_loop_map_mem);
+	runtime->vert_loop_map_mloop = NULL;
+	runtime->vert_loop_map_mpoly = NULL;
+	runtime->vert_loop_map_totvert = 0;
+	runtime->vert_loop_map_totloop = 0;
+}
+
 
 bool BKE_mesh_ensure_facemap_customdata(struct Mesh *me)
 {
@@ -495,6 +546,9 @@ void BKE_mesh_update_customdata_pointers(Mesh *me, const bool do_ensure_tess_cd)
 
 	me->mloopcol = CustomData_get_layer(&me->ldata, CD_MLOOPCOL);
 	me->mloopuv = CustomData_get_layer(&me->ldata, CD_MLOOPUV);
+
+	/* layers may have been reallocated at the same address */
+	BKE_mesh_vert_loop_map_clear(me);
 }
 
 bool BKE_mesh_has_custom_loop_normals(Mesh *me)
@@ -514,6 +568,7 @@ void BKE_mesh_free(Mesh *me)
 
 	BKE_mesh_batch_cache_free(me);
 	BKE_mesh_clear_edit_data(me);
+	BKE_mesh_vert_loop_map_clear(me);
 
 	CustomData_free(&me->vdata, me->totvert);
 	CustomData_free(&me->edata, me->totedge);
@@ -588,6 +643,10 @@ void BKE_mesh_copy_data(Main *bmain, Mesh *me_dst, const Mesh *me_src, const int
 
 	me_dst->mat = MEM_dupallocN(me_src->mat);
 
+	/* owned by the source, not to be freed when updating pointers below */
+	me_dst->runtime.vert_loop_map = NULL;
+	me_dst->runtime.vert_loop_map_mem = NULL;
+
 	CustomData_copy(&me_src->vdata, &me_dst->vdata, CD_MASK_MESH, CD_DUPLICATE, me_dst->totvert);
 	CustomData_copy(&me_src->edata, &me_dst->edata, CD_MASK_MESH, CD_DUPLICATE, me_dst->totedge);
 	CustomData_copy(&me_src->ldata, &me_dst->ldata, CD_MASK_MESH, CD_DUPLICATE, me_dst->totloop);
@@ -53,6 +53,7 @@
 #include "BKE_customdata.h"
 #include "BKE_global.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_multires.h"
 #include "BKE_report.h"
 
@@ -175,6 +176,7 @@ typedef struct MeshCalcNormalsData {
 	float (*pnors)[3];
 	float (*lnors_weighted)[3];
 	float (*vnors)[3];
+	const MeshElemMap *vert_loop_map;
 } MeshCalcNormalsData;
 
 static void mesh_calc_normals_poly_cb(
@@ -203,16 +205,41 @@ static void mesh_calc_normals_poly_prepare_cb(
 	float (*lnors_weighted)[3] = data->lnors_weighted;
 
 	const int nverts = mp->totloop;
-	float (*edgevecbuf)[3] = BLI_array_alloca(edgevecbuf, (size_t)nverts);
+	float (*edgevecbuf)[3];
+	float edgevecbuf_quad[4][3];
 	int i;
 
 	/* Polygon Normal and edge-vector */
+	if (ELEM(nverts, 3, 4)) {
+		/* Triangles and quads make up most meshes, use fixed size storage and
+		 * the direct normal functions like #BKE_mesh_calc_poly_normal does. */
+		const float *v[4];
+
+		edgevecbuf = edgevecbuf_quad;
+		for (i = 0; i < nverts; i++) {
+			v[i] = mverts[ml[i].v].co;
+		}
+		for (i = 0; i < nverts; i++) {
+			sub_v3_v3v3(edgevecbuf[i], v[i], v[(i + 1) % nverts]);
+			normalize_v3(edgevecbuf[i]);
+		}
+		if (UNLIKELY(((nverts == 3) ?
+		              normal_tri_v3(pnor, v[0], v[1], v[2]) :
+		              normal_quad_v3(pnor, v[0], v[1], v[2], v[3])) == 0.0f))
+		{
+			zero_v3(pnor);
+			pnor[2] = 1.0f;
+		}
+	}
 	/* inline version of #BKE_mesh_calc_poly_normal, also does edge-vectors */
-	{
+	else {
 		int i_prev = nverts - 1;
-		const float *v_prev = mverts[ml[i_prev].v].co;
+		const float *v_prev;
 		const float *v_curr;
 
+		edgevecbuf = BLI_array_alloca(edgevecbuf, (size_t)nverts);
+		v_prev = mverts[ml[i_prev].v].co;
+
 		zero_v3(pnor);
 		/* Newell's Method */
 		for (i = 0; i < nverts; i++) {
@@ -253,13 +280,8 @@ static void mesh_calc_normals_poly_prepare_cb(
 	}
 }
 
-static void mesh_calc_normals_poly_finalize_cb(
-        void *__restrict userdata,
-        const int vidx,
-        const ParallelRangeTLS *__restrict UNUSED(tls))
+BLI_INLINE void mesh_calc_normals_vert_finalize(MeshCalcNormalsData *data, const int vidx)
 {
-	MeshCalcNormalsData *data = userdata;
-
 	MVert *mv = &data->mverts[vidx];
 	float *no = data->vnors[vidx];
 
@@ -271,11 +293,55 @@ static void mesh_calc_normals_poly_finalize_cb(
 	normal_float_to_short_v3(mv->no, no);
 }
 
+static void mesh_calc_normals_poly_finalize_cb(
+        void *__restrict userdata,
+        const int vidx,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	mesh_calc_normals_vert_finalize(userdata, vidx);
+}
+
+/* Gather weighted loop normals of each vertex through the vertex to loop map,
+ * every vertex is written by one thread only so no locking is needed. Loops
+ * are summed in the same order as the serial accumulation. */
+static void mesh_calc_normals_poly_gather_cb(
+        void *__restrict userdata,
+        const int vidx,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	MeshCalcNormalsData *data = userdata;
+	const MeshElemMap *map = &data->vert_loop_map[vidx];
+	float *no = data->vnors[vidx];
+	int i;
+
+	zero_v3(no);
+	for (i = 0; i < map->count; i++) {
+		add_v3_v3(no, data->lnors_weighted[map->indices[i]]);
+	}
+
+	mesh_calc_normals_vert_finalize(data, vidx);
+}
+
 void BKE_mesh_calc_normals_poly(
         MVert *mverts, float (*r_vertnors)[3], int numVerts,
         const MLoop *mloop, const MPoly *mpolys,
         int numLoops, int numPolys, float (*r_polynors)[3],
         const bool only_face_normals)
+{
+	BKE_mesh_calc_normals_poly_ex(
+	        mverts, r_vertnors, numVerts, mloop, mpolys,
+	        numLoops, numPolys, r_polynors, only_face_normals, NULL);
+}
+
+/**
+ * \param vert_loop_map: Optional map from #BKE_mesh_vert_loop_map_create,
+ * vertex normals are then gathered in parallel instead of accumulated serially.
+ */
+void BKE_mesh_calc_normals_poly_ex(
+        MVert *mverts, float (*r_vertnors)[3], int numVerts,
+        const MLoop *mloop, const MPoly *mpolys,
+        int numLoops, int numPolys, float (*r_polynors)[3],
+        const bool only_face_normals, const MeshElemMap *vert_loop_map)
 {
 	float (*pnors)[3] = r_polynors;
 
@@ -304,18 +370,30 @@ void BKE_mesh_calc_normals_poly(
 		vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
 		free_vnors = true;
 	}
-	else {
+	else if (vert_loop_map == NULL) {
 		memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
 	}
 
 	MeshCalcNormalsData data = {
 	    .mpolys = mpolys, .mloop = mloop, .mverts = mverts,
-	    .pnors = pnors, .lnors_weighted = lnors_weighted, .vnors = vnors
+	    .pnors = pnors, .lnors_weighted = lnors_weighted, .vnors = vnors,
+	    .vert_loop_map = vert_loop_map
 	};
 
 	/* Compute poly normals, and prepare weighted loop normals. */
 	BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
 
+	if (vert_loop_map) {
+		/* Accumulate and normalize in one threaded pass. */
+		BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_gather_cb, &settings);
+
+		if (free_vnors) {
+			MEM_freeN(vnors);
+		}
+		MEM_freeN(lnors_weighted);
+		return;
+	}
+
 	/* Actually accumulate weighted loop normals into vertex ones. */
 	/* Unfortunately, not possible to thread that (not in a reasonable, totally lock- and barrier-free fashion),
 	 * since several loops will point to the same vertex... */
@@ -337,9 +415,9 @@ void BKE_mesh_calc_normals(Mesh *mesh)
 #ifdef DEBUG_TIME
 	TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
-	BKE_mesh_calc_normals_poly(mesh->mvert, NULL, mesh->totvert,
-	                           mesh->mloop, mesh->mpoly, mesh->totloop, mesh->totpoly,
-	                           NULL, false);
+	BKE_mesh_calc_normals_poly_ex(mesh->mvert, NULL, mesh->totvert,
+	                              mesh->mloop, mesh->mpoly, mesh->totloop, mesh->totpoly,
+	                              NULL, false, BKE_mesh_vert_loop_map_ensure(mesh));
 #ifdef DEBUG_TIME
 	TIMEIT_END_AVERAGED(BKE_mesh_calc_normals);
 #endif
@@ -440,6 +440,27 @@ bool modifiers_isSoftbodyEnabled(Object *ob)
 	return (md && md->mode & (eModifierMode_Realtime | eModifierMode_Render));
 }
 
+/**
+ * Array modifier which outputs its copies as instances of derivedFinal, see #OB_DUPLIARRAY.
+ * Instancing is only used when it is the last enabled modifier of the stack.
+ */
+ArrayModifierData *modifiers_findInstancedArray(Object *ob)
+{
+	ModifierData *md;
+
+	if (ob->array_instances == NULL) {
+		return NULL;
+	}
+
+	for (md = ob->modifiers.last; md; md = md->prev) {
+		if (md->mode & (eModifierMode_Realtime | eModifierMode_Render)) {
+			return (md->type == eModifierType_Array) ? (ArrayModifierData *)md : NULL;
+		}
+	}
+
+	return NULL;
+}
+
 bool modifiers_isClothEnabled(Object *ob)
 {
 	ModifierData *md = modifiers_findByType(ob, eModifierType_Cloth);
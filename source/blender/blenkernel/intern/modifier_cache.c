@@ -0,0 +1,240 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenkernel/intern/modifier_cache.c
+ *  \ingroup bke
+ *
+ * Least recently used cache of modifier results. Modifier stacks of different
+ * objects are evaluated from multiple threads, so all access is locked.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "BKE_cdderivedmesh.h"
+#include "BKE_customdata.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_modifier_cache.h"
+
+typedef struct ModifierResultKey {
+	const void *data;
+	size_t len;
+	unsigned int hash;
+} ModifierResultKey;
+
+typedef struct ModifierResult {
+	struct ModifierResult *next, *prev;
+	/* key data is stored after the struct and compared in full on lookup */
+	ModifierResultKey key;
+	DerivedMesh *dm;
+	size_t memory;
+} ModifierResult;
+
+typedef struct ModifierResultCache {
+	/* ModifierResult, least recently used first. */
+	ListBase results;
+	/* ModifierResultKey -> ModifierResult. */
+	GHash *lookup;
+	size_t memory;
+	size_t limit;
+	double min_time;
+	ThreadMutex mutex;
+} ModifierResultCache;
+
+static void modifier_result_key_init(ModifierResultKey *key, const void *data, size_t len)
+{
+	key->data = data;
+	key->len = len;
+	key->hash = BLI_hash_mm2((const unsigned char *)data, len, 0);
+}
+
+static unsigned int modifier_result_key_hash(const void *key_v)
+{
+	return ((const ModifierResultKey *)key_v)->hash;
+}
+
+static bool modifier_result_key_cmp(const void *a_v, const void *b_v)
+{
+	const ModifierResultKey *a = a_v, *b = b_v;
+	return ((a->hash != b->hash) || (a->len != b->len) || (memcmp(a->data, b->data, a->len) != 0));
+}
+
+static size_t customdata_memory(const CustomData *data, int totelem)
+{
+	size_t memory = 0;
+	int i;
+
+	for (i = 0; i < data->totlayer; i++) {
+		if (data->layers[i].data) {
+			memory += (size_t)CustomData_sizeof(data->layers[i].type) * totelem;
+		}
+	}
+	return memory;
+}
+
+static size_t derivedmesh_memory(const DerivedMesh *dm)
+{
+	return (customdata_memory(&dm->vertData, dm->numVertData) +
+	        customdata_memory(&dm->edgeData, dm->numEdgeData) +
+	        customdata_memory(&dm->faceData, dm->numTessFaceData) +
+	        customdata_memory(&dm->loopData, dm->numLoopData) +
+	        customdata_memory(&dm->polyData, dm->numPolyData));
+}
+
+static void modifier_result_free(ModifierResultCache *cache, ModifierResult *result)
+{
+	BLI_ghash_remove(cache->lookup, &result->key, NULL, NULL);
+	BLI_remlink(&cache->results, result);
+	cache->memory -= result->memory;
+	result->dm->release(result->dm);
+	MEM_freeN(result);
+}
+
+static void modifier_result_cache_trim(ModifierResultCache *cache, size_t limit)
+{
+	while (cache->memory > limit && cache->results.first) {
+		modifier_result_free(cache, cache->results.first);
+	}
+}
+
+ModifierResultCache *BKE_modifier_result_cache_new(void)
+{
+	ModifierResultCache *cache = MEM_callocN(sizeof(ModifierResultCache), "modifier result cache");
+
+	cache->lookup = BLI_ghash_new(modifier_result_key_hash, modifier_result_key_cmp, __func__);
+	cache->limit = MODIFIER_RESULT_CACHE_DEFAULT_LIMIT;
+	cache->min_time = MODIFIER_RESULT_CACHE_DEFAULT_MIN_TIME;
+	BLI_mutex_init(&cache->mutex);
+
+	return cache;
+}
+
+void BKE_modifier_result_cache_free(ModifierResultCache *cache)
+{
+	BKE_modifier_result_cache_clear(cache);
+	BLI_ghash_free(cache->lookup, NULL, NULL);
+	BLI_mutex_end(&cache->mutex);
+	MEM_freeN(cache);
+}
+
+void BKE_modifier_result_cache_clear(ModifierResultCache *cache)
+{
+	BLI_mutex_lock(&cache->mutex);
+	modifier_result_cache_trim(cache, 0);
+	BLI_mutex_unlock(&cache->mutex);
+}
+
+void BKE_modifier_result_cache_limit_set(ModifierResultCache *cache, size_t limit)
+{
+	BLI_mutex_lock(&cache->mutex);
+	cache->limit = limit;
+	modifier_result_cache_trim(cache, limit);
+	BLI_mutex_unlock(&cache->mutex);
+}
+
+void BKE_modifier_result_cache_min_time_set(ModifierResultCache *cache, double min_time)
+{
+	BLI_mutex_lock(&cache->mutex);
+	cache->min_time = min_time;
+	BLI_mutex_unlock(&cache->mutex);
+}
+
+size_t BKE_modifier_result_cache_memory_get(ModifierResultCache *cache)
+{
+	size_t memory;
+
+	BLI_mutex_lock(&cache->mutex);
+	memory = cache->memory;
+	BLI_mutex_unlock(&cache->mutex);
+
+	return memory;
+}
+
+DerivedMesh *BKE_modifier_result_cache_lookup(ModifierResultCache *cache, const void *key_data, size_t key_len)
+{
+	ModifierResultKey key;
+	ModifierResult *result;
+	DerivedMesh *dm = NULL;
+
+	modifier_result_key_init(&key, key_data, key_len);
+
+	BLI_mutex_lock(&cache->mutex);
+	result = BLI_ghash_lookup(cache->lookup, &key);
+	if (result) {
+		/* most recently used goes last */
+		BLI_remlink(&cache->results, result);
+		BLI_addtail(&cache->results, result);
+		dm = CDDM_copy(result->dm);
+	}
+	BLI_mutex_unlock(&cache->mutex);
+
+	return dm;
+}
+
+void BKE_modifier_result_cache_store(
+        ModifierResultCache *cache, const void *key_data, size_t key_len, DerivedMesh *dm, double time)
+{
+	ModifierResult *result;
+	ModifierResultKey key;
+	size_t memory;
+
+	/* settings are read under the lock, they may be changed from another thread */
+	BLI_mutex_lock(&cache->mutex);
+	if (time < cache->min_time) {
+		BLI_mutex_unlock(&cache->mutex);
+		return;
+	}
+	BLI_mutex_unlock(&cache->mutex);
+
+	/* the key is kept along with the result, so count it too */
+	memory = derivedmesh_memory(dm) + key_len;
+
+	modifier_result_key_init(&key, key_data, key_len);
+
+	result = MEM_callocN(sizeof(ModifierResult) + key_len, "modifier result");
+	memcpy(result + 1, key_data, key_len);
+	result->key = key;
+	result->key.data = result + 1;
+	result->dm = CDDM_copy(dm);
+	result->memory = memory;
+
+	BLI_mutex_lock(&cache->mutex);
+	if (memory > cache->limit || BLI_ghash_haskey(cache->lookup, &result->key)) {
+		/* too big, or stored by another thread meanwhile */
+		BLI_mutex_unlock(&cache->mutex);
+		result->dm->release(result->dm);
+		MEM_freeN(result);
+		return;
+	}
+	modifier_result_cache_trim(cache, cache->limit - memory);
+	BLI_addtail(&cache->results, result);
+	BLI_ghash_insert(cache->lookup, &result->key, result);
+	cache->memory += memory;
+	BLI_mutex_unlock(&cache->mutex);
+}
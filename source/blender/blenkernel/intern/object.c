@@ -184,6 +184,20 @@ void BKE_object_free_curve_cache(Object *ob)
 	}
 }
 
+/* The instances belong to derivedFinal, so they are freed along with it. */
+void BKE_object_free_array_instances(Object *ob)
+{
+	if (ob->array_instances) {
+		if (ob->array_instances->dm_realized) {
+			ob->array_instances->dm_realized->needsFree = 1;
+			ob->array_instances->dm_realized->release(ob->array_instances->dm_realized);
+		}
+		MEM_freeN(ob->array_instances);
+		ob->array_instances = NULL;
+	}
+	ob->transflag &= ~OB_DUPLIARRAY;
+}
+
 void BKE_object_free_modifiers(Object *ob, const int flag)
 {
 	ModifierData *md;
@@ -352,6 +366,7 @@ void BKE_object_free_derived_caches(Object *ob)
 	}
 
 	BKE_object_free_curve_cache(ob);
+	BKE_object_free_array_instances(ob);
 }
 
 void BKE_object_free_caches(Object *object)
@@ -1209,6 +1224,7 @@ void BKE_object_copy_data(Main *UNUSED(bmain), Object *ob_dst, const Object *ob_
 	
 	/* Do not copy runtime curve data. */
 	ob_dst->curve_cache = NULL;
+	ob_dst->array_instances = NULL;
 
 	/* Do not copy object's preview (mostly due to the fact renderers create temp copy of objects). */
 	if ((flag & LIB_ID_COPY_NO_PREVIEW) == 0 && false) {  /* XXX TODO temp hack */
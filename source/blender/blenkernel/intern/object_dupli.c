@@ -1174,6 +1174,32 @@ static const DupliGenerator gen_dupli_particles = {
     make_duplis_particles           /* make_duplis */
 };
 
+/* OB_DUPLIARRAY */
+static void make_duplis_array(const DupliContext *ctx)
+{
+	Object *ob = ctx->object;
+	const ObjectArrayInstances *instances = ob->array_instances;
+	float offset[4][4], mat[4][4];
+	int c;
+
+	if (instances == NULL)
+		return;
+
+	/* the object's own mesh is the first copy,
+	 * the offset accumulates the same way as in the modifier */
+	unit_m4(offset);
+	for (c = 1; c < instances->count; c++) {
+		mul_m4_m4m4(offset, offset, instances->offset);
+		mul_m4_m4m4(mat, ob->obmat, offset);
+		make_dupli(ctx, ob, mat, c, false, false, NULL);
+	}
+}
+
+static const DupliGenerator gen_dupli_array = {
+    OB_DUPLIARRAY,                  /* type */
+    make_duplis_array               /* make_duplis */
+};
+
 /* ------------- */
 
 /* select dupli generator from given context */
@@ -1210,6 +1236,10 @@ static const DupliGenerator *get_dupli_generator(const DupliContext *ctx)
 	else if (transflag & OB_DUPLIGROUP) {
 		return &gen_dupli_group;
 	}
+	else if (transflag & OB_DUPLIARRAY) {
+		if (ctx->object->type == OB_MESH)
+			return &gen_dupli_array;
+	}
 
 	return NULL;
 }
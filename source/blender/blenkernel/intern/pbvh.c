@@ -1240,6 +1240,18 @@ void BKE_pbvh_update(PBVH *bvh, int flag, float (*fnors)[3])
 	if (nodes) MEM_freeN(nodes);
 }
 
+/* Draw buffers keep their vertex data during strokes to update it in place,
+ * free it once the stroke is done. */
+void BKE_pbvh_draw_buffers_data_free(PBVH *bvh)
+{
+	for (int i = 0; i < bvh->totnode; i++) {
+		PBVHNode *node = &bvh->nodes[i];
+		if ((node->flag & PBVH_Leaf) && node->draw_buffers) {
+			GPU_pbvh_buffers_data_free(node->draw_buffers);
+		}
+	}
+}
+
 void BKE_pbvh_redraw_BB(PBVH *bvh, float bb_min[3], float bb_max[3])
 {
 	PBVHIter iter;
@@ -239,7 +239,7 @@ static DerivedMesh *rigidbody_get_mesh(Object *ob)
 		return ob->derivedDeform;
 	}
 	else if (ob->rigidbody_object->mesh_source == RBO_MESH_FINAL) {
-		return ob->derivedFinal;
+		return object_get_derived_final_realized(ob);
 	}
 	else {
 		return CDDM_from_mesh(ob->data);
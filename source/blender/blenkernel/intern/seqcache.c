@@ -40,6 +40,7 @@
 #include "IMB_imbuf_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
@@ -68,6 +69,8 @@ typedef struct SeqPreprocessCache {
 
 static struct MovieCache *moviecache = NULL;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
+/* the prefetch job accesses the movie cache from its own thread */
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
 
 static void preprocessed_cache_destruct(void);
 
@@ -123,18 +126,56 @@ static bool seqcache_hashcmp(const void *a_, const void *b_)
 
 void BKE_sequencer_cache_destruct(void)
 {
+	BKE_sequencer_prefetch_stop();
+
 	if (moviecache)
 		IMB_moviecache_free(moviecache);
 
 	preprocessed_cache_destruct();
 }
 
+/* Cached frames are invalidated on edits, the prefetch job renders from a copy of
+ * the scene made before the edit so it has to be stopped. */
+static void seqcache_prefetch_stop(void)
+{
+	if (BLI_thread_is_main()) {
+		BKE_sequencer_prefetch_stop();
+	}
+}
+
+static bool seqcache_key_init(
+        SeqCacheKey *key, const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
+{
+	key->context = *context;
+
+	if (context->is_prefetch_render) {
+		/* frames rendered by the prefetch job are stored for the original scene */
+		if (!BKE_sequencer_prefetch_get_original_context(context, &key->context)) {
+			return false;
+		}
+		seq = BKE_sequencer_prefetch_get_original_sequence(seq);
+		if (seq == NULL) {
+			return false;
+		}
+	}
+
+	key->seq = seq;
+	key->cfra = cfra - seq->start;
+	key->type = type;
+
+	return true;
+}
+
 void BKE_sequencer_cache_cleanup(void)
 {
+	seqcache_prefetch_stop();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
 		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
 	}
+	BLI_mutex_unlock(&cache_lock);
 
 	BKE_sequencer_preprocessed_cache_cleanup();
 }
@@ -149,24 +190,31 @@ static bool seqcache_key_check_seq(ImBuf *UNUSED(ibuf), void *userkey, void *use
 
 void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
 {
+	seqcache_prefetch_stop();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache)
 		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
+	BLI_mutex_unlock(&cache_lock);
 }
 
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
-	if (moviecache && seq) {
-		SeqCacheKey key;
+	ImBuf *ibuf = NULL;
+	SeqCacheKey key;
 
-		key.seq = seq;
-		key.context = *context;
-		key.cfra = cfra - seq->start;
-		key.type = type;
+	if (seq == NULL || !seqcache_key_init(&key, context, seq, cfra, type)) {
+		return NULL;
+	}
 
-		return IMB_moviecache_get(moviecache, &key);
+	/* the prefetch thread may create the cache while the main thread frees it */
+	BLI_mutex_lock(&cache_lock);
+	if (moviecache) {
+		ibuf = IMB_moviecache_get(moviecache, &key);
 	}
+	BLI_mutex_unlock(&cache_lock);
 
-	return NULL;
+	return ibuf;
 }
 
 void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *i)
@@ -177,16 +225,17 @@ void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float
 		return;
 	}
 
+	if (!seqcache_key_init(&key, context, seq, cfra, type)) {
+		return;
+	}
+
+	BLI_mutex_lock(&cache_lock);
 	if (!moviecache) {
 		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
 	}
 
-	key.seq = seq;
-	key.context = *context;
-	key.cfra = cfra - seq->start;
-	key.type = type;
-
 	IMB_moviecache_put(moviecache, &key, i);
+	BLI_mutex_unlock(&cache_lock);
 }
 
 void BKE_sequencer_preprocessed_cache_cleanup(void)
@@ -219,7 +268,8 @@ ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequen
 {
 	SeqPreprocessCacheElem *elem;
 
-	if (!preprocess_cache)
+	/* the preprocessed cache only holds the current frame of the main thread */
+	if (!preprocess_cache || context->is_prefetch_render)
 		return NULL;
 
 	if (preprocess_cache->cfra != cfra)
@@ -246,6 +296,10 @@ void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence
 {
 	SeqPreprocessCacheElem *elem;
 
+	if (context->is_prefetch_render) {
+		return;
+	}
+
 	if (!preprocess_cache) {
 		preprocess_cache = MEM_callocN(sizeof(SeqPreprocessCache), "sequencer preprocessed cache");
 	}
@@ -0,0 +1,346 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenkernel/intern/seqprefetch.c
+ *  \ingroup bke
+ *
+ * Renders the frames following the current frame in a background thread during
+ * playback, so they are in the cache by the time they are drawn.
+ *
+ * The job renders from its own copy of the scene, made when the job starts.
+ * Frames are stored in the cache for the original scene and strips. Any cache
+ * invalidation stops the job, the next playback request starts it again with
+ * a fresh copy.
+ */
+
+#include <stddef.h>
+#include <math.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "BKE_animsys.h"
+#include "BKE_library.h"
+#include "BKE_sequencer.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+typedef struct SeqPrefetchJob {
+	/* original scene, the one frames are cached for */
+	Scene *scene;
+	/* copy of the scene rendered by the job */
+	Scene *scene_copy;
+	/* strip of scene_copy -> original strip */
+	GHash *seq_orig;
+
+	SeqRenderData context;
+	int chanshown;
+	int start_frame, end_frame;
+
+	ListBase threads;
+	ThreadMutex mutex;
+	ThreadCondition cond;
+
+	/* last frame requested by playback and next frame to render, protected by mutex */
+	float cfra;
+	float next_frame;
+	bool stop;
+} SeqPrefetchJob;
+
+static SeqPrefetchJob *prefetch_job = NULL;
+
+/* Strips which render through data shared with the main thread,
+ * text strips draw with the global render font which is not thread safe. */
+static int seq_prefetch_check_supported(Sequence *seq, void *UNUSED(arg))
+{
+	if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_TEXT)) {
+		return -1;
+	}
+	return 1;
+}
+
+/* After duplication the tmp pointer of the original strips point to their copy. */
+static int seq_prefetch_map_original(Sequence *seq, void *seq_orig_v)
+{
+	GHash *seq_orig = seq_orig_v;
+
+	if (seq->tmp) {
+		BLI_ghash_insert(seq_orig, seq->tmp, seq);
+	}
+	return 1;
+}
+
+static void seq_prefetch_scene_copy_free(Scene *scene)
+{
+	bAction *action = scene->adt ? scene->adt->action : NULL;
+	Sequence *seq;
+
+	if (scene->ed) {
+		/* sounds got no user when copying */
+		SEQ_BEGIN (scene->ed, seq)
+		{
+			seq->sound = NULL;
+		}
+		SEQ_END
+	}
+
+	/* the action is freed last, freeing the strips would remove their F-Curves from it */
+	BKE_animdata_free(&scene->id, false);
+
+	BKE_sequencer_editing_free_ex(scene, false);
+	BKE_id_free_ex(NULL, scene, LIB_ID_FREE_NO_UI_USER | LIB_ID_FREE_NO_DEG_TAG, true);
+
+	if (action) {
+		BKE_id_free_ex(NULL, action, LIB_ID_FREE_NO_UI_USER | LIB_ID_FREE_NO_DEG_TAG, true);
+	}
+}
+
+static void seq_prefetch_render_frame(SeqPrefetchJob *job, float cfra)
+{
+	Scene *scene = job->scene_copy;
+	SeqRenderData context = job->context;
+	ImBuf *ibuf;
+
+	context.scene = scene;
+	context.is_prefetch_render = true;
+
+	/* same animation evaluation the dependency graph does for the original scene,
+	 * scenes with drivers are not prefetched */
+	scene->r.cfra = (int)cfra;
+	if (scene->adt) {
+		BKE_animsys_evaluate_animdata(scene, &scene->id, scene->adt, cfra, ADT_RECALC_ANIM);
+	}
+
+	/* frames which are already cached are only looked up */
+	ibuf = BKE_sequencer_give_ibuf(&context, cfra, job->chanshown);
+
+	if (ibuf) {
+		IMB_freeImBuf(ibuf);
+	}
+}
+
+static void *seq_prefetch_thread(void *job_v)
+{
+	SeqPrefetchJob *job = job_v;
+
+	BLI_mutex_lock(&job->mutex);
+	while (!job->stop) {
+		float frame;
+
+		if (job->next_frame > job->cfra + U.prefetchframes) {
+			BLI_condition_wait(&job->cond, &job->mutex);
+			continue;
+		}
+
+		frame = job->next_frame;
+		job->next_frame += 1.0f;
+		BLI_mutex_unlock(&job->mutex);
+
+		/* playback loops back to the start of the range */
+		if (frame > job->end_frame && job->end_frame > job->start_frame) {
+			frame = job->start_frame + fmodf(frame - job->end_frame - 1, job->end_frame - job->start_frame + 1);
+		}
+
+		seq_prefetch_render_frame(job, frame);
+
+		BLI_mutex_lock(&job->mutex);
+	}
+	BLI_mutex_unlock(&job->mutex);
+
+	return NULL;
+}
+
+static bool seq_prefetch_job_matches(const SeqPrefetchJob *job, const SeqRenderData *context, int chanshown)
+{
+	return ((job->scene == context->scene) &&
+	        (job->chanshown == chanshown) &&
+	        (job->context.bmain == context->bmain) &&
+	        (job->context.rectx == context->rectx) &&
+	        (job->context.recty == context->recty) &&
+	        (job->context.preview_render_size == context->preview_render_size) &&
+	        (job->context.motion_blur_samples == context->motion_blur_samples) &&
+	        (job->context.motion_blur_shutter == context->motion_blur_shutter) &&
+	        (job->context.view_id == context->view_id));
+}
+
+static SeqPrefetchJob *seq_prefetch_job_create(const SeqRenderData *context, float cfra, int chanshown)
+{
+	Scene *scene = context->scene;
+	Editing *ed = scene->ed;
+	SeqPrefetchJob *job;
+
+	if (ed == NULL) {
+		return NULL;
+	}
+
+	/* the copy is rendered from the top level, not from inside a meta strip */
+	if (!BLI_listbase_is_empty(&ed->metastack)) {
+		return NULL;
+	}
+
+	if (BKE_sequencer_base_recursive_apply(&ed->seqbase, seq_prefetch_check_supported, NULL) == -1) {
+		return NULL;
+	}
+
+	/* the copy only evaluates the active action, drivers may run python and
+	 * can't be evaluated outside the main thread, NLA strips use actions of their own */
+	if (scene->adt && (!BLI_listbase_is_empty(&scene->adt->drivers) ||
+	                   !BLI_listbase_is_empty(&scene->adt->nla_tracks)))
+	{
+		return NULL;
+	}
+
+	job = MEM_callocN(sizeof(SeqPrefetchJob), "sequencer prefetch job");
+
+	job->scene = scene;
+	BKE_id_copy_ex(NULL, &scene->id, (ID **)&job->scene_copy,
+	               LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT |
+	               LIB_ID_CREATE_NO_DEG_TAG | LIB_ID_COPY_NO_PREVIEW,
+	               false);
+
+	/* LIB_ID_COPY_ACTIONS needs a main database, the action is copied separately so
+	 * keyframes edited on the main thread are not read while the job evaluates them */
+	if (job->scene_copy->adt && job->scene_copy->adt->action) {
+		BKE_id_copy_ex(NULL, &job->scene_copy->adt->action->id, (ID **)&job->scene_copy->adt->action,
+		               LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT | LIB_ID_CREATE_NO_DEG_TAG,
+		               false);
+	}
+
+	job->seq_orig = BLI_ghash_ptr_new(__func__);
+	BKE_sequencer_base_recursive_apply(&ed->seqbase, seq_prefetch_map_original, job->seq_orig);
+
+	job->context = *context;
+	job->chanshown = chanshown;
+	job->start_frame = PSFRA;
+	job->end_frame = PEFRA;
+	job->cfra = cfra;
+	job->next_frame = cfra + 1.0f;
+
+	BLI_mutex_init(&job->mutex);
+	BLI_condition_init(&job->cond);
+
+	/* the cache looks the job up from the thread */
+	prefetch_job = job;
+
+	BLI_threadpool_init(&job->threads, seq_prefetch_thread, 1);
+	BLI_threadpool_insert(&job->threads, job);
+
+	return job;
+}
+
+/**
+ * Request the frames following \a cfra to be rendered, called from the main thread
+ * when a frame is drawn during playback. The number of frames rendered ahead is
+ * set by the Prefetch Frames user preference.
+ */
+void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, int chanshown)
+{
+	SeqPrefetchJob *job = prefetch_job;
+
+	if (U.prefetchframes <= 0 || context->for_render || context->is_proxy_render || context->skip_cache) {
+		return;
+	}
+
+	if (job && !seq_prefetch_job_matches(job, context, chanshown)) {
+		BKE_sequencer_prefetch_stop();
+		job = NULL;
+	}
+
+	if (job == NULL) {
+		job = seq_prefetch_job_create(context, cfra, chanshown);
+		if (job == NULL) {
+			return;
+		}
+	}
+
+	BLI_mutex_lock(&job->mutex);
+	/* restart from the current frame after seeking */
+	if (job->next_frame <= cfra || job->next_frame > cfra + U.prefetchframes + 1) {
+		job->next_frame = cfra + 1.0f;
+	}
+	job->cfra = cfra;
+	BLI_condition_notify_one(&job->cond);
+	BLI_mutex_unlock(&job->mutex);
+}
+
+/**
+ * Stop the job and free its copy of the scene, waits for the frame being rendered.
+ */
+void BKE_sequencer_prefetch_stop(void)
+{
+	SeqPrefetchJob *job = prefetch_job;
+
+	if (job == NULL) {
+		return;
+	}
+
+	BLI_mutex_lock(&job->mutex);
+	job->stop = true;
+	BLI_condition_notify_one(&job->cond);
+	BLI_mutex_unlock(&job->mutex);
+
+	BLI_threadpool_end(&job->threads);
+
+	prefetch_job = NULL;
+
+	BLI_condition_end(&job->cond);
+	BLI_mutex_end(&job->mutex);
+
+	BLI_ghash_free(job->seq_orig, NULL, NULL);
+	seq_prefetch_scene_copy_free(job->scene_copy);
+
+	MEM_freeN(job);
+}
+
+bool BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context, SeqRenderData *r_context)
+{
+	SeqPrefetchJob *job = prefetch_job;
+
+	if (job == NULL || context->scene != job->scene_copy) {
+		return false;
+	}
+
+	*r_context = *context;
+	r_context->scene = job->scene;
+	r_context->is_prefetch_render = false;
+
+	return true;
+}
+
+Sequence *BKE_sequencer_prefetch_get_original_sequence(Sequence *seq)
+{
+	SeqPrefetchJob *job = prefetch_job;
+
+	if (job == NULL) {
+		return NULL;
+	}
+
+	return BLI_ghash_lookup(job->seq_orig, seq);
+}
@@ -56,6 +56,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_edgehash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_task.h"
@@ -64,6 +65,7 @@
 #include "BKE_pbvh.h"
 #include "BKE_ccg.h"
 #include "BKE_cdderivedmesh.h"
+#include "BKE_customdata.h"
 #include "BKE_global.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_mapping.h"
@@ -90,7 +92,8 @@ static CCGDerivedMesh *getCCGDerivedMesh(CCGSubSurf *ss,
                                          int drawInteriorEdges,
                                          int useSubsurfUv,
                                          DerivedMesh *dm,
-                                         bool use_gpu_backend);
+                                         bool use_gpu_backend,
+                                         CustomDataInterpPlan **loop_plan_cache);
 static int ccgDM_use_grid_pbvh(CCGDerivedMesh *ccgdm);
 
 ///
@@ -2516,10 +2519,64 @@ static void create_ccgdm_maps(CCGDerivedMesh *ccgdm,
 /* Fill in all geometry arrays making it possible to access any
  * hires data from the CPU.
  */
+/* Loop data of all faces is interpolated in one go, the plan only depends on the
+ * number of verts of each face and the subdivision level, so callers can keep it
+ * between evaluations. */
+static CustomDataInterpPlan *ccgdm_loop_interp_plan_ensure(CCGDerivedMesh *ccgdm,
+                                                          int gridFaces,
+                                                          CustomDataInterpPlan **plan_cache,
+                                                          bool *r_is_new)
+{
+	CCGSubSurf *ss = ccgdm->ss;
+	const int totface = ccgSubSurf_getNumFaces(ss);
+	CustomDataInterpPlan *plan;
+	BLI_HashMurmur2A mm2;
+	int index, totelem = 0, totsrc = 0;
+	uint32_t key;
+
+	BLI_hash_mm2a_init(&mm2, (uint32_t)gridFaces);
+	for (index = 0; index < totface; index++) {
+		const int numVerts = ccgSubSurf_getFaceNumVerts(ccgdm->faceMap[index].face);
+		BLI_hash_mm2a_add_int(&mm2, numVerts);
+		totelem += numVerts * gridFaces * gridFaces * 4;
+		totsrc += numVerts * numVerts * gridFaces * gridFaces * 4;
+	}
+	key = BLI_hash_mm2a_end(&mm2);
+
+	if (plan_cache && *plan_cache) {
+		plan = *plan_cache;
+		if (plan->key == key && plan->totelem == totelem && plan->totsrc == totsrc) {
+			*r_is_new = false;
+			return plan;
+		}
+		CustomData_interp_plan_free(plan);
+		*plan_cache = NULL;
+	}
+
+	plan = CustomData_interp_plan_new(totelem, totsrc);
+	plan->key = key;
+	if (plan_cache) {
+		*plan_cache = plan;
+	}
+	*r_is_new = true;
+	return plan;
+}
+
+BLI_INLINE void ccgdm_loop_interp_plan_set(CustomDataInterpPlan *plan, int index,
+                                           const int *src_indices, const float *weights, int count)
+{
+	const int offset = plan->offsets[index];
+
+	memcpy(&plan->src_indices[offset], src_indices, sizeof(*src_indices) * count);
+	memcpy(&plan->weights[offset], weights, sizeof(*weights) * count);
+	plan->offsets[index + 1] = offset + count;
+}
+
 static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
                                    CCGSubSurf *ss,
                                    DerivedMesh *dm,
-                                   bool useSubsurfUv)
+                                   bool useSubsurfUv,
+                                   CustomDataInterpPlan **loop_plan_cache)
 {
 	const int totvert = ccgSubSurf_getNumVerts(ss);
 	const int totedge = ccgSubSurf_getNumEdges(ss);
@@ -2546,6 +2603,8 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 	MEdge *medge = NULL;
 	MPoly *mpoly = NULL;
 	bool has_edge_cd;
+	CustomDataInterpPlan *loop_plan = NULL;
+	bool loop_plan_build = false;
 
 	edgeSize = ccgSubSurf_getEdgeSize(ss);
 	gridSize = ccgSubSurf_getGridSize(ss);
@@ -2578,6 +2637,10 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 	mcol = DM_get_tessface_data_layer(&ccgdm->dm, CD_MCOL);
 #endif
 
+	if (CustomData_has_interp(&dm->loopData)) {
+		loop_plan = ccgdm_loop_interp_plan_ensure(ccgdm, gridFaces, loop_plan_cache, &loop_plan_build);
+	}
+
 	loopindex = loopindex2 = 0; /* current loop index */
 	for (index = 0; index < totface; index++) {
 		CCGFace *f = ccgdm->faceMap[index].face;
@@ -2675,25 +2738,20 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 			/*interpolate per-face data*/
 			for (y = 0; y < gridFaces; y++) {
 				for (x = 0; x < gridFaces; x++) {
-					w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
-					loopindex2++;
+					if (loop_plan_build) {
+						w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
+						ccgdm_loop_interp_plan_set(loop_plan, loopindex2, loopidx, w2, numVerts);
 
-					w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x)) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
-					loopindex2++;
+						w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x)) * numVerts;
+						ccgdm_loop_interp_plan_set(loop_plan, loopindex2 + 1, loopidx, w2, numVerts);
 
-					w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x + 1)) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
-					loopindex2++;
+						w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x + 1)) * numVerts;
+						ccgdm_loop_interp_plan_set(loop_plan, loopindex2 + 2, loopidx, w2, numVerts);
 
-					w2 = w + s * numVerts * g2_wid * g2_wid + ((y) * g2_wid + (x + 1)) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
-					loopindex2++;
+						w2 = w + s * numVerts * g2_wid * g2_wid + ((y) * g2_wid + (x + 1)) * numVerts;
+						ccgdm_loop_interp_plan_set(loop_plan, loopindex2 + 3, loopidx, w2, numVerts);
+					}
+					loopindex2 += 4;
 
 					/*copy over poly data, e.g. mtexpoly*/
 					CustomData_copy_data(&dm->polyData, &ccgdm->dm.polyData, origIndex, faceNum, 1);
@@ -2724,6 +2782,14 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 		edgeNum += numFinalEdges;
 	}
 
+	/* interpolate per-loop data */
+	if (loop_plan) {
+		CustomData_interp_plan_apply(&dm->loopData, &ccgdm->dm.loopData, loop_plan, 0);
+		if (loop_plan_cache == NULL) {
+			CustomData_interp_plan_free(loop_plan);
+		}
+	}
+
 	for (index = 0; index < totedge; ++index) {
 		CCGEdge *e = ccgdm->edgeMap[index].edge;
 		int numFinalEdges = edgeSize - 1;
@@ -2840,7 +2906,8 @@ static CCGDerivedMesh *getCCGDerivedMesh(CCGSubSurf *ss,
                                          int drawInteriorEdges,
                                          int useSubsurfUv,
                                          DerivedMesh *dm,
-                                         bool use_gpu_backend)
+                                         bool use_gpu_backend,
+                                         CustomDataInterpPlan **loop_plan_cache)
 {
 #ifdef WITH_OPENSUBDIV
 	const int totedge = dm->getNumEdges(dm);
@@ -2890,7 +2957,7 @@ static CCGDerivedMesh *getCCGDerivedMesh(CCGSubSurf *ss,
 	ccgdm->faceFlags = MEM_callocN(sizeof(DMFlagMat) * totface, "faceFlags");
 
 	if (use_gpu_backend == false) {
-		set_ccgdm_all_geometry(ccgdm, ss, dm, useSubsurfUv != 0);
+		set_ccgdm_all_geometry(ccgdm, ss, dm, useSubsurfUv != 0, loop_plan_cache);
 	}
 	else {
 		set_ccgdm_gpu_geometry(ccgdm, dm);
@@ -2958,7 +3025,8 @@ struct DerivedMesh *subsurf_make_derived_from_derived(
 		ss_sync_from_derivedmesh(smd->emCache, dm, vertCos, useSimple, useSubsurfUv);
 		result = getCCGDerivedMesh(smd->emCache,
 		                           drawInteriorEdges,
-		                           useSubsurfUv, dm, use_gpu_backend);
+		                           useSubsurfUv, dm, use_gpu_backend,
+		                           (CustomDataInterpPlan **)&smd->loopPlanCache);
 	}
 	else if (flags & SUBSURF_USE_RENDER_PARAMS) {
 		/* Do not use cache in render mode. */
@@ -2973,7 +3041,7 @@ struct DerivedMesh *subsurf_make_derived_from_derived(
 		ss_sync_from_derivedmesh(ss, dm, vertCos, useSimple, useSubsurfUv);
 
 		result = getCCGDerivedMesh(ss,
-		                           drawInteriorEdges, useSubsurfUv, dm, false);
+		                           drawInteriorEdges, useSubsurfUv, dm, false, NULL);
 
 		result->freeSS = 1;
 	}
@@ -3005,7 +3073,8 @@ struct DerivedMesh *subsurf_make_derived_from_derived(
 
 			result = getCCGDerivedMesh(smd->mCache,
 			                           drawInteriorEdges,
-			                           useSubsurfUv, dm, false);
+			                           useSubsurfUv, dm, false,
+			                           (CustomDataInterpPlan **)&smd->loopPlanCache);
 		}
 		else {
 			CCGFlags ccg_flags = useSimple | CCG_USE_ARENA | CCG_CALC_NORMALS;
@@ -3043,7 +3112,9 @@ struct DerivedMesh *subsurf_make_derived_from_derived(
 #endif
 			ss_sync_from_derivedmesh(ss, dm, vertCos, useSimple, useSubsurfUv);
 
-			result = getCCGDerivedMesh(ss, drawInteriorEdges, useSubsurfUv, dm, use_gpu_backend);
+			result = getCCGDerivedMesh(ss, drawInteriorEdges, useSubsurfUv, dm, use_gpu_backend,
+			                           (flags & SUBSURF_IS_FINAL_CALC) ?
+			                           (CustomDataInterpPlan **)&smd->loopPlanCache : NULL);
 
 			if (flags & SUBSURF_IS_FINAL_CALC)
 				smd->mCache = ss;
@@ -0,0 +1,53 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_SPATIAL_HASH_H__
+#define __BLI_SPATIAL_HASH_H__
+
+/** \file BLI_spatial_hash.h
+ *  \ingroup bli
+ *  \brief A uniform grid of points, hashed into buckets.
+ *
+ * Faster to build than a #KDTree and queries are threaded,
+ * suited to searches within a small range such as finding duplicates.
+ */
+
+#include "BLI_compiler_attrs.h"
+
+struct SpatialHash;
+typedef struct SpatialHash SpatialHash;
+
+SpatialHash *BLI_spatial_hash_new(unsigned int maxsize, float cell_size);
+void BLI_spatial_hash_free(SpatialHash *hash);
+void BLI_spatial_hash_balance(SpatialHash *hash) ATTR_NONNULL(1);
+
+void BLI_spatial_hash_insert(
+        SpatialHash *hash, int index,
+        const float co[3]) ATTR_NONNULL(1, 3);
+
+int BLI_spatial_hash_find_nearest(
+        const SpatialHash *hash, const float co[3], float range,
+        float *r_dist_sq) ATTR_NONNULL(1, 2);
+
+int BLI_spatial_hash_calc_duplicates(
+        const SpatialHash *hash, const float range,
+        int *duplicates) ATTR_NONNULL(1, 3);
+
+#endif  /* __BLI_SPATIAL_HASH_H__ */
@@ -29,6 +29,7 @@
 
 #include "BLI_math.h"
 #include "BLI_kdtree.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_strict_flags.h"
 
@@ -61,6 +62,13 @@ struct KDTree {
 
 #define KD_NODE_UNSET ((uint)-1)
 
+/* Setting zero so we can catch bugs in BLI_task. */
+#ifdef DEBUG
+#  define KD_THREAD_THRESHOLD 0
+#else
+#  define KD_THREAD_THRESHOLD 10000
+#endif
+
 /**
  * Creates or free a kdtree
  */
@@ -735,6 +743,59 @@ static void deduplicate_recursive(const struct DeDuplicateParams *p, uint i)
 	}
 }
 
+/**
+ * Same as #deduplicate_recursive without merging,
+ * return true when there is anything to merge into \a p->search.
+ */
+static bool deduplicate_candidate_recursive(const struct DeDuplicateParams *p, uint i)
+{
+	const KDTreeNode *node = &p->nodes[i];
+	if (p->search_co[node->d] + p->range <= node->co[node->d]) {
+		return (node->left != KD_NODE_UNSET) && deduplicate_candidate_recursive(p, node->left);
+	}
+	else if (p->search_co[node->d] - p->range >= node->co[node->d]) {
+		return (node->right != KD_NODE_UNSET) && deduplicate_candidate_recursive(p, node->right);
+	}
+	else {
+		if ((p->search != node->index) && (p->duplicates[node->index] == -1)) {
+			if (compare_len_squared_v3v3(node->co, p->search_co, p->range_sq)) {
+				return true;
+			}
+		}
+		return (((node->left != KD_NODE_UNSET) && deduplicate_candidate_recursive(p, node->left)) ||
+		        ((node->right != KD_NODE_UNSET) && deduplicate_candidate_recursive(p, node->right)));
+	}
+}
+
+struct DeDuplicateCandidateData {
+	const struct DeDuplicateParams *p;
+	uint root;
+	/* NULL to loop in tree order */
+	const uint *order;
+	bool *has_candidate;
+};
+
+static void deduplicate_candidate_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const struct DeDuplicateCandidateData *data = userdata;
+	const uint node_index = data->order ? data->order[i] : (uint)i;
+	const KDTreeNode *node = &data->p->nodes[node_index];
+	const int index = node->index;
+
+	if (ELEM(data->p->duplicates[index], -1, index)) {
+		struct DeDuplicateParams p = *data->p;
+		p.search = index;
+		copy_v3_v3(p.search_co, node->co);
+		data->has_candidate[i] = deduplicate_candidate_recursive(&p, data->root);
+	}
+	else {
+		data->has_candidate[i] = false;
+	}
+}
+
 /**
  * Find duplicate points in \a range.
  * Favors speed over quality since it doesn't find the best target vertex for merging.
@@ -751,7 +812,8 @@ static void deduplicate_recursive(const struct DeDuplicateParams *p, uint i)
  * although it can still be used as a target.
  * \returns The numebr of merges found (includes any merges already in the \a duplicates array).
  *
- * \note Merging is always a single step (target indices wont be marked for merging). 
+ * \note Merging is always a single step (target indices wont be marked for merging).
+ * \note Large trees are searched from multiple threads, results don't depend on the number of threads.
  */
 int BLI_kdtree_calc_duplicates_fast(
         const KDTree *tree, const float range, bool use_index_order,
@@ -765,30 +827,39 @@ int BLI_kdtree_calc_duplicates_fast(
 		.duplicates = duplicates,
 		.duplicates_found = &found,
 	};
+	uint *order = use_index_order ? kdtree_order(tree) : NULL;
+	bool *has_candidate = NULL;
+
+	if (tree->totnode > KD_THREAD_THRESHOLD) {
+		/* Points which have anything to merge are found in parallel, only those are merged
+		 * in order below. Merging only removes candidates, so this doesn't change the result. */
+		struct DeDuplicateCandidateData data = {
+			.p = &p,
+			.root = tree->root,
+			.order = order,
+			.has_candidate = MEM_mallocN(sizeof(bool) * tree->totnode, __func__),
+		};
+		ParallelRangeSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		BLI_task_parallel_range(0, (int)tree->totnode, &data, deduplicate_candidate_cb, &settings);
+		has_candidate = data.has_candidate;
+	}
 
-	if (use_index_order) {
-		uint *order = kdtree_order(tree);
-		for (uint i = 0; i < tree->totnode; i++) {
-			const uint node_index = order[i];
-			const int index = (int)i;
-			if (ELEM(duplicates[index], -1, index)) {
-				p.search = index;
-				copy_v3_v3(p.search_co, tree->nodes[node_index].co);
-				deduplicate_recursive(&p, tree->root);
-			}
+	for (uint i = 0; i < tree->totnode; i++) {
+		const uint node_index = order ? order[i] : i;
+		const int index = p.nodes[node_index].index;
+		if ((has_candidate == NULL || has_candidate[i]) && ELEM(duplicates[index], -1, index)) {
+			p.search = index;
+			copy_v3_v3(p.search_co, tree->nodes[node_index].co);
+			deduplicate_recursive(&p, tree->root);
 		}
+	}
+
+	if (order) {
 		MEM_freeN(order);
 	}
-	else {
-		for (uint i = 0; i < tree->totnode; i++) {
-			const uint node_index = i;
-			const int index = p.nodes[node_index].index;
-			if (ELEM(duplicates[index], -1, index)) {
-				p.search = index;
-				copy_v3_v3(p.search_co, tree->nodes[node_index].co);
-				deduplicate_recursive(&p, tree->root);
-			}
-		}
+	if (has_candidate) {
+		MEM_freeN(has_candidate);
 	}
 	return found;
 }
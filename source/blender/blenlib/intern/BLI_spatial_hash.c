@@ -0,0 +1,440 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/BLI_spatial_hash.c
+ *  \ingroup bli
+ *
+ * Points are binned into cells of a uniform grid, cells are hashed into a
+ * fixed number of buckets (cells sharing a bucket are separated by the distance test).
+ * Points are stored sorted by bucket so searches read contiguous memory.
+ *
+ * Points which aren't finite are kept after the last bucket, they are never found
+ * and searching from a position which isn't finite finds nothing.
+ */
+
+#include <math.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_spatial_hash.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+#include "BLI_strict_flags.h"
+
+/* Setting zero so we can catch bugs in BLI_task. */
+#ifdef DEBUG
+#  define SPATIAL_HASH_THREAD_THRESHOLD 0
+#else
+#  define SPATIAL_HASH_THREAD_THRESHOLD 10000
+#endif
+
+/* Cells are clamped to this, so a cell range never overflows. */
+#define SPATIAL_HASH_CELL_MAX ((int64_t)1 << 60)
+
+typedef struct SpatialHashPoint {
+	float co[3];
+	int index;
+} SpatialHashPoint;
+
+struct SpatialHash {
+	SpatialHashPoint *points;
+	uint totpoint;
+	/* Start of each bucket in points, bucket_mask + 3 long,
+	 * the last bucket holds points which aren't finite. */
+	uint *buckets;
+	uint bucket_mask;
+	float cell_size_inv;
+#ifdef DEBUG
+	bool is_balanced;  /* ensure we call balance first */
+	uint maxsize;   /* max number of points */
+#endif
+};
+
+/**
+ * Creates or free a spatial hash,
+ * searches are fastest with a \a cell_size of twice the search range (8 cells per search).
+ */
+SpatialHash *BLI_spatial_hash_new(uint maxsize, float cell_size)
+{
+	SpatialHash *hash;
+
+	hash = MEM_mallocN(sizeof(SpatialHash), "SpatialHash");
+	hash->points = MEM_malloc_arrayN(maxsize, sizeof(SpatialHashPoint), "SpatialHashPoint");
+	hash->totpoint = 0;
+	hash->buckets = NULL;
+	hash->bucket_mask = 0;
+	/* avoid overflowing cell coordinates with a zero range */
+	hash->cell_size_inv = 1.0f / max_ff(cell_size, 1e-6f);
+
+#ifdef DEBUG
+	hash->is_balanced = false;
+	hash->maxsize = maxsize;
+#endif
+
+	return hash;
+}
+
+void BLI_spatial_hash_free(SpatialHash *hash)
+{
+	if (hash) {
+		MEM_freeN(hash->points);
+		MEM_SAFE_FREE(hash->buckets);
+		MEM_freeN(hash);
+	}
+}
+
+/**
+ * Construction: first insert points, then call balance.
+ */
+void BLI_spatial_hash_insert(SpatialHash *hash, int index, const float co[3])
+{
+	SpatialHashPoint *point = &hash->points[hash->totpoint++];
+
+#ifdef DEBUG
+	BLI_assert(hash->totpoint <= hash->maxsize);
+#endif
+
+	copy_v3_v3(point->co, co);
+	point->index = index;
+
+#ifdef DEBUG
+	hash->is_balanced = false;
+#endif
+}
+
+BLI_INLINE bool spatial_hash_co_is_finite(const float co[3])
+{
+	return (isfinite(co[0]) && isfinite(co[1]) && isfinite(co[2]));
+}
+
+BLI_INLINE int64_t spatial_hash_cell(const SpatialHash *hash, const float f)
+{
+	const double cell = floor((double)f * (double)hash->cell_size_inv);
+	/* converting values out of range is undefined, comparisons are false for NaN */
+	if (!(cell > (double)-SPATIAL_HASH_CELL_MAX)) {
+		return -SPATIAL_HASH_CELL_MAX;
+	}
+	else if (!(cell < (double)SPATIAL_HASH_CELL_MAX)) {
+		return SPATIAL_HASH_CELL_MAX;
+	}
+	return (int64_t)cell;
+}
+
+BLI_INLINE uint spatial_hash_bucket(const SpatialHash *hash, const int64_t x, const int64_t y, const int64_t z)
+{
+	const uint64_t h = (((uint64_t)x * 73856093u) ^
+	                    ((uint64_t)y * 19349663u) ^
+	                    ((uint64_t)z * 83492791u));
+	return (uint)(h ^ (h >> 32)) & hash->bucket_mask;
+}
+
+BLI_INLINE uint spatial_hash_bucket_co(const SpatialHash *hash, const float co[3])
+{
+	return spatial_hash_bucket(
+	        hash, spatial_hash_cell(hash, co[0]), spatial_hash_cell(hash, co[1]), spatial_hash_cell(hash, co[2]));
+}
+
+typedef struct SpatialHashBalanceData {
+	const SpatialHash *hash;
+	uint *point_bucket;
+} SpatialHashBalanceData;
+
+static void spatial_hash_bucket_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	SpatialHashBalanceData *data = userdata;
+	const float *co = data->hash->points[i].co;
+	data->point_bucket[i] = spatial_hash_co_is_finite(co) ?
+	        spatial_hash_bucket_co(data->hash, co) : data->hash->bucket_mask + 1;
+}
+
+/**
+ * Sort the points by bucket, points in the same bucket keep their insertion order.
+ */
+void BLI_spatial_hash_balance(SpatialHash *hash)
+{
+	const uint bucket_len = power_of_2_max_u(MAX2(hash->totpoint, 1u));
+	SpatialHashPoint *points_sorted;
+	uint *buckets;
+	uint i;
+
+	hash->bucket_mask = bucket_len - 1;
+
+	SpatialHashBalanceData data = {
+		.hash = hash,
+		.point_bucket = MEM_malloc_arrayN(hash->totpoint, sizeof(uint), __func__),
+	};
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (hash->totpoint > SPATIAL_HASH_THREAD_THRESHOLD);
+	BLI_task_parallel_range(0, (int)hash->totpoint, &data, spatial_hash_bucket_cb, &settings);
+
+	/* counting sort, 'buckets[b + 1]' is the size of bucket 'b' */
+	MEM_SAFE_FREE(hash->buckets);
+	buckets = MEM_calloc_arrayN(bucket_len + 2, sizeof(uint), __func__);
+	for (i = 0; i < hash->totpoint; i++) {
+		buckets[data.point_bucket[i] + 1]++;
+	}
+	for (i = 0; i < bucket_len + 1; i++) {
+		buckets[i + 1] += buckets[i];
+	}
+
+	/* 'buckets[b]' is advanced to the start of the next bucket, shift back afterwards */
+	points_sorted = MEM_malloc_arrayN(MAX2(hash->totpoint, 1u), sizeof(SpatialHashPoint), "SpatialHashPoint");
+	for (i = 0; i < hash->totpoint; i++) {
+		points_sorted[buckets[data.point_bucket[i]]++] = hash->points[i];
+	}
+	memmove(&buckets[1], &buckets[0], sizeof(uint) * (bucket_len + 1));
+	buckets[0] = 0;
+
+	MEM_freeN(data.point_bucket);
+	MEM_freeN(hash->points);
+	hash->points = points_sorted;
+	hash->buckets = buckets;
+
+#ifdef DEBUG
+	hash->is_balanced = true;
+#endif
+}
+
+/**
+ * Call \a search_cb for all points within \a range of \a co, until it returns false.
+ *
+ * \note Points may be passed more than once when several cells share a bucket.
+ */
+static void spatial_hash_range_search_cb(
+        const SpatialHash *hash, const float co[3], const float range,
+        bool (*search_cb)(void *user_data, const SpatialHashPoint *point, float dist_sq), void *user_data)
+{
+	const float range_sq = range * range;
+	int64_t cell_min[3], cell_max[3];
+	uint64_t cells_len = 1;
+	uint i;
+
+#ifdef DEBUG
+	BLI_assert(hash->is_balanced == true);
+#endif
+
+	if (!spatial_hash_co_is_finite(co)) {
+		return;
+	}
+
+	for (i = 0; i < 3; i++) {
+		cell_min[i] = spatial_hash_cell(hash, co[i] - range);
+		cell_max[i] = spatial_hash_cell(hash, co[i] + range);
+		/* clamp to avoid overflow, only used to compare with the number of buckets */
+		cells_len *= (uint64_t)MIN2(cell_max[i] - cell_min[i] + 1, (int64_t)hash->bucket_mask + 2);
+		cells_len = MIN2(cells_len, (uint64_t)hash->bucket_mask + 2);
+	}
+
+	if (cells_len > (uint64_t)hash->bucket_mask + 1) {
+		/* range is large compared to the cell size, check all finite points */
+		const uint end = hash->buckets[hash->bucket_mask + 1];
+		for (i = 0; i < end; i++) {
+			const SpatialHashPoint *point = &hash->points[i];
+			const float dist_sq = len_squared_v3v3(point->co, co);
+			if (dist_sq <= range_sq) {
+				if (!search_cb(user_data, point, dist_sq)) {
+					return;
+				}
+			}
+		}
+		return;
+	}
+
+	for (int64_t z = cell_min[2]; z <= cell_max[2]; z++) {
+		for (int64_t y = cell_min[1]; y <= cell_max[1]; y++) {
+			for (int64_t x = cell_min[0]; x <= cell_max[0]; x++) {
+				const uint bucket = spatial_hash_bucket(hash, x, y, z);
+				const uint end = hash->buckets[bucket + 1];
+				for (i = hash->buckets[bucket]; i < end; i++) {
+					const SpatialHashPoint *point = &hash->points[i];
+					const float dist_sq = len_squared_v3v3(point->co, co);
+					if (dist_sq <= range_sq) {
+						if (!search_cb(user_data, point, dist_sq)) {
+							return;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+typedef struct SpatialHashNearest {
+	int index;
+	float dist_sq;
+} SpatialHashNearest;
+
+static bool spatial_hash_nearest_cb(void *user_data, const SpatialHashPoint *point, float dist_sq)
+{
+	SpatialHashNearest *nearest = user_data;
+	if ((dist_sq < nearest->dist_sq) ||
+	    ((dist_sq == nearest->dist_sq) && ((nearest->index == -1) || (point->index < nearest->index))))
+	{
+		nearest->index = point->index;
+		nearest->dist_sq = dist_sq;
+	}
+	return true;
+}
+
+/**
+ * Find the nearest point within \a range, the lowest index is used for points at the same distance.
+ * Can be called from multiple threads.
+ *
+ * \return the index of the point or -1 when there are no points within \a range.
+ */
+int BLI_spatial_hash_find_nearest(
+        const SpatialHash *hash, const float co[3], float range,
+        float *r_dist_sq)
+{
+	SpatialHashNearest nearest = {
+		.index = -1,
+		.dist_sq = range * range,
+	};
+
+	spatial_hash_range_search_cb(hash, co, range, spatial_hash_nearest_cb, &nearest);
+
+	if (r_dist_sq && nearest.index != -1) {
+		*r_dist_sq = nearest.dist_sq;
+	}
+	return nearest.index;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name BLI_spatial_hash_calc_duplicates
+ * \{ */
+
+typedef struct DeDuplicateParams {
+	const SpatialHash *hash;
+	const uint *order;
+	float range;
+	int *duplicates;
+	/* Points which have a point they could merge, before any are merged. */
+	bool *has_candidate;
+
+	/* Per Search */
+	int search;
+	int found;
+} DeDuplicateParams;
+
+static bool deduplicate_candidate_cb(void *user_data, const SpatialHashPoint *point, float UNUSED(dist_sq))
+{
+	DeDuplicateParams *p = user_data;
+	if ((p->search != point->index) && (p->duplicates[point->index] == -1)) {
+		p->found = 1;
+		return false;
+	}
+	return true;
+}
+
+static void deduplicate_candidate_task_cb(
+        void *__restrict userdata,
+        const int index,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const DeDuplicateParams *p_shared = userdata;
+
+	if (ELEM(p_shared->duplicates[index], -1, index)) {
+		DeDuplicateParams p = *p_shared;
+		p.search = index;
+		p.found = 0;
+		spatial_hash_range_search_cb(
+		        p.hash, p.hash->points[p.order[index]].co, p.range, deduplicate_candidate_cb, &p);
+		p_shared->has_candidate[index] = (p.found != 0);
+	}
+	else {
+		p_shared->has_candidate[index] = false;
+	}
+}
+
+static bool deduplicate_merge_cb(void *user_data, const SpatialHashPoint *point, float UNUSED(dist_sq))
+{
+	DeDuplicateParams *p = user_data;
+	if ((p->search != point->index) && (p->duplicates[point->index] == -1)) {
+		p->duplicates[point->index] = p->search;
+		p->found += 1;
+	}
+	return true;
+}
+
+/**
+ * Find duplicate points in \a range,
+ * gives the same result as #BLI_kdtree_calc_duplicates_fast using index order.
+ *
+ * Points which have anything to merge are found in parallel,
+ * only those are merged in a single thread since merging depends on earlier points.
+ *
+ * \param range: Coordinates in this range are candidates to be merged.
+ * \param duplicates: An array of int's the length of the number of points,
+ * indices must be aligned with the points.
+ * Values initialized to -1 are candidates to me merged.
+ * Setting the index to it's own position in the array prevents it from being touched,
+ * although it can still be used as a target.
+ * \returns The number of merges found.
+ *
+ * \note Merging is always a single step (target indices wont be marked for merging).
+ */
+int BLI_spatial_hash_calc_duplicates(
+        const SpatialHash *hash, const float range,
+        int *duplicates)
+{
+	const uint totpoint = hash->totpoint;
+	uint *order = MEM_malloc_arrayN(totpoint, sizeof(uint), __func__);
+	DeDuplicateParams p = {
+		.hash = hash,
+		.order = order,
+		.range = range,
+		.duplicates = duplicates,
+		.has_candidate = MEM_malloc_arrayN(totpoint, sizeof(bool), __func__),
+	};
+	int found = 0;
+	uint i;
+
+	for (i = 0; i < totpoint; i++) {
+		BLI_assert((uint)hash->points[i].index < totpoint);
+		order[hash->points[i].index] = i;
+	}
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (totpoint > SPATIAL_HASH_THREAD_THRESHOLD);
+	BLI_task_parallel_range(0, (int)totpoint, &p, deduplicate_candidate_task_cb, &settings);
+
+	for (i = 0; i < totpoint; i++) {
+		const int index = (int)i;
+		if (p.has_candidate[i] && ELEM(duplicates[index], -1, index)) {
+			p.search = index;
+			p.found = 0;
+			spatial_hash_range_search_cb(hash, hash->points[order[i]].co, range, deduplicate_merge_cb, &p);
+			found += p.found;
+		}
+	}
+
+	MEM_freeN(p.has_candidate);
+	MEM_freeN(order);
+
+	return found;
+}
+
+/** \} */
@@ -5009,6 +5009,7 @@ static void direct_link_modifiers(FileData *fd, ListBase *lb)
 			SubsurfModifierData *smd = (SubsurfModifierData *)md;
 			
 			smd->emCache = smd->mCache = NULL;
+			smd->loopPlanCache = NULL;
 		}
 		else if (md->type == eModifierType_Armature) {
 			ArmatureModifierData *amd = (ArmatureModifierData *)md;
@@ -5323,6 +5324,9 @@ static void direct_link_object(FileData *fd, Object *ob)
 	/* weak weak... this was only meant as draw flag, now is used in give_base_to_objects too */
 	ob->flag &= ~OB_FROMGROUP;
 
+	/* runtime, the instances are not saved, old files may also have this bit set from past features */
+	ob->transflag &= ~OB_DUPLIARRAY;
+
 	/* XXX This should not be needed - but seems like it can happen in some cases, so for now play safe... */
 	ob->proxy_from = NULL;
 
@@ -5500,6 +5504,7 @@ static void direct_link_object(FileData *fd, Object *ob)
 	ob->bb = NULL;
 	ob->derivedDeform = NULL;
 	ob->derivedFinal = NULL;
+	ob->array_instances = NULL;
 	BLI_listbase_clear(&ob->gpulamp);
 	BLI_listbase_clear(&ob->drawdata);
 	link_list(fd, &ob->pc_ids);
@@ -51,6 +51,7 @@
 
 #include "BLI_kdopbvh.h"
 #include "BLI_buffer.h"
+#include "BLI_task.h"
 
 #include "bmesh.h"
 #include "intern/bmesh_private.h"
@@ -521,7 +522,8 @@ static bool bm_loop_filter_fn(const BMLoop *l, void *user_data)
 static void bm_isect_tri_tri(
         struct ISectState *s,
         int a_index, int b_index,
-        BMLoop **a, BMLoop **b)
+        BMLoop **a, BMLoop **b,
+        const float f_a_nor[3], const float f_b_nor[3])
 {
 	BMFace *f_a = (*a)->f;
 	BMFace *f_b = (*b)->f;
@@ -529,8 +531,6 @@ static void bm_isect_tri_tri(
 	BMVert *fv_b[3] = {UNPACK3_EX(, b, ->v)};
 	const float *f_a_cos[3] = {UNPACK3_EX(, fv_a, ->co)};
 	const float *f_b_cos[3] = {UNPACK3_EX(, fv_b, ->co)};
-	float f_a_nor[3];
-	float f_b_nor[3];
 	uint i;
 
 
@@ -745,9 +745,6 @@ static void bm_isect_tri_tri(
 		goto finally;
 	}
 
-	normal_tri_v3(f_a_nor, UNPACK3(f_a_cos));
-	normal_tri_v3(f_b_nor, UNPACK3(f_b_cos));
-
 	/* edge-tri & edge-edge
 	 * -------------------- */
 	{
@@ -850,8 +847,88 @@ finally:
 
 }
 
+/**
+ * Triangle normals, calculated once for all pairs.
+ * Original vertices are never moved while intersecting, so these stay valid.
+ */
+struct LoopTriNormalData {
+	BMLoop *(*looptris)[3];
+	float (*looptri_nors)[3];
+};
+
+static void bm_looptri_normal_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	struct LoopTriNormalData *data = userdata;
+	BMLoop **lt = data->looptris[i];
+	normal_tri_v3(data->looptri_nors[i], lt[0]->v->co, lt[1]->v->co, lt[2]->v->co);
+}
+
 #ifdef USE_BVH
 
+struct ISectOverlapData {
+	BMLoop *(*looptris)[3];
+	const float (*looptri_nors)[3];
+	float eps_margin;
+};
+
+/**
+ * Check all of \a t_cos are further than \a eps from the plane of the other triangle, on the same side.
+ */
+static bool isect_tri_plane_side_test(
+        const float *t_cos[3],
+        const float plane_co[3], const float plane_no[3],
+        const float eps)
+{
+	float side[3];
+	uint i;
+
+	for (i = 0; i < 3; i++) {
+		float dir[3];
+		sub_v3_v3v3(dir, t_cos[i], plane_co);
+		side[i] = dot_v3v3(dir, plane_no);
+	}
+	return (((side[0] > eps) && (side[1] > eps) && (side[2] > eps)) ||
+	        ((side[0] < -eps) && (side[1] < -eps) && (side[2] < -eps)));
+}
+
+/**
+ * Rejects overlapping pairs which #bm_isect_tri_tri can't cut, without modifying the mesh
+ * so it can run from the threaded BVH overlap traversal.
+ *
+ * All checks in #bm_isect_tri_tri are within \a eps_margin of both triangles,
+ * so a triangle entirely on one side of the other triangles plane can't intersect it.
+ */
+static bool bm_isect_tri_tri_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
+{
+	struct ISectOverlapData *data = userdata;
+	BMLoop **a = data->looptris[index_a];
+	BMLoop **b = data->looptris[index_b];
+	const BMVert *fv_a[3] = {UNPACK3_EX(, a, ->v)};
+	const BMVert *fv_b[3] = {UNPACK3_EX(, b, ->v)};
+	const float *f_a_cos[3] = {UNPACK3_EX(, fv_a, ->co)};
+	const float *f_b_cos[3] = {UNPACK3_EX(, fv_b, ->co)};
+
+	/* same check as bm_isect_tri_tri */
+	if (UNLIKELY(ELEM(fv_a[0], UNPACK3(fv_b)) ||
+	             ELEM(fv_a[1], UNPACK3(fv_b)) ||
+	             ELEM(fv_a[2], UNPACK3(fv_b))))
+	{
+		return false;
+	}
+
+	/* degenerate triangles have a zero normal and are never rejected here */
+	if (isect_tri_plane_side_test(f_a_cos, f_b_cos[0], data->looptri_nors[index_b], data->eps_margin) ||
+	    isect_tri_plane_side_test(f_b_cos, f_a_cos[0], data->looptri_nors[index_a], data->eps_margin))
+	{
+		return false;
+	}
+
+	return true;
+}
+
 struct RaycastData {
 	const float **looptris;
 	BLI_Buffer *z_buffer;
@@ -965,6 +1042,46 @@ static int isect_bvhtree_point_v3(
 	return num_isect;
 }
 
+struct IslandSideData {
+	BMFace **ftable;
+	const int *groups_array;
+	const int (*group_index)[2];
+	int (*test_fn)(BMFace *f, void *user_data);
+	void *user_data;
+	BVHTree **tree_pair;
+	const float **looptri_coords;
+	/* -1 when the island isn't tested */
+	int *group_hits;
+};
+
+/**
+ * Count how many times a ray from each face-island crosses the other side,
+ * only reads the mesh so islands are tested in parallel.
+ */
+static void bm_isect_island_side_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	struct IslandSideData *data = userdata;
+	/* for now assyme this is an OK face to test with (not degenerate!) */
+	BMFace *f = data->ftable[data->groups_array[data->group_index[i][0]]];
+	float co[3];
+	int side = data->test_fn(f, data->user_data);
+
+	if (side == -1) {
+		data->group_hits[i] = -1;
+		return;
+	}
+	BLI_assert(ELEM(side, 0, 1));
+	side = !side;
+
+	// BM_face_calc_center_mean(f, co);
+	BM_face_calc_point_in_face(f, co);
+
+	data->group_hits[i] = isect_bvhtree_point_v3(data->tree_pair[side], data->looptri_coords, co);
+}
+
 #endif  /* USE_BVH */
 
 /**
@@ -972,6 +1089,7 @@ static int isect_bvhtree_point_v3(
  * leaving the resulting edges tagged.
  *
  * \param test_fn Return value: -1: skip, 0: tree_a, 1: tree_b (use_self == false)
+ * it's called from multiple threads, so it must not modify data.
  * \param boolean_mode -1: no-boolean, 0: intersection... see #BMESH_ISECT_BOOLEAN_ISECT.
  * \return true if the mesh is changed (intersections cut or faces removed from boolean).
  */
@@ -992,6 +1110,8 @@ bool BM_mesh_intersect(
 	/* needed for boolean, since cutting up faces moves the loops within the face */
 	const float **looptri_coords = NULL;
 
+	float (*looptri_nors)[3];
+
 #ifdef USE_BVH
 	BVHTree *tree_a, *tree_b;
 	uint tree_overlap_tot;
@@ -1048,6 +1168,18 @@ bool BM_mesh_intersect(
 	UNUSED_VARS(use_dissolve);
 #endif
 
+	looptri_nors = MEM_malloc_arrayN((size_t)looptris_tot, sizeof(*looptri_nors), __func__);
+	{
+		struct LoopTriNormalData data = {
+			.looptris = looptris,
+			.looptri_nors = looptri_nors,
+		};
+		ParallelRangeSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.use_threading = (looptris_tot >= BM_OMP_LIMIT);
+		BLI_task_parallel_range(0, looptris_tot, &data, bm_looptri_normal_cb, &settings);
+	}
+
 #ifdef USE_DUMP
 	printf("data = [\n");
 #endif
@@ -1104,7 +1236,18 @@ bool BM_mesh_intersect(
 		tree_b = tree_a;
 	}
 
-	overlap = BLI_bvhtree_overlap(tree_b, tree_a, &tree_overlap_tot, NULL, NULL);
+	/* Rejecting pairs which can't intersect runs threaded with the traversal,
+	 * the remaining pairs are cut in a single thread since they edit the mesh.
+	 * The order of pairs only depends on the trees, so results are the same
+	 * no matter how many threads are used. */
+	{
+		struct ISectOverlapData data = {
+			.looptris = looptris,
+			.looptri_nors = (const float (*)[3])looptri_nors,
+			.eps_margin = s.epsilon.eps_margin,
+		};
+		overlap = BLI_bvhtree_overlap(tree_b, tree_a, &tree_overlap_tot, bm_isect_tri_tri_overlap_cb, &data);
+	}
 
 	if (overlap) {
 		uint i;
@@ -1120,7 +1263,9 @@ bool BM_mesh_intersect(
 			        overlap[i].indexA,
 			        overlap[i].indexB,
 			        looptris[overlap[i].indexA],
-			        looptris[overlap[i].indexB]);
+			        looptris[overlap[i].indexB],
+			        looptri_nors[overlap[i].indexA],
+			        looptri_nors[overlap[i].indexB]);
 #ifdef USE_DUMP
 			printf(")),\n");
 #endif
@@ -1163,7 +1308,9 @@ bool BM_mesh_intersect(
 				        i_a,
 				        i_b,
 				        looptris[i_a],
-				        looptris[i_b]);
+				        looptris[i_b],
+				        looptri_nors[i_a],
+				        looptri_nors[i_b]);
 #ifdef USE_DUMP
 			printf(")),\n");
 #endif
@@ -1176,6 +1323,8 @@ bool BM_mesh_intersect(
 	printf("]\n");
 #endif
 
+	MEM_freeN(looptri_nors);
+
 	/* --------- */
 
 #ifdef USE_SPLICE
@@ -1536,6 +1685,7 @@ bool BM_mesh_intersect(
 		/* group vars */
 		int *groups_array;
 		int (*group_index)[2];
+		int *group_hits;
 		int group_tot;
 		int i;
 		BMFace **ftable;
@@ -1559,29 +1709,39 @@ bool BM_mesh_intersect(
 		printf("%s: Total face-groups: %d\n", __func__, group_tot);
 #endif
 
-		/* Check if island is inside/outside */
+		/* Check if island is inside/outside,
+		 * all islands are tested before any are removed or flipped. */
+		group_hits = MEM_malloc_arrayN((size_t)group_tot, sizeof(*group_hits), __func__);
+		{
+			struct IslandSideData data = {
+				.ftable = ftable,
+				.groups_array = groups_array,
+				.group_index = (const int (*)[2])group_index,
+				.test_fn = test_fn,
+				.user_data = user_data,
+				.tree_pair = tree_pair,
+				.looptri_coords = looptri_coords,
+				.group_hits = group_hits,
+			};
+			ParallelRangeSettings settings;
+			BLI_parallel_range_settings_defaults(&settings);
+			settings.use_threading = (group_tot > 1);
+			BLI_task_parallel_range(0, group_tot, &data, bm_isect_island_side_cb, &settings);
+		}
+
 		for (i = 0; i < group_tot; i++) {
 			int fg     = group_index[i][0];
 			int fg_end = group_index[i][1] + fg;
-			bool do_remove, do_flip;
+			bool do_remove = false, do_flip = false;
 
 			{
-				/* for now assyme this is an OK face to test with (not degenerate!) */
-				BMFace *f = ftable[groups_array[fg]];
-				float co[3];
-				int hits;
-				int side = test_fn(f, user_data);
+				const int hits = group_hits[i];
+				int side;
 
-				if (side == -1) {
+				if (hits == -1) {
 					continue;
 				}
-				BLI_assert(ELEM(side, 0, 1));
-				side = !side;
-
-				// BM_face_calc_center_mean(f, co);
-				BM_face_calc_point_in_face(f, co);
-
-				hits = isect_bvhtree_point_v3(tree_pair[side], looptri_coords, co);
+				side = !test_fn(ftable[groups_array[fg]], user_data);
 
 				switch (boolean_mode) {
 					case BMESH_ISECT_BOOLEAN_ISECT:
@@ -1617,6 +1777,7 @@ bool BM_mesh_intersect(
 
 		MEM_freeN(groups_array);
 		MEM_freeN(group_index);
+		MEM_freeN(group_hits);
 
 #ifdef USE_DISSOLVE
 		/* We have dissolve code above, this is alternative logic,
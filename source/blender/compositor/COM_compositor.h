@@ -319,6 +319,25 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
                  const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings,
                  const char *viewName);
 
+/**
+ * @brief Start rendering a range of frames with the compositor.
+ * Until COM_batch_end is called, image sequences used by the tree are loaded ahead of the
+ * frame being composited and file outputs are written on background I/O threads.
+ *
+ * @param prefetch_frames
+ *   number of upcoming frames to load, 0 disables prefetching
+ *
+ * @param frame_step
+ *   frame step of the render
+ */
+void COM_batch_begin(int prefetch_frames, int frame_step);
+
+/**
+ * @brief Finish rendering a range of frames.
+ * Waits for all pending file outputs and prints the frames per second that were composited.
+ */
+void COM_batch_end(void);
+
 /**
  * @brief Deinitialize the compositor caches and allocated memory.
  * Use COM_clearCaches to only free the caches.
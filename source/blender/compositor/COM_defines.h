@@ -85,6 +85,19 @@ typedef enum CompositorPriority {
  * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_QUEUE is currently default.
  */
 #define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+
+// batch rendering of frame ranges
+/**
+ * @brief number of threads loading and saving images while rendering a frame range
+ * @see BatchIO
+ */
+#define COM_BATCH_IO_THREADS 2
+
+/**
+ * @brief maximum number of file outputs waiting to be written, limits memory usage
+ */
+#define COM_BATCH_MAX_PENDING_WRITES 8
+
 // chunk order
 /**
  * @brief The order of chunks to be scheduled
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2018, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor:
+ *		Blender Foundation
+ */
+
+#include <set>
+#include <stdio.h>
+#include <utility>
+
+#include "COM_BatchIO.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "PIL_time.h"
+
+extern "C" {
+#  include "BLI_math_base.h"
+#  include "BLI_utildefines.h"
+#  include "DNA_image_types.h"
+#  include "BKE_global.h"
+#  include "BKE_image.h"
+}
+
+/* Prefetches an image sequence frame into the image cache. */
+class ImagePrefetchJob : public BatchIOJob {
+private:
+	Image *m_image;
+	ImageUser m_iuser;
+public:
+	ImagePrefetchJob(Image *image, const ImageUser *iuser, int framenr) {
+		this->m_image = image;
+		this->m_iuser = *iuser;
+		this->m_iuser.framenr = framenr;
+	}
+
+	void execute() {
+		BKE_image_prefetch_sequence_frame(this->m_image, &this->m_iuser, this->m_iuser.framenr);
+	}
+};
+
+static bool g_active = false;
+static int g_prefetch_frames = 0;
+static int g_frame_step = 1;
+static int g_frames_finished = 0;
+static int g_last_finished_frame = 0;
+static double g_start_time = 0.0;
+/// @brief image frames requested so far, avoids loading the same frame twice
+static std::set<std::pair<Image *, int> > g_prefetched;
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+static ListBase g_iothreads;
+static ThreadQueue *g_ioqueue = NULL;
+static ThreadMutex g_write_mutex = BLI_MUTEX_INITIALIZER;
+static ThreadCondition g_write_cond;
+static int g_writes_pending = 0;
+
+void *BatchIO::thread_execute(void * /*data*/)
+{
+	BatchIOJob *job;
+	while ((job = (BatchIOJob *)BLI_thread_queue_pop(g_ioqueue))) {
+		job->execute();
+		delete job;
+	}
+	return NULL;
+}
+
+/* Write jobs are wrapped so the number of writes in flight can be tracked. */
+class PendingWriteJob : public BatchIOJob {
+private:
+	BatchIOJob *m_job;
+public:
+	PendingWriteJob(BatchIOJob *job) : m_job(job) {}
+
+	void execute() {
+		this->m_job->execute();
+		delete this->m_job;
+
+		BLI_mutex_lock(&g_write_mutex);
+		g_writes_pending--;
+		BLI_condition_notify_all(&g_write_cond);
+		BLI_mutex_unlock(&g_write_mutex);
+	}
+};
+#endif
+
+void BatchIO::begin(int prefetch_frames, int frame_step)
+{
+	BLI_assert(!g_active);
+
+	g_prefetch_frames = max_ii(prefetch_frames, 0);
+	g_frame_step = max_ii(frame_step, 1);
+	g_frames_finished = 0;
+	g_last_finished_frame = 0;
+	g_start_time = PIL_check_seconds_timer();
+	g_prefetched.clear();
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	g_writes_pending = 0;
+	BLI_condition_init(&g_write_cond);
+	g_ioqueue = BLI_thread_queue_init();
+	BLI_threadpool_init(&g_iothreads, thread_execute, COM_BATCH_IO_THREADS);
+	for (int index = 0; index < COM_BATCH_IO_THREADS; index++) {
+		BLI_threadpool_insert(&g_iothreads, NULL);
+	}
+#endif
+	g_active = true;
+}
+
+void BatchIO::end()
+{
+	if (!g_active) {
+		return;
+	}
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	/* let the threads finish all queued jobs, then join them */
+	BLI_thread_queue_nowait(g_ioqueue);
+	BLI_threadpool_end(&g_iothreads);
+	BLI_thread_queue_free(g_ioqueue);
+	g_ioqueue = NULL;
+	BLI_condition_end(&g_write_cond);
+#endif
+	g_prefetched.clear();
+	g_active = false;
+
+	if ((G.debug & G_DEBUG) && g_frames_finished > 0) {
+		double duration = PIL_check_seconds_timer() - g_start_time;
+		printf("Compositor: %d frames in %.2fs (%.2f fps)\n",
+		       g_frames_finished, duration, duration > 0.0 ? g_frames_finished / duration : 0.0);
+	}
+}
+
+bool BatchIO::isActive()
+{
+	return g_active;
+}
+
+void BatchIO::write(BatchIOJob *job)
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	if (g_active) {
+		BLI_mutex_lock(&g_write_mutex);
+		while (g_writes_pending >= COM_BATCH_MAX_PENDING_WRITES) {
+			BLI_condition_wait(&g_write_cond, &g_write_mutex);
+		}
+		g_writes_pending++;
+		BLI_mutex_unlock(&g_write_mutex);
+
+		BLI_thread_queue_push(g_ioqueue, new PendingWriteJob(job));
+		return;
+	}
+#endif
+	job->execute();
+	delete job;
+}
+
+void BatchIO::prefetchImage(Image *image, const ImageUser *iuser, int cfra)
+{
+	if (!g_active || g_prefetch_frames == 0 || image == NULL || iuser == NULL) {
+		return;
+	}
+	if (image->source != IMA_SRC_SEQUENCE) {
+		return;
+	}
+
+	const int current_framenr = BKE_image_user_frame_get(iuser, cfra, 0, NULL);
+	for (int frame = cfra + g_frame_step; frame <= cfra + g_prefetch_frames * g_frame_step; frame += g_frame_step) {
+		const int framenr = BKE_image_user_frame_get(iuser, frame, 0, NULL);
+		/* held or clamped frames are already in the cache */
+		if (framenr == current_framenr) {
+			continue;
+		}
+		/* several nodes may use the same image with different frame offsets */
+		if (!g_prefetched.insert(std::make_pair(image, framenr)).second) {
+			continue;
+		}
+		BatchIOJob *job = new ImagePrefetchJob(image, iuser, framenr);
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+		BLI_thread_queue_push(g_ioqueue, job);
+#else
+		job->execute();
+		delete job;
+#endif
+	}
+}
+
+void BatchIO::frameFinished(int cfra)
+{
+	if (g_active && (g_frames_finished == 0 || cfra != g_last_finished_frame)) {
+		g_frames_finished++;
+		g_last_finished_frame = cfra;
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor:
+ *		Blender Foundation
+ */
+
+#ifndef _COM_BatchIO_h_
+#define _COM_BatchIO_h_
+
+extern "C" {
+#  include "BLI_threads.h"
+}
+
+#include "COM_defines.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+struct Image;
+struct ImageUser;
+
+/**
+ * @brief a unit of file I/O that can be executed on an I/O thread
+ * Jobs own all data they need, they are deleted after execution.
+ * @ingroup Execution
+ */
+class BatchIOJob {
+public:
+	virtual ~BatchIOJob() {}
+
+	/**
+	 * @brief perform the I/O, called from an I/O thread (or the caller when no batch is active)
+	 */
+	virtual void execute() = 0;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("COM:BatchIOJob")
+#endif
+};
+
+/**
+ * @brief pipelined file I/O for rendering frame ranges with the compositor
+ *
+ * When rendering a sequence of frames the compositor is called once per frame. Between
+ * begin and end image sequences used by image nodes are prefetched for the upcoming frames
+ * and file outputs are written on dedicated I/O threads, so loading and saving no longer
+ * sit on the critical path of the frame being composited.
+ *
+ * Outside of a batch all jobs are executed synchronously in the calling thread.
+ * @ingroup Execution
+ */
+class BatchIO {
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	/**
+	 * @brief main loop of an I/O thread
+	 */
+	static void *thread_execute(void *data);
+#endif
+public:
+	/**
+	 * @brief start a batch
+	 * @param prefetch_frames number of upcoming frames to load for image sequences
+	 * @param frame_step frame step of the render, used to find the upcoming frames
+	 */
+	static void begin(int prefetch_frames, int frame_step);
+
+	/**
+	 * @brief wait for all pending writes, stop the I/O threads and report the throughput
+	 */
+	static void end();
+
+	/**
+	 * @brief is a batch active?
+	 */
+	static bool isActive();
+
+	/**
+	 * @brief write output asynchronously
+	 * Ownership of the job is passed to the BatchIO. The number of writes in flight is limited,
+	 * this call blocks when the limit is reached to keep memory usage bounded.
+	 */
+	static void write(BatchIOJob *job);
+
+	/**
+	 * @brief load the frames following cfra of an image sequence into the image cache
+	 * Frames which were already requested are skipped.
+	 */
+	static void prefetchImage(Image *image, const ImageUser *iuser, int cfra);
+
+	/**
+	 * @brief register a composited frame, used for the throughput report
+	 * Multiple views of the same frame are counted once.
+	 */
+	static void frameFinished(int cfra);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("COM:BatchIO")
+#endif
+};
+
+#endif /* _COM_BatchIO_h_ */
@@ -32,6 +32,7 @@ extern "C" {
 
 #include "COM_compositor.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_BatchIO.h"
 #include "COM_WorkScheduler.h"
 #include "clew.h"
 #include "COM_MovieDistortionOperation.h"
@@ -108,13 +109,28 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	system->execute();
 	delete system;
 
+	if (rendering) {
+		BatchIO::frameFinished(rd->cfra);
+	}
+
 	BLI_mutex_unlock(&s_compositorMutex);
 }
 
+void COM_batch_begin(int prefetch_frames, int frame_step)
+{
+	BatchIO::begin(prefetch_frames, frame_step);
+}
+
+void COM_batch_end()
+{
+	BatchIO::end();
+}
+
 void COM_deinitialize()
 {
 	if (is_compositorMutex_init) {
 		BLI_mutex_lock(&s_compositorMutex);
+		BatchIO::end();
 		WorkScheduler::deinitialize();
 		is_compositorMutex_init = false;
 		BLI_mutex_unlock(&s_compositorMutex);
@@ -21,6 +21,7 @@
  */
 
 #include "COM_ImageOperation.h"
+#include "COM_BatchIO.h"
 
 #include "BLI_listbase.h"
 #include "DNA_image_types.h"
@@ -98,6 +99,14 @@ void BaseImageOperation::initExecution()
 		this->m_imageheight = stackbuf->y;
 		this->m_numberOfChannels = stackbuf->channels;
 	}
+
+	/* Multilayer sequences keep a single render result per image which is replaced
+	 * on every frame load, those can't be loaded ahead of time. */
+	if (this->m_image && !BKE_image_is_multilayer(this->m_image)) {
+		ImageUser iuser = *this->m_imageUser;
+		iuser.multi_index = BKE_scene_multiview_view_id_get(this->m_rd, this->m_viewName);
+		BatchIO::prefetchImage(this->m_image, &iuser, this->m_framenumber);
+	}
 }
 
 void BaseImageOperation::deinitExecution()
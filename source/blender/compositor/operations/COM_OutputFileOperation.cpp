@@ -22,6 +22,7 @@
  */
 
 #include "COM_OutputFileOperation.h"
+#include "COM_BatchIO.h"
 #include <string.h>
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
@@ -40,6 +41,67 @@ extern "C" {
 #  include "IMB_imbuf_types.h"
 }
 
+/* Saves a single-layer image, owns the image buffer. */
+class OutputImBufWriteJob : public BatchIOJob {
+private:
+	ImBuf *m_ibuf;
+	ImageFormatData m_format;
+	char m_filename[FILE_MAX];
+public:
+	OutputImBufWriteJob(ImBuf *ibuf, const ImageFormatData *format, const char *filename) {
+		this->m_ibuf = ibuf;
+		this->m_format = *format;
+		BLI_strncpy(this->m_filename, filename, sizeof(this->m_filename));
+	}
+
+	void execute() {
+		if (0 == BKE_imbuf_write(this->m_ibuf, this->m_filename, &this->m_format))
+			printf("Cannot save Node File Output to %s\n", this->m_filename);
+		else
+			printf("Saved: %s\n", this->m_filename);
+
+		IMB_freeImBuf(this->m_ibuf);
+	}
+};
+
+/* Saves a multilayer OpenEXR file, owns the handle and the channel buffers. */
+class OutputExrWriteJob : public BatchIOJob {
+private:
+	void *m_exrhandle;
+	std::vector<float *> m_buffers;
+	char m_filename[FILE_MAX];
+	unsigned int m_width;
+	unsigned int m_height;
+	char m_exr_codec;
+public:
+	OutputExrWriteJob(void *exrhandle, const std::vector<float *> &buffers, const char *filename,
+	                  unsigned int width, unsigned int height, char exr_codec) {
+		this->m_exrhandle = exrhandle;
+		this->m_buffers = buffers;
+		BLI_strncpy(this->m_filename, filename, sizeof(this->m_filename));
+		this->m_width = width;
+		this->m_height = height;
+		this->m_exr_codec = exr_codec;
+	}
+
+	void execute() {
+		/* when the filename has no permissions, this can fail */
+		if (IMB_exr_begin_write(this->m_exrhandle, this->m_filename, this->m_width, this->m_height, this->m_exr_codec, NULL)) {
+			IMB_exr_write_channels(this->m_exrhandle);
+		}
+		else {
+			/* TODO, get the error from openexr's exception */
+			/* XXX nice way to do report? */
+			printf("Error Writing Render Result, see console\n");
+		}
+
+		IMB_exr_close(this->m_exrhandle);
+		for (unsigned int i = 0; i < this->m_buffers.size(); ++i) {
+			MEM_freeN(this->m_buffers[i]);
+		}
+	}
+};
+
 void add_exr_channels(void *exrhandle, const char *layerName, const DataType datatype,
                       const char *viewName, const size_t width, bool use_half_float, float *buf)
 {
@@ -203,12 +265,8 @@ void OutputSingleLayerOperation::deinitExecution()
 		        filename, this->m_path, bmain->name, this->m_rd->cfra, this->m_format,
 		        (this->m_rd->scemode & R_EXTENSION) != 0, true, suffix);
 
-		if (0 == BKE_imbuf_write(ibuf, filename, this->m_format))
-			printf("Cannot save Node File Output to %s\n", filename);
-		else
-			printf("Saved: %s\n", filename);
-		
-		IMB_freeImBuf(ibuf);
+		/* written asynchronously when rendering a frame range */
+		BatchIO::write(new OutputImBufWriteJob(ibuf, this->m_format, filename));
 	}
 	this->m_outputBuffer = NULL;
 	this->m_imageInput = NULL;
@@ -290,26 +348,19 @@ void OutputOpenExrMultiLayerOperation::deinitExecution()
 			add_exr_channels(exrhandle, this->m_layers[i].name, this->m_layers[i].datatype, "", width,
 			                 this->m_exr_half_float, this->m_layers[i].outputBuffer);
 		}
-		
-		/* when the filename has no permissions, this can fail */
-		if (IMB_exr_begin_write(exrhandle, filename, width, height, this->m_exr_codec, NULL)) {
-			IMB_exr_write_channels(exrhandle);
-		}
-		else {
-			/* TODO, get the error from openexr's exception */
-			/* XXX nice way to do report? */
-			printf("Error Writing Render Result, see console\n");
-		}
-		
-		IMB_exr_close(exrhandle);
+
+		/* the write job takes ownership of the channel buffers */
+		std::vector<float *> buffers;
 		for (unsigned int i = 0; i < this->m_layers.size(); ++i) {
 			if (this->m_layers[i].outputBuffer) {
-				MEM_freeN(this->m_layers[i].outputBuffer);
+				buffers.push_back(this->m_layers[i].outputBuffer);
 				this->m_layers[i].outputBuffer = NULL;
 			}
 			
 			this->m_layers[i].imageInput = NULL;
 		}
+
+		BatchIO::write(new OutputExrWriteJob(exrhandle, buffers, filename, width, height, this->m_exr_codec));
 	}
 }
 
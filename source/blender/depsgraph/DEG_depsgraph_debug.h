@@ -72,6 +72,12 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* Timing of operations of the last evaluation in Chrome's trace format.
+ * Only available when evaluated with --debug-depsgraph-time.
+ */
+void DEG_debug_eval_trace_chrome(const struct Depsgraph *graph,
+                                 FILE *stream);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
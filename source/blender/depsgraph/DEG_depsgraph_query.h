@@ -42,6 +42,7 @@ struct BLI_Iterator;
 struct Depsgraph;
 struct DupliObject;
 struct ListBase;
+struct ModifierResultCache;
 struct Scene;
 struct ViewLayer;
 
@@ -63,6 +64,9 @@ eEvaluationMode DEG_get_mode(const Depsgraph *graph);
 /* Get time that depsgraph is being evaluated or was last evaluated at. */
 float DEG_get_ctime(const Depsgraph *graph);
 
+/* Get cache of modifier results, shared by all objects of the depsgraph. */
+struct ModifierResultCache *DEG_get_modifier_result_cache(const Depsgraph *graph);
+
 /* ********************* DEG evaluated data ******************* */
 
 /* Check if given ID type was tagged for update. */
@@ -362,6 +362,41 @@ void DepsgraphNodeBuilder::begin_build() {
 	BLI_gset_clear(graph_->entry_tags, NULL);
 }
 
+void DepsgraphNodeBuilder::begin_build_partial(
+        Scene *scene,
+        ViewLayer *view_layer,
+        const vector<IDDepsNode *>& rebuild_id_nodes)
+{
+	scene_ = scene;
+	view_layer_ = view_layer;
+	view_layer_index_ = BLI_findindex(&scene->view_layers, view_layer);
+	BLI_assert(view_layer_index_ != -1);
+	/* Everything which is in the graph is considered built, except of the
+	 * IDs which are to be rebuilt.
+	 */
+	foreach (IDDepsNode *id_node, graph_->id_nodes) {
+		built_map_.tagBuild(id_node->id_orig);
+	}
+	foreach (IDDepsNode *id_node, rebuild_id_nodes) {
+		BLI_gset_remove(built_map_.set, id_node->id_orig, NULL);
+	}
+	if (DEG_depsgraph_use_copy_on_write()) {
+		/* Re-use copy-on-write versions of the rebuilt IDs. */
+		cow_id_hash_ = BLI_ghash_ptr_new("Depsgraph id hash");
+		foreach (IDDepsNode *id_node, rebuild_id_nodes) {
+			if (deg_copy_on_write_is_expanded(id_node->id_cow)) {
+				if (id_node->id_orig == id_node->id_cow) {
+					continue;
+				}
+				BLI_ghash_insert(cow_id_hash_,
+				                 id_node->id_orig,
+				                 id_node->id_cow);
+				id_node->id_cow = NULL;
+			}
+		}
+	}
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
 	foreach (const SavedEntryTag& entry_tag, saved_entry_tags_) {
@@ -103,6 +103,13 @@ struct DepsgraphNodeBuilder {
 	void begin_build();
 	void end_build();
 
+	/* Partial rebuild: nodes of the given IDs are about to be removed from the
+	 * graph and built again, nodes of all other IDs are kept.
+	 */
+	void begin_build_partial(Scene *scene,
+	                         ViewLayer *view_layer,
+	                         const vector<IDDepsNode *>& rebuild_id_nodes);
+
 	IDDepsNode *add_id_node(ID *id);
 	IDDepsNode *find_id_node(ID *id);
 	TimeSourceDepsNode *add_time_source();
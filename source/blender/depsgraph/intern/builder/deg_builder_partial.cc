@@ -0,0 +1,555 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2018 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): None Yet
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/depsgraph/intern/builder/deg_builder_partial.cc
+ *  \ingroup depsgraph
+ *
+ * Partial rebuild of the graph, used when relations of only a few objects
+ * changed (modifiers or constraints were added, removed or re-targeted).
+ *
+ * Nodes of the changed objects are removed and built again, with all their
+ * relations. Relations are built by the ID which uses the other's data, so
+ * relations from other IDs to the rebuilt object (parent, constraint and
+ * modifier targets, driver variables) are built again by the object itself,
+ * relations which are no longer used are gone. Relations from the rebuilt
+ * object to other IDs are built by those IDs, which are not rebuilt, so they
+ * are saved by operation key and restored once the nodes are rebuilt.
+ *
+ * Objects whose nodes are built by the scene (rigid body) are not handled,
+ * the graph is fully rebuilt then.
+ */
+
+#include "intern/builder/deg_builder_partial.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "MEM_guardedalloc.h"
+
+#include "PIL_time.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+
+extern "C" {
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_global.h"
+} /* extern "C" */
+
+#include "DEG_depsgraph.h"
+
+#include "intern/builder/deg_builder_cycle.h"
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/eval/deg_eval_copy_on_write.h"
+#include "intern/nodes/deg_node.h"
+#include "intern/nodes/deg_node_component.h"
+#include "intern/nodes/deg_node_id.h"
+#include "intern/nodes/deg_node_operation.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_intern.h"
+#include "intern/depsgraph_types.h"
+
+#include "util/deg_util_foreach.h"
+
+namespace DEG {
+
+namespace {
+
+/* Components without a name are named after their type, look up the name
+ * they are stored by in the ID node.
+ */
+const char *component_key_name(const ComponentDepsNode *comp_node)
+{
+	GHashIterator gh_iter;
+	GHASH_ITER (gh_iter, comp_node->owner->components) {
+		if (BLI_ghashIterator_getValue(&gh_iter) == comp_node) {
+			const IDDepsNode::ComponentIDKey *key =
+			        (const IDDepsNode::ComponentIDKey *)BLI_ghashIterator_getKey(&gh_iter);
+			return key->name;
+		}
+	}
+	BLI_assert(!"Component is not owned by its ID node");
+	return "";
+}
+
+/* Operation of a rebuilt ID, stored by its key so it can be found after the
+ * nodes are rebuilt.
+ */
+struct SavedOperationKey {
+	SavedOperationKey(const OperationDepsNode *op_node)
+	    : id(op_node->owner->owner->id_orig),
+	      component_type(op_node->owner->type),
+	      component_name(component_key_name(op_node->owner)),
+	      opcode(op_node->opcode),
+	      name(op_node->name),
+	      name_tag(op_node->name_tag)
+	{
+	}
+
+	OperationDepsNode *find(const Depsgraph *graph) const
+	{
+		IDDepsNode *id_node = graph->find_id_node(id);
+		if (id_node == NULL) {
+			return NULL;
+		}
+		ComponentDepsNode *comp_node =
+		        id_node->find_component(component_type, component_name.c_str());
+		if (comp_node == NULL) {
+			return NULL;
+		}
+		return comp_node->find_operation(opcode, name.c_str(), name_tag);
+	}
+
+	ID *id;
+	eDepsNode_Type component_type;
+	string component_name;
+	eDepsOperation_Code opcode;
+	string name;
+	int name_tag;
+};
+
+/* Relation from an operation of a rebuilt ID to a kept one. */
+struct SavedRelation {
+	SavedRelation(const OperationDepsNode *op_node,
+	              OperationDepsNode *other,
+	              const char *name)
+	    : key(op_node),
+	      other(other),
+	      name(name)
+	{
+	}
+
+	SavedOperationKey key;
+	OperationDepsNode *other;
+	const char *name;
+};
+
+/* Customdata which other IDs requested from an operation of a rebuilt ID. */
+struct SavedCustomDataMask {
+	SavedCustomDataMask(const OperationDepsNode *op_node)
+	    : key(op_node),
+	      customdata_mask(op_node->customdata_mask)
+	{
+	}
+
+	SavedOperationKey key;
+	uint64_t customdata_mask;
+};
+
+struct RebuiltIDNode {
+	IDDepsNode *id_node;
+	ID *id;
+	/* Index in graph->id_nodes, the order is kept on rebuild. */
+	int index;
+	eDepsNode_LinkedState_Type linked_state;
+	int eval_flags;
+};
+
+struct PartialBuildState {
+	vector<RebuiltIDNode> rebuilt;
+	vector<SavedRelation> relations;
+	vector<SavedCustomDataMask> customdata_masks;
+};
+
+/* Find which ID nodes are to be rebuilt, returns false if the change can not
+ * be handled by a partial rebuild.
+ */
+bool collect_rebuilt_id_nodes(Depsgraph *graph, PartialBuildState *state)
+{
+	GSET_FOREACH_BEGIN(ID *, id, graph->relations_update_ids)
+	{
+		IDDepsNode *id_node = graph->find_id_node(id);
+		if (id_node == NULL) {
+			/* Nothing in this graph uses the ID. */
+			continue;
+		}
+		if (GS(id->name) != ID_OB) {
+			return false;
+		}
+		/* Proxies build nodes and relations for both objects, objects from
+		 * set scenes are built for another view layer.
+		 */
+		Object *object = (Object *)id;
+		if (object->proxy != NULL || object->proxy_from != NULL ||
+		    object->rigidbody_object != NULL ||
+		    object->rigidbody_constraint != NULL ||
+		    id_node->linked_state == DEG_ID_LINKED_VIA_SET)
+		{
+			return false;
+		}
+		RebuiltIDNode rebuilt;
+		rebuilt.id_node = id_node;
+		rebuilt.id = id;
+		rebuilt.index = -1;
+		rebuilt.linked_state = id_node->linked_state;
+		rebuilt.eval_flags = id_node->eval_flags;
+		state->rebuilt.push_back(rebuilt);
+	}
+	GSET_FOREACH_END();
+	return true;
+}
+
+bool is_rebuilt_node(const PartialBuildState *state, const DepsNode *node)
+{
+	if (node->type != DEG_NODE_TYPE_OPERATION) {
+		return false;
+	}
+	const IDDepsNode *id_node = ((OperationDepsNode *)node)->owner->owner;
+	foreach (const RebuiltIDNode& rebuilt, state->rebuilt) {
+		if (rebuilt.id_node == id_node) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Save relations which other IDs built to the rebuilt operations, and data
+ * other IDs requested from them. Incoming relations are built again by the
+ * rebuilt object, only if it still uses the other ID.
+ *
+ * Data is requested together with a relation to the requesting operation, the
+ * mask is only saved when a kept ID uses the operation. Masks requested by the
+ * rebuilt IDs themselves are computed again when their relations are built.
+ */
+void save_external_state(PartialBuildState *state)
+{
+	foreach (const RebuiltIDNode& rebuilt, state->rebuilt) {
+		GHASH_FOREACH_BEGIN(ComponentDepsNode *, comp_node, rebuilt.id_node->components)
+		{
+			foreach (OperationDepsNode *op_node, comp_node->operations) {
+				bool has_kept_user = false;
+				foreach (DepsRelation *rel, op_node->outlinks) {
+					if (rel->to->type == DEG_NODE_TYPE_OPERATION &&
+					    !is_rebuilt_node(state, rel->to))
+					{
+						state->relations.push_back(SavedRelation(
+						        op_node, (OperationDepsNode *)rel->to, rel->name));
+						has_kept_user = true;
+					}
+				}
+				if (has_kept_user && op_node->customdata_mask != 0) {
+					state->customdata_masks.push_back(SavedCustomDataMask(op_node));
+				}
+			}
+		}
+		GHASH_FOREACH_END();
+	}
+}
+
+/* Free nodes of the rebuilt IDs together with all their relations. Their
+ * slots in graph->id_nodes are kept empty until the new nodes are built.
+ */
+void remove_rebuilt_id_nodes(Depsgraph *graph, PartialBuildState *state)
+{
+	GSet *removed_operations = BLI_gset_ptr_new(__func__);
+	for (int i = 0; i < graph->id_nodes.size(); ++i) {
+		foreach (RebuiltIDNode& rebuilt, state->rebuilt) {
+			if (rebuilt.id_node == graph->id_nodes[i]) {
+				rebuilt.index = i;
+				graph->id_nodes[i] = NULL;
+				break;
+			}
+		}
+	}
+	foreach (RebuiltIDNode& rebuilt, state->rebuilt) {
+		IDDepsNode *id_node = rebuilt.id_node;
+		GHASH_FOREACH_BEGIN(ComponentDepsNode *, comp_node, id_node->components)
+		{
+			foreach (OperationDepsNode *op_node, comp_node->operations) {
+				/* Unlinking modifies the vectors, iterate over copies. */
+				DepsNode::Relations inlinks = op_node->inlinks;
+				DepsNode::Relations outlinks = op_node->outlinks;
+				foreach (DepsRelation *rel, inlinks) {
+					rel->unlink();
+					OBJECT_GUARDED_DELETE(rel, DepsRelation);
+				}
+				foreach (DepsRelation *rel, outlinks) {
+					rel->unlink();
+					OBJECT_GUARDED_DELETE(rel, DepsRelation);
+				}
+				BLI_gset_remove(graph->entry_tags, op_node, NULL);
+				BLI_gset_add(removed_operations, op_node);
+			}
+		}
+		GHASH_FOREACH_END();
+		BLI_ghash_remove(graph->id_hash, rebuilt.id, NULL, NULL);
+		OBJECT_GUARDED_DELETE(id_node, IDDepsNode);
+		rebuilt.id_node = NULL;
+	}
+	/* Remove dangling pointers from the flat list of operations. */
+	size_t num_kept = 0;
+	for (size_t i = 0; i < graph->operations.size(); ++i) {
+		OperationDepsNode *op_node = graph->operations[i];
+		if (!BLI_gset_haskey(removed_operations, op_node)) {
+			graph->operations[num_kept++] = op_node;
+		}
+	}
+	graph->operations.resize(num_kept);
+	BLI_gset_free(removed_operations, NULL);
+}
+
+/* Put rebuilt ID nodes to the slots of old ones. Returns nodes which were
+ * created by the builder, these are rebuilt nodes and nodes of IDs which were
+ * not in the graph before.
+ */
+void place_rebuilt_id_nodes(Depsgraph *graph,
+                            PartialBuildState *state,
+                            size_t num_id_nodes,
+                            vector<IDDepsNode *> *r_new_id_nodes)
+{
+	r_new_id_nodes->assign(graph->id_nodes.begin() + num_id_nodes,
+	                       graph->id_nodes.end());
+	graph->id_nodes.resize(num_id_nodes);
+	foreach (IDDepsNode *id_node, *r_new_id_nodes) {
+		bool found_slot = false;
+		foreach (RebuiltIDNode& rebuilt, state->rebuilt) {
+			if (rebuilt.id == id_node->id_orig) {
+				rebuilt.id_node = id_node;
+				graph->id_nodes[rebuilt.index] = id_node;
+				found_slot = true;
+				break;
+			}
+		}
+		if (!found_slot) {
+			graph->id_nodes.push_back(id_node);
+		}
+	}
+	graph->id_nodes.erase(std::remove(graph->id_nodes.begin(),
+	                                  graph->id_nodes.end(),
+	                                  (IDDepsNode *)NULL),
+	                      graph->id_nodes.end());
+}
+
+void restore_external_state(Depsgraph *graph, PartialBuildState *state)
+{
+	foreach (const RebuiltIDNode& rebuilt, state->rebuilt) {
+		if (rebuilt.id_node != NULL) {
+			rebuilt.id_node->eval_flags |= rebuilt.eval_flags;
+		}
+	}
+	foreach (const SavedCustomDataMask& saved_mask, state->customdata_masks) {
+		OperationDepsNode *op_node = saved_mask.key.find(graph);
+		if (op_node != NULL) {
+			op_node->customdata_mask |= saved_mask.customdata_mask;
+		}
+	}
+}
+
+void restore_external_relations(Depsgraph *graph, PartialBuildState *state)
+{
+	foreach (const SavedRelation& saved_rel, state->relations) {
+		OperationDepsNode *op_node = saved_rel.key.find(graph);
+		if (op_node == NULL) {
+			/* Operation does not exist anymore. */
+			continue;
+		}
+		graph->add_new_relation(op_node, saved_rel.other, saved_rel.name);
+	}
+}
+
+BLI_INLINE bool relation_names_equal(const DepsRelation *a, const DepsRelation *b)
+{
+	return (a->name == b->name) ||
+	       (a->name != NULL && b->name != NULL && STREQ(a->name, b->name));
+}
+
+/* Relations are the same when they link the same operations by the same name. */
+unsigned int relation_hash_key(const void *rel_v)
+{
+	const DepsRelation *rel = reinterpret_cast<const DepsRelation *>(rel_v);
+	unsigned int hash = BLI_ghashutil_combine_hash(BLI_ghashutil_ptrhash(rel->from),
+	                                               BLI_ghashutil_ptrhash(rel->to));
+	if (rel->name != NULL) {
+		hash = BLI_ghashutil_combine_hash(hash, BLI_ghashutil_strhash_p(rel->name));
+	}
+	return hash;
+}
+
+bool relation_hash_key_cmp(const void *a_v, const void *b_v)
+{
+	const DepsRelation *a = reinterpret_cast<const DepsRelation *>(a_v);
+	const DepsRelation *b = reinterpret_cast<const DepsRelation *>(b_v);
+	return !(a->from == b->from && a->to == b->to && relation_names_equal(a, b));
+}
+
+/* Relations restored from the old nodes might have been built again, the
+ * first relation added to \a relations is kept.
+ */
+void remove_duplicate_relations(OperationDepsNode *op_node, GSet *relations)
+{
+	/* Unlinking modifies the vectors, iterate over a copy. Relations of the
+	 * node to itself are in both vectors, take them once.
+	 */
+	DepsNode::Relations links = op_node->outlinks;
+	foreach (DepsRelation *rel, op_node->inlinks) {
+		if (rel->from != op_node) {
+			links.push_back(rel);
+		}
+	}
+	foreach (DepsRelation *rel, links) {
+		void **r_key;
+		if (!BLI_gset_ensure_p_ex(relations, rel, &r_key)) {
+			*r_key = rel;
+		}
+		else if (*r_key != rel) {
+			rel->unlink();
+			OBJECT_GUARDED_DELETE(rel, DepsRelation);
+		}
+	}
+}
+
+int object_base_index(ViewLayer *view_layer, Object *object, Base **r_base)
+{
+	int base_index = 0;
+	LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+		if (base->object == object) {
+			*r_base = base;
+			return base_index;
+		}
+		++base_index;
+	}
+	*r_base = NULL;
+	return -1;
+}
+
+}  // namespace
+
+bool deg_graph_build_partial(Main *bmain,
+                             Depsgraph *graph,
+                             Scene *scene,
+                             ViewLayer *view_layer)
+{
+	double start_time = 0.0;
+	if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+		start_time = PIL_check_seconds_timer();
+	}
+	if (graph->id_nodes.size() == 0) {
+		return false;
+	}
+	PartialBuildState state;
+	if (!collect_rebuilt_id_nodes(graph, &state)) {
+		return false;
+	}
+	BLI_gset_clear(graph->relations_update_ids, NULL);
+	if (state.rebuilt.size() == 0) {
+		return true;
+	}
+	save_external_state(&state);
+
+	/* 1) Remove old nodes and build new ones for the rebuilt objects. */
+	vector<IDDepsNode *> rebuilt_id_nodes;
+	foreach (const RebuiltIDNode& rebuilt, state.rebuilt) {
+		rebuilt_id_nodes.push_back(rebuilt.id_node);
+	}
+	DepsgraphNodeBuilder node_builder(bmain, graph);
+	node_builder.begin_build_partial(scene, view_layer, rebuilt_id_nodes);
+	remove_rebuilt_id_nodes(graph, &state);
+	const size_t num_id_nodes = graph->id_nodes.size();
+	foreach (const RebuiltIDNode& rebuilt, state.rebuilt) {
+		Object *object = (Object *)rebuilt.id;
+		Base *base;
+		const int base_index = object_base_index(view_layer, object, &base);
+		node_builder.build_object(base_index, object, rebuilt.linked_state);
+	}
+	vector<IDDepsNode *> new_id_nodes;
+	place_rebuilt_id_nodes(graph, &state, num_id_nodes, &new_id_nodes);
+	restore_external_state(graph, &state);
+
+	/* 2) Relations of the new nodes. */
+	DepsgraphRelationBuilder relation_builder(bmain, graph);
+	relation_builder.begin_build_partial(scene, new_id_nodes);
+	foreach (const RebuiltIDNode& rebuilt, state.rebuilt) {
+		Object *object = (Object *)rebuilt.id;
+		Base *base;
+		object_base_index(view_layer, object, &base);
+		relation_builder.build_object(base, object);
+	}
+	restore_external_relations(graph, &state);
+	if (DEG_depsgraph_use_copy_on_write()) {
+		foreach (IDDepsNode *id_node, new_id_nodes) {
+			relation_builder.build_copy_on_write_relations(id_node);
+		}
+	}
+	GSet *relations = BLI_gset_new(relation_hash_key, relation_hash_key_cmp, __func__);
+	foreach (IDDepsNode *id_node, new_id_nodes) {
+		GHASH_FOREACH_BEGIN(ComponentDepsNode *, comp_node, id_node->components)
+		{
+			GHASH_FOREACH_BEGIN(OperationDepsNode *, op_node, comp_node->operations_map)
+			{
+				remove_duplicate_relations(op_node, relations);
+			}
+			GHASH_FOREACH_END();
+		}
+		GHASH_FOREACH_END();
+	}
+	BLI_gset_free(relations, NULL);
+	deg_graph_detect_cycles(graph);
+
+	/* 3) Finalize new nodes, components which were kept are finalized
+	 * already.
+	 */
+	foreach (IDDepsNode *id_node, graph->id_nodes) {
+		id_node->finalize_build(graph);
+	}
+	/* Masks of the rebuilt objects are computed from scratch, kept objects
+	 * only gain data requested by the rebuilt relations.
+	 */
+	foreach (IDDepsNode *id_node, new_id_nodes) {
+		ID *id = id_node->id_orig;
+		if (GS(id->name) == ID_OB) {
+			((Object *)id)->customdata_mask = 0;
+		}
+	}
+	foreach (OperationDepsNode *op_node, graph->operations) {
+		ID *id = op_node->owner->owner->id_orig;
+		if (GS(id->name) == ID_OB) {
+			Object *object = (Object *)id;
+			object->customdata_mask |= op_node->customdata_mask;
+		}
+	}
+	const bool use_copy_on_write = DEG_depsgraph_use_copy_on_write();
+	foreach (IDDepsNode *id_node, new_id_nodes) {
+		ID *id = id_node->id_orig;
+		if ((id->recalc & ID_RECALC_ALL)) {
+			id_node->tag_update(graph);
+		}
+		if (use_copy_on_write) {
+			DEG_id_tag_update_ex(bmain, id, DEG_TAG_COPY_ON_WRITE);
+		}
+	}
+
+	if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+		printf("Depsgraph partially rebuilt %d IDs in %f seconds.\n",
+		       (int)new_id_nodes.size(),
+		       PIL_check_seconds_timer() - start_time);
+	}
+	return true;
+}
+
+}  // namespace DEG
@@ -390,6 +390,19 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_build_partial(
+        Scene *scene,
+        const vector<IDDepsNode *>& rebuild_id_nodes)
+{
+	scene_ = scene;
+	foreach (IDDepsNode *id_node, graph_->id_nodes) {
+		built_map_.tagBuild(id_node->id_orig);
+	}
+	foreach (IDDepsNode *id_node, rebuild_id_nodes) {
+		BLI_gset_remove(built_map_.set, id_node->id_orig, NULL);
+	}
+}
+
 void DepsgraphRelationBuilder::build_group(Object *object, Group *group)
 {
 	const bool group_done = built_map_.checkIsBuiltAndTag(group);
@@ -176,6 +176,12 @@ struct DepsgraphRelationBuilder
 
 	void begin_build();
 
+	/* Partial rebuild: only relations of the given IDs are built, relations
+	 * of all other IDs are kept.
+	 */
+	void begin_build_partial(Scene *scene,
+	                         const vector<IDDepsNode *>& rebuild_id_nodes);
+
 	template <typename KeyFrom, typename KeyTo>
 	DepsRelation *add_relation(const KeyFrom& key_from,
 	                           const KeyTo& key_to,
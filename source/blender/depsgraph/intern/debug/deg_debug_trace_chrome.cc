@@ -0,0 +1,154 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2018 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): None Yet
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/depsgraph/intern/debug/deg_debug_trace_chrome.cc
+ *  \ingroup depsgraph
+ *
+ * Export timing of the last evaluation in the Trace Event Format, which can
+ * be loaded in chrome://tracing.
+ */
+
+#include "DEG_depsgraph_debug.h"
+
+#include <cstdarg>
+#include <set>
+
+#include "BLI_compiler_attrs.h"
+
+#include "intern/depsgraph.h"
+#include "intern/eval/deg_eval_stats.h"
+#include "intern/nodes/deg_node_component.h"
+#include "intern/nodes/deg_node_id.h"
+#include "intern/nodes/deg_node_operation.h"
+
+#include "util/deg_util_foreach.h"
+
+extern "C" {
+#include "DNA_ID.h"
+} /* extern "C" */
+
+#define NL "\n"
+
+namespace DEG {
+namespace {
+
+struct DebugContext {
+	FILE *file;
+	const Depsgraph *graph;
+};
+
+static void deg_debug_fprintf(const DebugContext &ctx,
+                              const char *fmt,
+                              ...) ATTR_PRINTF_FORMAT(2, 3);
+static void deg_debug_fprintf(const DebugContext &ctx, const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(ctx.file, fmt, args);
+	va_end(args);
+}
+
+static string json_escape(const string &str)
+{
+	string result;
+	result.reserve(str.size());
+	for (size_t i = 0; i < str.size(); ++i) {
+		const char c = str[i];
+		switch (c) {
+			case '"':  result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\t': result += "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20) {
+					char buffer[8];
+					snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+					result += buffer;
+				}
+				else {
+					result += c;
+				}
+				break;
+		}
+	}
+	return result;
+}
+
+/* Times in the trace are in microseconds since the evaluation started. */
+BLI_INLINE double trace_time(const DebugContext &ctx, double time)
+{
+	return (time - ctx.graph->eval_start_time) * 1e6;
+}
+
+void deg_debug_trace_chrome(const DebugContext &ctx)
+{
+	vector<OperationDepsNode *> path;
+	deg_eval_stats_critical_path(ctx.graph, &path);
+	std::set<const OperationDepsNode *> critical(path.begin(), path.end());
+
+	bool first = true;
+	deg_debug_fprintf(ctx, "{\"traceEvents\":[" NL);
+	foreach (const OperationDepsNode *op_node, ctx.graph->operations) {
+		/* Not evaluated or NOOP, nothing to show. */
+		if (op_node->trace.thread_id == -1 || op_node->is_noop()) {
+			continue;
+		}
+		const ComponentDepsNode *comp_node = op_node->owner;
+		const IDDepsNode *id_node = comp_node->owner;
+		deg_debug_fprintf(ctx,
+		                  "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+		                  "\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+		                  "\"args\":{\"id\":\"%s\",\"wait\":%.3f,\"critical\":%s}}",
+		                  first ? "" : "," NL,
+		                  json_escape(op_node->identifier()).c_str(),
+		                  json_escape(comp_node->identifier()).c_str(),
+		                  op_node->trace.thread_id,
+		                  trace_time(ctx, op_node->trace.start_time),
+		                  (op_node->trace.end_time - op_node->trace.start_time) * 1e6,
+		                  json_escape(id_node->id_orig->name + 2).c_str(),
+		                  (op_node->trace.start_time - op_node->trace.ready_time) * 1e6,
+		                  critical.count(op_node) ? "true" : "false");
+		first = false;
+	}
+	deg_debug_fprintf(ctx, NL "]," NL);
+	deg_debug_fprintf(ctx,
+	                  "\"otherData\":{\"threads\":%d,\"wall_time\":%.3f}}" NL,
+	                  ctx.graph->eval_num_threads,
+	                  trace_time(ctx, ctx.graph->eval_end_time));
+}
+
+}  // namespace
+}  // namespace DEG
+
+void DEG_debug_eval_trace_chrome(const Depsgraph *depsgraph, FILE *f)
+{
+	if (depsgraph == NULL) {
+		return;
+	}
+	DEG::DebugContext ctx;
+	ctx.file = f;
+	ctx.graph = (DEG::Depsgraph *)depsgraph;
+	DEG::deg_debug_trace_chrome(ctx);
+}
@@ -50,6 +50,7 @@ extern "C" {
 
 #include "RNA_access.h"
 
+#include "BKE_modifier_cache.h"
 #include "BKE_scene.h"
 }
 
@@ -104,11 +105,17 @@ Depsgraph::Depsgraph(Scene *scene,
     view_layer(view_layer),
     mode(mode),
     ctime(BKE_scene_frame_get(scene)),
-    scene_cow(NULL)
+    scene_cow(NULL),
+    priority_update_countdown(0),
+    eval_start_time(0.0),
+    eval_end_time(0.0),
+    eval_num_threads(0)
 {
 	BLI_spin_init(&lock);
 	id_hash = BLI_ghash_ptr_new("Depsgraph id hash");
 	entry_tags = BLI_gset_ptr_new("Depsgraph entry_tags");
+	relations_update_ids = BLI_gset_ptr_new("Depsgraph relations_update_ids");
+	modifier_result_cache = BKE_modifier_result_cache_new();
 	debug_flags = G.debug;
 }
 
@@ -117,6 +124,8 @@ Depsgraph::~Depsgraph()
 	clear_id_nodes();
 	BLI_ghash_free(id_hash, NULL, NULL);
 	BLI_gset_free(entry_tags, NULL);
+	BLI_gset_free(relations_update_ids, NULL);
+	BKE_modifier_result_cache_free(modifier_result_cache);
 	if (time_source != NULL) {
 		OBJECT_GUARDED_DELETE(time_source, TimeSourceDepsNode);
 	}
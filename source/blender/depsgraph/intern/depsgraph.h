@@ -46,6 +46,7 @@ struct ID;
 struct GHash;
 struct Main;
 struct GSet;
+struct ModifierResultCache;
 struct PointerRNA;
 struct PropertyRNA;
 struct Scene;
@@ -174,6 +175,11 @@ struct Depsgraph {
 	/* Indicates whether relations needs to be updated. */
 	bool need_update;
 
+	/* IDs which relations needs to be updated, while relations of all other
+	 * IDs are up to date. Only used when need_update is not set.
+	 */
+	GSet *relations_update_ids;
+
 	/* Quick-Access Temp Data ............. */
 
 	/* Nodes which have been tagged as "directly modified". */
@@ -203,6 +209,23 @@ struct Depsgraph {
 	 */
 	Scene *scene_cow;
 
+	/* Results of constructive modifiers, reused when the same modifier is
+	 * evaluated again on the same input.
+	 */
+	ModifierResultCache *modifier_result_cache;
+
+	/* Number of evaluations left until operations are timed again to update
+	 * their scheduling priority, zero means the next evaluation does.
+	 */
+	int priority_update_countdown;
+
+	/* Wall clock time and number of threads of the last evaluation, only
+	 * filled in when gathering statistics.
+	 */
+	double eval_start_time;
+	double eval_end_time;
+	int eval_num_threads;
+
 	/* NITE: Corresponds to G_DEBUG_DEPSGRAPH_* flags. */
 	int debug_flags;
 	string debug_name;
@@ -59,6 +59,7 @@ extern "C" {
 #include "builder/deg_builder.h"
 #include "builder/deg_builder_cycle.h"
 #include "builder/deg_builder_nodes.h"
+#include "builder/deg_builder_partial.h"
 #include "builder/deg_builder_relations.h"
 #include "builder/deg_builder_transitive.h"
 
@@ -259,6 +260,9 @@ void DEG_graph_build_from_view_layer(Depsgraph *graph,
 
 	/* Relations are up to date. */
 	deg_graph->need_update = false;
+	BLI_gset_clear(deg_graph->relations_update_ids, NULL);
+	/* New operations have no cost estimate yet. */
+	deg_graph->priority_update_countdown = 0;
 
 	/* Store pointers to commonly used valuated datablocks. */
 	deg_graph->scene_cow = (Scene *)deg_graph->get_cow_id(&deg_graph->scene->id);
@@ -302,8 +306,15 @@ void DEG_graph_relations_update(Depsgraph *graph,
 {
 	DEG::Depsgraph *deg_graph = (DEG::Depsgraph *)graph;
 	if (!deg_graph->need_update) {
-		/* Graph is up to date, nothing to do. */
-		return;
+		if (BLI_gset_len(deg_graph->relations_update_ids) == 0) {
+			/* Graph is up to date, nothing to do. */
+			return;
+		}
+		/* Only some IDs changed, try to only rebuild those. */
+		if (DEG::deg_graph_build_partial(bmain, deg_graph, scene, view_layer)) {
+			deg_graph->priority_update_countdown = 0;
+			return;
+		}
 	}
 	DEG_graph_build_from_view_layer(graph, bmain, scene, view_layer);
 }
@@ -325,6 +336,35 @@ void DEG_relations_tag_update(Main *bmain)
 	}
 }
 
+/* Tag relations of the given ID for update.
+ *
+ * Graphs which are not tagged for full update will only rebuild nodes and
+ * relations of this ID if possible.
+ */
+void DEG_id_relations_tag_update(Main *bmain, ID *id)
+{
+	DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n",
+	                        __func__, id->name);
+	LISTBASE_FOREACH (Scene *, scene, &bmain->scene) {
+		LISTBASE_FOREACH (ViewLayer *, view_layer, &scene->view_layers) {
+			DEG::Depsgraph *deg_graph =
+			        (DEG::Depsgraph *)BKE_scene_get_depsgraph(scene,
+			                                                  view_layer,
+			                                                  false);
+			if (deg_graph == NULL || deg_graph->need_update) {
+				continue;
+			}
+			if (deg_graph->find_id_node(id) == NULL) {
+				/* ID is not used by this graph, relations to it can only
+				 * appear from relations update of other IDs.
+				 */
+				continue;
+			}
+			BLI_gset_add(deg_graph->relations_update_ids, id);
+		}
+	}
+}
+
 void DEG_add_collision_relations(DepsNodeHandle *handle,
                                  Scene *scene,
                                  Object *object,
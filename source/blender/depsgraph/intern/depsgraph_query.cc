@@ -73,6 +73,12 @@ float DEG_get_ctime(const Depsgraph *graph)
 	return deg_graph->ctime;
 }
 
+struct ModifierResultCache *DEG_get_modifier_result_cache(const Depsgraph *graph)
+{
+	const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+	return deg_graph->modifier_result_cache;
+}
+
 
 bool DEG_id_type_tagged(Main *bmain, short id_type)
 {
@@ -32,10 +32,13 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_utildefines.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_ghash.h"
 
 #include "DNA_object_types.h"
@@ -59,6 +62,9 @@
 
 #include "util/deg_util_foreach.h"
 
+/* Number of evaluations between updates of the operation priorities. */
+#define DEG_PRIORITY_UPDATE_INTERVAL 16
+
 namespace DEG {
 
 /* ********************** */
@@ -73,6 +79,10 @@ static void schedule_children(TaskPool *pool,
 struct DepsgraphEvalState {
 	Depsgraph *graph;
 	bool do_stats;
+	/* Order ready operations by priority, only useful with multiple threads. */
+	bool use_priorities;
+	/* Time operations, to update their cost and scheduling priority. */
+	bool do_timing;
 };
 
 static void deg_task_run_func(TaskPool *pool,
@@ -85,10 +95,19 @@ static void deg_task_run_func(TaskPool *pool,
 	/* Sanity checks. */
 	BLI_assert(!node->is_noop() && "NOOP nodes should not actually be scheduled");
 	/* Perform operation. */
-	if (state->do_stats) {
+	if (state->do_timing) {
 		const double start_time = PIL_check_seconds_timer();
 		node->evaluate((::Depsgraph *)state->graph);
-		node->stats.current_time += PIL_check_seconds_timer() - start_time;
+		const double end_time = PIL_check_seconds_timer();
+		/* Smooth out the estimate, timing of a single evaluation is noisy. */
+		const float time = (float)(end_time - start_time);
+		node->cost = (node->cost != 0.0f) ? 0.5f * (node->cost + time) : time;
+		if (state->do_stats) {
+			node->stats.current_time += end_time - start_time;
+			node->trace.start_time = start_time;
+			node->trace.end_time = end_time;
+			node->trace.thread_id = thread_id;
+		}
 	}
 	else {
 		node->evaluate((::Depsgraph *)state->graph);
@@ -154,50 +173,89 @@ static void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 		node->done = 0;
 		if (do_stats) {
 			node->stats.reset_current();
+			node->trace.reset();
 		}
 	}
 }
 
-/* Schedule a node if it needs evaluation.
+/* Check whether a node which needs evaluation got all its inputs evaluated.
+ * Returns true only once per evaluation, the caller is then responsible for
+ * scheduling the node.
  *   dec_parents: Decrement pending parents count, true when child nodes are
  *                scheduled after a task has been completed.
  */
+static bool check_node_ready(OperationDepsNode *node, bool dec_parents)
+{
+	if ((node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+		return false;
+	}
+	if (dec_parents) {
+		BLI_assert(node->num_links_pending > 0);
+		atomic_sub_and_fetch_uint32(&node->num_links_pending, 1);
+	}
+	if (node->num_links_pending != 0) {
+		return false;
+	}
+	bool is_scheduled = atomic_fetch_and_or_uint8(
+	        (uint8_t *)&node->scheduled, (uint8_t)true);
+	return !is_scheduled;
+}
+
+/* Schedule a node which is ready for evaluation. */
 static void schedule_node(TaskPool *pool, Depsgraph *graph,
-                          OperationDepsNode *node, bool dec_parents,
+                          OperationDepsNode *node,
                           const int thread_id)
 {
-	if ((node->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0) {
-		if (dec_parents) {
-			BLI_assert(node->num_links_pending > 0);
-			atomic_sub_and_fetch_uint32(&node->num_links_pending, 1);
-		}
-
-		if (node->num_links_pending == 0) {
-			bool is_scheduled = atomic_fetch_and_or_uint8(
-			        (uint8_t *)&node->scheduled, (uint8_t)true);
-			if (!is_scheduled) {
-				if (node->is_noop()) {
-					/* skip NOOP node, schedule children right away */
-					schedule_children(pool, graph, node, thread_id);
-				}
-				else {
-					/* children are scheduled once this task is completed */
-					BLI_task_pool_push_from_thread(pool,
-					                               deg_task_run_func,
-					                               node,
-					                               false,
-					                               TASK_PRIORITY_HIGH,
-					                               thread_id);
-				}
-			}
+	const DepsgraphEvalState *state =
+	        (const DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+	if (state->do_stats) {
+		node->trace.ready_time = PIL_check_seconds_timer();
+		if (node->is_noop()) {
+			node->trace.start_time = node->trace.ready_time;
+			node->trace.end_time = node->trace.ready_time;
+			node->trace.thread_id = thread_id;
 		}
 	}
+	if (node->is_noop()) {
+		/* skip NOOP node, schedule children right away */
+		schedule_children(pool, graph, node, thread_id);
+	}
+	else {
+		/* children are scheduled once this task is completed */
+		BLI_task_pool_push_from_thread(pool,
+		                               deg_task_run_func,
+		                               node,
+		                               false,
+		                               TASK_PRIORITY_HIGH,
+		                               thread_id);
+	}
+}
+
+static bool operation_priority_less(const OperationDepsNode *a,
+                                    const OperationDepsNode *b)
+{
+	return a->priority < b->priority;
 }
 
 static void schedule_graph(TaskPool *pool, Depsgraph *graph)
 {
+	const DepsgraphEvalState *state =
+	        (const DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+	vector<OperationDepsNode *> ready;
 	foreach (OperationDepsNode *node, graph->operations) {
-		schedule_node(pool, graph, node, false, 0);
+		if (check_node_ready(node, false)) {
+			if (state->use_priorities) {
+				ready.push_back(node);
+			}
+			else {
+				schedule_node(pool, graph, node, 0);
+			}
+		}
+	}
+	/* The pool is suspended, tasks which were pushed last are picked first. */
+	std::sort(ready.begin(), ready.end(), operation_priority_less);
+	foreach (OperationDepsNode *node, ready) {
+		schedule_node(pool, graph, node, 0);
 	}
 }
 
@@ -206,6 +264,13 @@ static void schedule_children(TaskPool *pool,
                               OperationDepsNode *node,
                               const int thread_id)
 {
+	const DepsgraphEvalState *state =
+	        (const DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+	/* Most operations have a single child ready, only allocate when there are
+	 * several to order.
+	 */
+	OperationDepsNode *ready_first = NULL;
+	vector<OperationDepsNode *> ready;
 	foreach (DepsRelation *rel, node->outlinks) {
 		OperationDepsNode *child = (OperationDepsNode *)rel->to;
 		BLI_assert(child->type == DEG_NODE_TYPE_OPERATION);
@@ -213,11 +278,95 @@ static void schedule_children(TaskPool *pool,
 			/* Happens when having cyclic dependencies. */
 			continue;
 		}
-		schedule_node(pool,
-		              graph,
-		              child,
-		              (rel->flag & DEPSREL_FLAG_CYCLIC) == 0,
-		              thread_id);
+		if (!check_node_ready(child, (rel->flag & DEPSREL_FLAG_CYCLIC) == 0)) {
+			continue;
+		}
+		if (!state->use_priorities) {
+			schedule_node(pool, graph, child, thread_id);
+		}
+		else if (ready_first == NULL) {
+			ready_first = child;
+		}
+		else {
+			if (ready.empty()) {
+				ready.push_back(ready_first);
+			}
+			ready.push_back(child);
+		}
+	}
+	if (ready.empty()) {
+		if (ready_first != NULL) {
+			schedule_node(pool, graph, ready_first, thread_id);
+		}
+		return;
+	}
+	/* First pushed task is picked up next by the current thread, so the most
+	 * expensive chain continues here. Of the other tasks the ones pushed last
+	 * are picked first by other threads.
+	 */
+	std::sort(ready.begin(), ready.end(), operation_priority_less);
+	std::rotate(ready.begin(), ready.end() - 1, ready.end());
+	foreach (OperationDepsNode *child, ready) {
+		schedule_node(pool, graph, child, thread_id);
+	}
+}
+
+/* Propagate estimated cost of evaluated operations upstream, so every
+ * operation knows the cost of the most expensive chain of operations which
+ * depends on it. Relations do not change between evaluations, so this is used
+ * to order operations of the next evaluation.
+ */
+static void update_operation_priorities(Depsgraph *graph)
+{
+	/* Operations are visited once all their evaluated children are, the
+	 * counter of pending parents is no longer needed after evaluation, so it
+	 * is used to count children which are not visited yet.
+	 */
+	vector<OperationDepsNode *> queue;
+	foreach (OperationDepsNode *node, graph->operations) {
+		if ((node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+			continue;
+		}
+		node->num_links_pending = 0;
+		foreach (DepsRelation *rel, node->outlinks) {
+			OperationDepsNode *child = (OperationDepsNode *)rel->to;
+			if ((rel->flag & DEPSREL_FLAG_CYCLIC) == 0 &&
+			    (child->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0)
+			{
+				++node->num_links_pending;
+			}
+		}
+		if (node->num_links_pending == 0) {
+			queue.push_back(node);
+		}
+	}
+	while (!queue.empty()) {
+		OperationDepsNode *node = queue.back();
+		queue.pop_back();
+		/* Children which were not evaluated keep the priority of their
+		 * previous evaluation.
+		 */
+		float max_child_priority = 0.0f;
+		foreach (DepsRelation *rel, node->outlinks) {
+			if ((rel->flag & DEPSREL_FLAG_CYCLIC) == 0) {
+				OperationDepsNode *child = (OperationDepsNode *)rel->to;
+				max_child_priority = max(max_child_priority, child->priority);
+			}
+		}
+		node->priority = node->cost + max_child_priority;
+		foreach (DepsRelation *rel, node->inlinks) {
+			if (rel->from->type != DEG_NODE_TYPE_OPERATION ||
+			    (rel->flag & DEPSREL_FLAG_CYCLIC) != 0)
+			{
+				continue;
+			}
+			OperationDepsNode *parent = (OperationDepsNode *)rel->from;
+			if ((parent->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0 &&
+			    --parent->num_links_pending == 0)
+			{
+				queue.push_back(parent);
+			}
+		}
 	}
 }
 
@@ -271,13 +420,41 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
 		task_scheduler = BLI_task_scheduler_get();
 		need_free_scheduler = false;
 	}
+	/* With a single core the scheduler still runs a background thread next to
+	 * the main one, ordering doesn't pay off there.
+	 */
+	state.use_priorities = (BLI_task_scheduler_num_threads(task_scheduler) > 1 &&
+	                        BLI_system_thread_count() > 1);
+	/* Operation costs change slowly, they are only measured every few
+	 * evaluations and after the graph was built.
+	 */
+	state.do_timing = do_time_debug;
+	if (state.use_priorities) {
+		if (graph->priority_update_countdown == 0) {
+			graph->priority_update_countdown = DEG_PRIORITY_UPDATE_INTERVAL;
+			state.do_timing = true;
+		}
+		else {
+			graph->priority_update_countdown--;
+		}
+	}
 	TaskPool *task_pool = BLI_task_pool_create_suspended(task_scheduler, &state);
+	if (state.do_stats) {
+		graph->eval_num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+		graph->eval_start_time = PIL_check_seconds_timer();
+	}
 	/* Prepare all nodes for evaluation. */
 	initialize_execution(&state, graph);
 	/* Do actual evaluation now. */
 	schedule_graph(task_pool, graph);
 	BLI_task_pool_work_and_wait(task_pool);
 	BLI_task_pool_free(task_pool);
+	if (state.do_stats) {
+		graph->eval_end_time = PIL_check_seconds_timer();
+	}
+	if (state.use_priorities && state.do_timing) {
+		update_operation_priorities(graph);
+	}
 	/* Finalize statistics gathering. This is because we only gather single
 	 * operation timing here, without aggregating anything to avoid any extra
 	 * synchronization.
@@ -293,6 +470,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
 	if (do_time_debug) {
 		printf("Depsgraph updated in %f seconds.\n",
 		       PIL_check_seconds_timer() - start_time);
+		deg_eval_stats_print_summary(graph);
 	}
 }
 
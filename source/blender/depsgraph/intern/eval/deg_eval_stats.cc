@@ -30,6 +30,10 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 
@@ -67,4 +71,138 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
 	}
 }
 
+namespace {
+
+BLI_INLINE bool operation_is_evaluated(const OperationDepsNode *op_node)
+{
+	return op_node->trace.thread_id != -1;
+}
+
+BLI_INLINE double operation_duration(const OperationDepsNode *op_node)
+{
+	return op_node->trace.end_time - op_node->trace.start_time;
+}
+
+}  // namespace
+
+double deg_eval_stats_critical_path(const Depsgraph *graph,
+                                    vector<OperationDepsNode *> *r_path)
+{
+	if (r_path != NULL) {
+		r_path->clear();
+	}
+	/* Operations which were evaluated, with their index in the array. */
+	vector<OperationDepsNode *> operations;
+	std::map<const OperationDepsNode *, int> operation_index;
+	foreach (OperationDepsNode *op_node, graph->operations) {
+		if (operation_is_evaluated(op_node)) {
+			operation_index[op_node] = operations.size();
+			operations.push_back(op_node);
+		}
+	}
+	const int num_operations = operations.size();
+	if (num_operations == 0) {
+		return 0.0;
+	}
+	/* Count dependencies between evaluated operations, relations which are
+	 * ignored by the scheduler are ignored here as well.
+	 */
+	vector<int> num_pending(num_operations, 0);
+	vector<int> queue;
+	queue.reserve(num_operations);
+	for (int i = 0; i < num_operations; ++i) {
+		foreach (DepsRelation *rel, operations[i]->outlinks) {
+			if (rel->flag & DEPSREL_FLAG_CYCLIC) {
+				continue;
+			}
+			std::map<const OperationDepsNode *, int>::const_iterator it =
+			        operation_index.find((OperationDepsNode *)rel->to);
+			if (it != operation_index.end()) {
+				++num_pending[it->second];
+			}
+		}
+	}
+	for (int i = 0; i < num_operations; ++i) {
+		if (num_pending[i] == 0) {
+			queue.push_back(i);
+		}
+	}
+	/* Longest path ending at every operation, visiting operations in
+	 * dependency order.
+	 */
+	vector<double> path_time(num_operations, 0.0);
+	vector<int> path_prev(num_operations, -1);
+	int path_end = -1;
+	for (int queue_index = 0; queue_index < (int)queue.size(); ++queue_index) {
+		const int i = queue[queue_index];
+		OperationDepsNode *op_node = operations[i];
+		path_time[i] += operation_duration(op_node);
+		if (path_end == -1 || path_time[i] > path_time[path_end]) {
+			path_end = i;
+		}
+		foreach (DepsRelation *rel, op_node->outlinks) {
+			if (rel->flag & DEPSREL_FLAG_CYCLIC) {
+				continue;
+			}
+			std::map<const OperationDepsNode *, int>::const_iterator it =
+			        operation_index.find((OperationDepsNode *)rel->to);
+			if (it == operation_index.end()) {
+				continue;
+			}
+			const int child = it->second;
+			if (path_prev[child] == -1 || path_time[i] > path_time[child]) {
+				path_time[child] = path_time[i];
+				path_prev[child] = i;
+			}
+			if (--num_pending[child] == 0) {
+				queue.push_back(child);
+			}
+		}
+	}
+	if (r_path != NULL) {
+		for (int i = path_end; i != -1; i = path_prev[i]) {
+			r_path->push_back(operations[i]);
+		}
+		std::reverse(r_path->begin(), r_path->end());
+	}
+	return path_time[path_end];
+}
+
+void deg_eval_stats_print_summary(const Depsgraph *graph)
+{
+	const double wall_time = graph->eval_end_time - graph->eval_start_time;
+	double operations_time = 0.0, wait_time = 0.0;
+	int num_operations = 0;
+	foreach (const OperationDepsNode *op_node, graph->operations) {
+		if (!operation_is_evaluated(op_node) || op_node->is_noop()) {
+			continue;
+		}
+		operations_time += operation_duration(op_node);
+		wait_time += op_node->trace.start_time - op_node->trace.ready_time;
+		++num_operations;
+	}
+	vector<OperationDepsNode *> path;
+	const double path_time = deg_eval_stats_critical_path(graph, &path);
+	const int num_threads = max(graph->eval_num_threads, 1);
+	const double efficiency = (wall_time > 0.0)
+	        ? operations_time / (wall_time * num_threads)
+	        : 0.0;
+	printf("Depsgraph evaluated %d operations on %d threads:\n",
+	       num_operations, num_threads);
+	printf("  Wall time %f, operations %f, waiting for a thread %f seconds.\n",
+	       wall_time, operations_time, wait_time);
+	printf("  Parallel efficiency %.1f%%, critical path %f seconds "
+	       "(%.1f%% of wall time).\n",
+	       efficiency * 100.0,
+	       path_time,
+	       (wall_time > 0.0) ? path_time / wall_time * 100.0 : 0.0);
+	/* Only list operations which contribute to the critical path. */
+	foreach (const OperationDepsNode *op_node, path) {
+		const double time = operation_duration(op_node);
+		if (time > 0.0) {
+			printf("    %f %s\n", time, op_node->full_identifier().c_str());
+		}
+	}
+}
+
 }  // namespace DEG
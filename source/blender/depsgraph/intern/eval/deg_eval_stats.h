@@ -30,11 +30,26 @@
 
 #pragma once
 
+#include "intern/depsgraph_types.h"
+
 namespace DEG {
 
 struct Depsgraph;
+struct OperationDepsNode;
 
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Find the chain of dependent operations which took longest to evaluate in
+ * the last evaluation. Returns total evaluation time of the chain, operations
+ * of the chain are stored in r_path (if not NULL) in evaluation order.
+ */
+double deg_eval_stats_critical_path(const Depsgraph *graph,
+                                    vector<OperationDepsNode *> *r_path);
+
+/* Print wall clock time, time spent in operations, critical path and
+ * parallel efficiency of the last evaluation.
+ */
+void deg_eval_stats_print_summary(const Depsgraph *graph);
+
 }  // namespace DEG
@@ -167,9 +167,9 @@ OperationDepsNode *ComponentDepsNode::find_operation(OperationIDKey key) const
 		node = (OperationDepsNode *)BLI_ghash_lookup(operations_map, &key);
 	}
 	else {
-		BLI_assert(key.name_tag == -1);
 		foreach (OperationDepsNode *op_node, operations) {
 			if (op_node->opcode == key.opcode &&
+			    op_node->name_tag == key.name_tag &&
 			    STREQ(op_node->name, key.name))
 			{
 				node = op_node;
@@ -232,8 +232,14 @@ OperationDepsNode *ComponentDepsNode::add_operation(const DepsEvalOperationCb& o
 		op_node = (OperationDepsNode *)factory->create_node(this->owner->id_orig, "", name);
 
 		/* register opnode in this component's operation set */
-		OperationIDKey *key = OBJECT_GUARDED_NEW(OperationIDKey, opcode, name, name_tag);
-		BLI_ghash_insert(operations_map, key, op_node);
+		if (operations_map != NULL) {
+			OperationIDKey *key = OBJECT_GUARDED_NEW(OperationIDKey, opcode, name, name_tag);
+			BLI_ghash_insert(operations_map, key, op_node);
+		}
+		else {
+			/* Component is already finalized, happens on partial rebuild. */
+			operations.push_back(op_node);
+		}
 
 		/* set backlink */
 		op_node->owner = this;
@@ -247,6 +253,7 @@ OperationDepsNode *ComponentDepsNode::add_operation(const DepsEvalOperationCb& o
 	/* attach extra data */
 	op_node->evaluate = op;
 	op_node->opcode = opcode;
+	op_node->name_tag = name_tag;
 	op_node->name = name;
 
 	return op_node;
@@ -344,6 +351,10 @@ OperationDepsNode *ComponentDepsNode::get_exit_operation()
 
 void ComponentDepsNode::finalize_build(Depsgraph * /*graph*/)
 {
+	if (operations_map == NULL) {
+		/* Already finalized, component was kept on partial rebuild. */
+		return;
+	}
 	operations.reserve(BLI_ghash_len(operations_map));
 	GHASH_FOREACH_BEGIN(OperationDepsNode *, op_node, operations_map)
 	{
@@ -44,9 +44,25 @@ namespace DEG {
 /* *********** */
 /* Inner Nodes */
 
+OperationDepsNode::Trace::Trace()
+{
+	reset();
+}
+
+void OperationDepsNode::Trace::reset()
+{
+	ready_time = 0.0;
+	start_time = 0.0;
+	end_time = 0.0;
+	thread_id = -1;
+}
+
 OperationDepsNode::OperationDepsNode() :
+    name_tag(-1),
     flag(0),
-    customdata_mask(0)
+    customdata_mask(0),
+    cost(0.0f),
+    priority(0.0f)
 {
 }
 
@@ -51,6 +51,20 @@ typedef enum eDepsOperation_Flag {
 
 /* Atomic Operation - Base type for all operations */
 struct OperationDepsNode : public DepsNode {
+	/* Timing of the last evaluation, only filled in when gathering
+	 * statistics. Times are in seconds, as returned by PIL_check_seconds_timer.
+	 */
+	struct Trace {
+		Trace();
+		void reset();
+		/* All inputs are evaluated and the operation is scheduled. */
+		double ready_time;
+		/* The operation is picked up and evaluated by a thread. */
+		double start_time;
+		double end_time;
+		int thread_id;
+	};
+
 	OperationDepsNode();
 	~OperationDepsNode();
 
@@ -80,6 +94,7 @@ struct OperationDepsNode : public DepsNode {
 
 	/* Identifier for the operation being performed. */
 	eDepsOperation_Code opcode;
+	int name_tag;
 
 	/* (eDepsOperation_Flag) extra settings affecting evaluation. */
 	int flag;
@@ -87,6 +102,15 @@ struct OperationDepsNode : public DepsNode {
 	/* Extra customdata mask which needs to be evaluated for the object. */
 	uint64_t customdata_mask;
 
+	/* Estimated evaluation time in seconds, from previous evaluations. */
+	float cost;
+	/* Cost of the most expensive chain of operations starting at this one,
+	 * operations with higher priority are scheduled first.
+	 */
+	float priority;
+
+	Trace trace;
+
 	DEG_DEPSNODE_DECLARE;
 };
 
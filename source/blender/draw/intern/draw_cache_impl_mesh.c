@@ -36,6 +36,7 @@
 #include "BLI_math_bits.h"
 #include "BLI_string.h"
 #include "BLI_alloca.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -197,6 +198,12 @@ typedef struct MeshRenderData {
 	Gwn_PackedNormal *poly_normals_pack;
 	Gwn_PackedNormal *vert_normals_pack;
 	bool *edge_select_bool;
+
+	/* Index of each looptri in buffers which skip hidden faces, -1 when hidden,
+	 * see mesh_render_data_ensure_looptri_dst(). */
+	int *looptri_dst;
+	int looptri_dst_len;
+	bool looptri_dst_valid;
 } MeshRenderData;
 
 enum {
@@ -823,6 +830,7 @@ static void mesh_render_data_free(MeshRenderData *rdata)
 	MEM_SAFE_FREE(rdata->vert_weight_color);
 	MEM_SAFE_FREE(rdata->edge_select_bool);
 	MEM_SAFE_FREE(rdata->vert_color);
+	MEM_SAFE_FREE(rdata->looptri_dst);
 
 	CustomData_free(&rdata->cd.output.ldata, rdata->loop_len);
 
@@ -1164,6 +1172,50 @@ static void mesh_render_data_ensure_edge_select_bool(MeshRenderData *rdata, bool
 	}
 }
 
+/**
+ * Ensure #MeshRenderData.looptri_dst, so triangle buffers can be filled in parallel
+ * and stay packed when hidden faces are skipped. Edit-mode always skips hidden faces.
+ *
+ * Returns NULL when every triangle is written, the number of written triangles is
+ * returned in \a r_len.
+ */
+static const int *mesh_render_data_ensure_looptri_dst(MeshRenderData *rdata, const bool use_hide, int *r_len)
+{
+	const int tri_len = mesh_render_data_looptri_len_get(rdata);
+
+	if (!rdata->edit_bmesh && !use_hide) {
+		*r_len = tri_len;
+		return NULL;
+	}
+
+	if (!rdata->looptri_dst_valid) {
+		int *tri_dst = MEM_mallocN(sizeof(*tri_dst) * tri_len, __func__);
+		int dst = 0;
+
+		for (int i = 0; i < tri_len; i++) {
+			bool hidden;
+			if (rdata->edit_bmesh) {
+				hidden = BM_elem_flag_test(rdata->edit_bmesh->looptris[i][0]->f, BM_ELEM_HIDDEN);
+			}
+			else {
+				hidden = (rdata->mpoly[rdata->mlooptri[i].poly].flag & ME_HIDE) != 0;
+			}
+			tri_dst[i] = hidden ? -1 : dst++;
+		}
+
+		if (dst == tri_len) {
+			MEM_freeN(tri_dst);
+			tri_dst = NULL;
+		}
+		rdata->looptri_dst = tri_dst;
+		rdata->looptri_dst_len = dst;
+		rdata->looptri_dst_valid = true;
+	}
+
+	*r_len = rdata->looptri_dst_len;
+	return rdata->looptri_dst;
+}
+
 /** \} */
 
 /* ---------------------------------------------------------------------- */
@@ -1582,6 +1634,8 @@ typedef struct MeshBatchCache {
 
 	/* XXX, only keep for as long as sculpt mode uses shaded drawing. */
 	bool is_sculpt_points_tag;
+	/* During strokes, pos_with_normals keeps its data and is updated in place. */
+	bool is_sculpt_points_dynamic;
 } MeshBatchCache;
 
 /* Gwn_Batch cache management. */
@@ -1700,6 +1754,15 @@ void DRW_mesh_batch_cache_dirty(Mesh *me, int mode)
 		case BKE_MESH_BATCH_DIRTY_SCULPT_COORDS:
 			cache->is_sculpt_points_tag = true;
 			break;
+		case BKE_MESH_BATCH_DIRTY_SCULPT_STROKE_DONE:
+			/* Free the data once uploaded, the next stroke recreates the buffer as dynamic. */
+			if (cache->is_sculpt_points_dynamic) {
+				if (cache->pos_with_normals) {
+					GWN_vertbuf_usage_set(cache->pos_with_normals, GWN_USAGE_STATIC);
+				}
+				cache->is_sculpt_points_dynamic = false;
+			}
+			break;
 		default:
 			BLI_assert(0);
 	}
@@ -2102,136 +2165,276 @@ static Gwn_VertBuf *mesh_batch_cache_get_tri_uv_active(
 	return cache->tri_aligned_uv;
 }
 
-static Gwn_VertBuf *mesh_batch_cache_get_tri_pos_and_normals_ex(
-        MeshRenderData *rdata, const bool use_hide,
-        Gwn_VertBuf **r_vbo)
+/* Triangle buffers are filled in parallel, each triangle writes to its own
+ * three vertices given by #mesh_render_data_ensure_looptri_dst. */
+#define MESH_EXTRACT_TRI_TASK_LIMIT 1024
+
+typedef struct MeshExtractTriData {
+	MeshRenderData *rdata;
+	const int *tri_dst;
+
+	Gwn_VertBufRaw pos;
+	Gwn_VertBufRaw nor;
+	Gwn_VertBufRaw col;
+
+	const float (*lnors)[3];
+	const Gwn_PackedNormal *pnors_pack;
+	const Gwn_PackedNormal *vnors_pack;
+	const char (*vert_color)[3];
+
+	/* In place updates only, one flag per #MESH_UPDATE_TRI_CHUNK triangles. */
+	int tri_len;
+	bool *chunk_dirty;
+} MeshExtractTriData;
+
+BLI_INLINE void *mesh_extract_raw_elem(const Gwn_VertBufRaw *raw, const int index)
 {
-	BLI_assert(rdata->types & (MR_DATATYPE_VERT | MR_DATATYPE_LOOPTRI | MR_DATATYPE_LOOP | MR_DATATYPE_POLY));
+	return raw->data_init + (size_t)raw->stride * (size_t)index;
+}
 
-	if (*r_vbo == NULL) {
-		static Gwn_VertFormat format = { 0 };
-		static struct { uint pos, nor; } attr_id;
-		if (format.attrib_ct == 0) {
-			attr_id.pos = GWN_vertformat_attr_add(&format, "pos", GWN_COMP_F32, 3, GWN_FETCH_FLOAT);
-			attr_id.nor = GWN_vertformat_attr_add(&format, "nor", GWN_COMP_I10, 3, GWN_FETCH_INT_TO_FLOAT_UNIT);
+/* Index of the first vertex written for the triangle, -1 when skipped. */
+BLI_INLINE int mesh_extract_tri_vert_dst(const MeshExtractTriData *data, const int i)
+{
+	if (data->tri_dst == NULL) {
+		return i * 3;
+	}
+	return (data->tri_dst[i] != -1) ? data->tri_dst[i] * 3 : -1;
+}
+
+static void mesh_extract_tri_pos_and_normals_bm_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const MeshExtractTriData *data = userdata;
+	const MeshRenderData *rdata = data->rdata;
+	const int dst = mesh_extract_tri_vert_dst(data, i);
+
+	if (dst == -1) {
+		return;
+	}
+
+	const BMLoop **bm_looptri = (const BMLoop **)rdata->edit_bmesh->looptris[i];
+	const BMFace *bm_face = bm_looptri[0]->f;
+
+	for (uint t = 0; t < 3; t++) {
+		Gwn_PackedNormal *nor = mesh_extract_raw_elem(&data->nor, dst + t);
+		if (data->lnors) {
+			*nor = GWN_normal_convert_i10_v3(data->lnors[BM_elem_index_get(bm_looptri[t])]);
+		}
+		else if (BM_elem_flag_test(bm_face, BM_ELEM_SMOOTH)) {
+			*nor = data->vnors_pack[BM_elem_index_get(bm_looptri[t]->v)];
+		}
+		else {
+			*nor = data->pnors_pack[BM_elem_index_get(bm_face)];
 		}
+	}
 
-		const int tri_len = mesh_render_data_looptri_len_get(rdata);
+	/* TODO(sybren): deduplicate this and all the other places it's pasted to in this file. */
+	for (uint t = 0; t < 3; t++) {
+		float *pos = mesh_extract_raw_elem(&data->pos, dst + t);
+		if (rdata->edit_data && rdata->edit_data->vertexCos) {
+			copy_v3_v3(pos, rdata->edit_data->vertexCos[BM_elem_index_get(bm_looptri[t]->v)]);
+		}
+		else {
+			copy_v3_v3(pos, bm_looptri[t]->v->co);
+		}
+	}
+}
 
-		Gwn_VertBuf *vbo = *r_vbo = GWN_vertbuf_create_with_format(&format);
+static void mesh_extract_tri_pos_and_normals_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const MeshExtractTriData *data = userdata;
+	const MeshRenderData *rdata = data->rdata;
+	const int dst = mesh_extract_tri_vert_dst(data, i);
 
-		const int vbo_len_capacity = tri_len * 3;
-		int vbo_len_used = 0;
-		GWN_vertbuf_data_alloc(vbo, vbo_len_capacity);
+	if (dst == -1) {
+		return;
+	}
 
-		Gwn_VertBufRaw pos_step, nor_step;
-		GWN_vertbuf_attr_get_raw_data(vbo, attr_id.pos, &pos_step);
-		GWN_vertbuf_attr_get_raw_data(vbo, attr_id.nor, &nor_step);
+	const MLoopTri *mlt = &rdata->mlooptri[i];
+	const MPoly *mp = &rdata->mpoly[mlt->poly];
 
-		float (*lnors)[3] = rdata->loop_normals;
+	for (uint t = 0; t < 3; t++) {
+		const MVert *mv = &rdata->mvert[rdata->mloop[mlt->tri[t]].v];
+		Gwn_PackedNormal *nor = mesh_extract_raw_elem(&data->nor, dst + t);
 
-		if (rdata->edit_bmesh) {
-			Gwn_PackedNormal *pnors_pack, *vnors_pack;
+		if (data->lnors) {
+			*nor = GWN_normal_convert_i10_v3(data->lnors[mlt->tri[t]]);
+		}
+		else if (mp->flag & ME_SMOOTH) {
+			*nor = GWN_normal_convert_i10_s3(mv->no);
+		}
+		else {
+			*nor = data->pnors_pack[mlt->poly];
+		}
 
-			if (lnors == NULL) {
-				mesh_render_data_ensure_poly_normals_pack(rdata);
-				mesh_render_data_ensure_vert_normals_pack(rdata);
+		copy_v3_v3(mesh_extract_raw_elem(&data->pos, dst + t), mv->co);
+	}
+}
+
+/* Triangles are compared in chunks when updating in place,
+ * only the range spanning modified chunks is uploaded. */
+#define MESH_UPDATE_TRI_CHUNK 1024
 
-				pnors_pack = rdata->poly_normals_pack;
-				vnors_pack = rdata->vert_normals_pack;
+static void mesh_update_tri_pos_and_normals_cb(
+        void *__restrict userdata,
+        const int chunk,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const MeshExtractTriData *data = userdata;
+	const MeshRenderData *rdata = data->rdata;
+	const int tri_end = min_ii((chunk + 1) * MESH_UPDATE_TRI_CHUNK, data->tri_len);
+	bool is_dirty = false;
+
+	for (int i = chunk * MESH_UPDATE_TRI_CHUNK; i < tri_end; i++) {
+		const MLoopTri *mlt = &rdata->mlooptri[i];
+		const MPoly *mp = &rdata->mpoly[mlt->poly];
+
+		for (uint t = 0; t < 3; t++) {
+			const MVert *mv = &rdata->mvert[rdata->mloop[mlt->tri[t]].v];
+			float *pos = mesh_extract_raw_elem(&data->pos, i * 3 + t);
+			Gwn_PackedNormal *nor = mesh_extract_raw_elem(&data->nor, i * 3 + t);
+			Gwn_PackedNormal nor_new;
+
+			if (data->lnors) {
+				nor_new = GWN_normal_convert_i10_v3(data->lnors[mlt->tri[t]]);
+			}
+			else if (mp->flag & ME_SMOOTH) {
+				nor_new = GWN_normal_convert_i10_s3(mv->no);
+			}
+			else {
+				nor_new = data->pnors_pack[mlt->poly];
 			}
 
-			for (int i = 0; i < tri_len; i++) {
-				const BMLoop **bm_looptri = (const BMLoop **)rdata->edit_bmesh->looptris[i];
-				const BMFace *bm_face = bm_looptri[0]->f;
+			if (!equals_v3v3(pos, mv->co) || memcmp(nor, &nor_new, sizeof(nor_new)) != 0) {
+				copy_v3_v3(pos, mv->co);
+				*nor = nor_new;
+				is_dirty = true;
+			}
+		}
+	}
 
-				/* use_hide always for edit-mode */
-				if (BM_elem_flag_test(bm_face, BM_ELEM_HIDDEN)) {
-					continue;
-				}
+	data->chunk_dirty[chunk] = is_dirty;
+}
 
-				if (lnors) {
-					for (uint t = 0; t < 3; t++) {
-						const float *nor = lnors[BM_elem_index_get(bm_looptri[t])];
-						*((Gwn_PackedNormal *)GWN_vertbuf_raw_step(&nor_step)) = GWN_normal_convert_i10_v3(nor);
-					}
-				}
-				else if (BM_elem_flag_test(bm_face, BM_ELEM_SMOOTH)) {
-					for (uint t = 0; t < 3; t++) {
-						*((Gwn_PackedNormal *)GWN_vertbuf_raw_step(&nor_step)) = vnors_pack[BM_elem_index_get(bm_looptri[t]->v)];
-					}
-				}
-				else {
-					const Gwn_PackedNormal *snor_pack = &pnors_pack[BM_elem_index_get(bm_face)];
-					for (uint t = 0; t < 3; t++) {
-						*((Gwn_PackedNormal *)GWN_vertbuf_raw_step(&nor_step)) = *snor_pack;
-					}
-				}
+static Gwn_VertFormat *mesh_tri_pos_and_normals_format(uint *r_pos_id, uint *r_nor_id)
+{
+	static Gwn_VertFormat format = { 0 };
+	static struct { uint pos, nor; } attr_id;
+	if (format.attrib_ct == 0) {
+		attr_id.pos = GWN_vertformat_attr_add(&format, "pos", GWN_COMP_F32, 3, GWN_FETCH_FLOAT);
+		attr_id.nor = GWN_vertformat_attr_add(&format, "nor", GWN_COMP_I10, 3, GWN_FETCH_INT_TO_FLOAT_UNIT);
+	}
+	*r_pos_id = attr_id.pos;
+	*r_nor_id = attr_id.nor;
+	return &format;
+}
 
-				/* TODO(sybren): deduplicate this and all the other places it's pasted to in this file. */
-				if (rdata->edit_data && rdata->edit_data->vertexCos) {
-					for (uint t = 0; t < 3; t++) {
-						int vidx = BM_elem_index_get(bm_looptri[t]->v);
-						const float *pos = rdata->edit_data->vertexCos[vidx];
-						copy_v3_v3(GWN_vertbuf_raw_step(&pos_step), pos);
-					}
-				}
-				else {
-					for (uint t = 0; t < 3; t++) {
-						copy_v3_v3(GWN_vertbuf_raw_step(&pos_step), bm_looptri[t]->v->co);
-					}
-				}
-			}
+/**
+ * Refill a buffer created by #mesh_batch_cache_get_tri_pos_and_normals_ex
+ * (without hidden faces, with #GWN_USAGE_DYNAMIC) keeping its batches,
+ * only modified chunks are sent to the GPU.
+ *
+ * \return false when the topology changed and the buffer needs to be recreated.
+ */
+static bool mesh_batch_cache_update_tri_pos_and_normals(
+        MeshRenderData *rdata, Gwn_VertBuf *vbo)
+{
+	BLI_assert(rdata->types & (MR_DATATYPE_VERT | MR_DATATYPE_LOOPTRI | MR_DATATYPE_LOOP | MR_DATATYPE_POLY));
+
+	const int tri_len = mesh_render_data_looptri_len_get(rdata);
+
+	if (rdata->edit_bmesh || vbo->data == NULL || vbo->vertex_ct != (uint)tri_len * 3) {
+		return false;
+	}
+
+	uint pos_id, nor_id;
+	mesh_tri_pos_and_normals_format(&pos_id, &nor_id);
+
+	const int chunk_len = (tri_len + MESH_UPDATE_TRI_CHUNK - 1) / MESH_UPDATE_TRI_CHUNK;
+	MeshExtractTriData data = {
+		.rdata = rdata,
+		.lnors = (const float (*)[3])rdata->loop_normals,
+		.tri_len = tri_len,
+		.chunk_dirty = MEM_mallocN(sizeof(bool) * chunk_len, __func__),
+	};
+	GWN_vertbuf_attr_get_raw_data_ex(vbo, pos_id, &data.pos, false);
+	GWN_vertbuf_attr_get_raw_data_ex(vbo, nor_id, &data.nor, false);
+
+	if (data.lnors == NULL) {
+		mesh_render_data_ensure_poly_normals_pack(rdata);
+		data.pnors_pack = rdata->poly_normals_pack;
+	}
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 1;
+	BLI_task_parallel_range(0, chunk_len, &data, mesh_update_tri_pos_and_normals_cb, &settings);
+
+	for (int chunk = 0; chunk < chunk_len; chunk++) {
+		if (data.chunk_dirty[chunk]) {
+			const int tri_start = chunk * MESH_UPDATE_TRI_CHUNK;
+			const int tri_end = min_ii(tri_start + MESH_UPDATE_TRI_CHUNK, tri_len);
+			GWN_vertbuf_dirty_range_tag(vbo, tri_start * 3, (tri_end - tri_start) * 3);
 		}
-		else {
-			if (lnors == NULL) {
-				/* Use normals from vertex. */
-				mesh_render_data_ensure_poly_normals_pack(rdata);
-			}
+	}
+	MEM_freeN(data.chunk_dirty);
 
-			for (int i = 0; i < tri_len; i++) {
-				const MLoopTri *mlt = &rdata->mlooptri[i];
-				const MPoly *mp = &rdata->mpoly[mlt->poly];
+	/* Batches keep their bindings, send the data now. */
+	GWN_vertbuf_use(vbo);
 
-				if (use_hide && (mp->flag & ME_HIDE)) {
-					continue;
-				}
+	return true;
+}
 
-				const uint vtri[3] = {
-					rdata->mloop[mlt->tri[0]].v,
-					rdata->mloop[mlt->tri[1]].v,
-					rdata->mloop[mlt->tri[2]].v,
-				};
+static Gwn_VertBuf *mesh_batch_cache_get_tri_pos_and_normals_ex(
+        MeshRenderData *rdata, const bool use_hide, const Gwn_UsageType usage,
+        Gwn_VertBuf **r_vbo)
+{
+	BLI_assert(rdata->types & (MR_DATATYPE_VERT | MR_DATATYPE_LOOPTRI | MR_DATATYPE_LOOP | MR_DATATYPE_POLY));
 
-				if (lnors) {
-					for (uint t = 0; t < 3; t++) {
-						const float *nor = lnors[mlt->tri[t]];
-						*((Gwn_PackedNormal *)GWN_vertbuf_raw_step(&nor_step)) = GWN_normal_convert_i10_v3(nor);
-					}
-				}
-				else if (mp->flag & ME_SMOOTH) {
-					for (uint t = 0; t < 3; t++) {
-						const MVert *mv = &rdata->mvert[vtri[t]];
-						*((Gwn_PackedNormal *)GWN_vertbuf_raw_step(&nor_step)) = GWN_normal_convert_i10_s3(mv->no);
-					}
-				}
-				else {
-					const Gwn_PackedNormal *pnors_pack = &rdata->poly_normals_pack[mlt->poly];
-					for (uint t = 0; t < 3; t++) {
-						*((Gwn_PackedNormal *)GWN_vertbuf_raw_step(&nor_step)) = *pnors_pack;
-					}
-				}
+	if (*r_vbo == NULL) {
+		struct { uint pos, nor; } attr_id;
+		Gwn_VertFormat *format = mesh_tri_pos_and_normals_format(&attr_id.pos, &attr_id.nor);
 
-				for (uint t = 0; t < 3; t++) {
-					const MVert *mv = &rdata->mvert[vtri[t]];
-					copy_v3_v3(GWN_vertbuf_raw_step(&pos_step), mv->co);
-				}
+		const int tri_len = mesh_render_data_looptri_len_get(rdata);
+
+		Gwn_VertBuf *vbo = *r_vbo = GWN_vertbuf_create_with_format_ex(format, usage);
+
+		const int vbo_len_capacity = tri_len * 3;
+		int tri_len_used;
+		GWN_vertbuf_data_alloc(vbo, vbo_len_capacity);
+
+		MeshExtractTriData data = {
+			.rdata = rdata,
+			.tri_dst = mesh_render_data_ensure_looptri_dst(rdata, use_hide, &tri_len_used),
+			.lnors = (const float (*)[3])rdata->loop_normals,
+		};
+		GWN_vertbuf_attr_get_raw_data(vbo, attr_id.pos, &data.pos);
+		GWN_vertbuf_attr_get_raw_data(vbo, attr_id.nor, &data.nor);
+
+		if (data.lnors == NULL) {
+			/* Use normals from vertex. */
+			mesh_render_data_ensure_poly_normals_pack(rdata);
+			data.pnors_pack = rdata->poly_normals_pack;
+			if (rdata->edit_bmesh) {
+				mesh_render_data_ensure_vert_normals_pack(rdata);
+				data.vnors_pack = rdata->vert_normals_pack;
 			}
 		}
 
-		vbo_len_used = GWN_vertbuf_raw_used(&pos_step);
-		BLI_assert(vbo_len_used == GWN_vertbuf_raw_used(&nor_step));
+		ParallelRangeSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.min_iter_per_thread = MESH_EXTRACT_TRI_TASK_LIMIT;
+		BLI_task_parallel_range(
+		        0, tri_len, &data,
+		        rdata->edit_bmesh ? mesh_extract_tri_pos_and_normals_bm_cb : mesh_extract_tri_pos_and_normals_cb,
+		        &settings);
 
+		const int vbo_len_used = tri_len_used * 3;
 		if (vbo_len_capacity != vbo_len_used) {
 			GWN_vertbuf_data_resize(vbo, vbo_len_used);
 		}
@@ -2243,7 +2446,7 @@ static Gwn_VertBuf *mesh_batch_cache_get_tri_pos_and_normals(
         MeshRenderData *rdata, MeshBatchCache *cache)
 {
 	return mesh_batch_cache_get_tri_pos_and_normals_ex(
-	        rdata, false,
+	        rdata, false, cache->is_sculpt_points_dynamic ? GWN_USAGE_DYNAMIC : GWN_USAGE_STATIC,
 	        &cache->pos_with_normals);
 }
 static Gwn_VertBuf *mesh_create_tri_pos_and_normals_visible_only(
@@ -2251,7 +2454,7 @@ static Gwn_VertBuf *mesh_create_tri_pos_and_normals_visible_only(
 {
 	Gwn_VertBuf *vbo_dummy = NULL;
 	return mesh_batch_cache_get_tri_pos_and_normals_ex(
-	        rdata, true,
+	        rdata, true, GWN_USAGE_STATIC,
 	        &vbo_dummy);
 }
 
@@ -2607,6 +2810,27 @@ static Gwn_VertBuf *mesh_create_tri_weights(
 	return vbo;
 }
 
+static void mesh_extract_tri_vert_colors_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const MeshExtractTriData *data = userdata;
+	const MeshRenderData *rdata = data->rdata;
+	const int dst = mesh_extract_tri_vert_dst(data, i);
+
+	if (dst == -1) {
+		return;
+	}
+
+	for (uint tri_corner = 0; tri_corner < 3; tri_corner++) {
+		const int l_index = rdata->edit_bmesh ?
+		        BM_elem_index_get(rdata->edit_bmesh->looptris[i][tri_corner]) :
+		        (int)rdata->mlooptri[i].tri[tri_corner];
+		memcpy(mesh_extract_raw_elem(&data->col, dst + tri_corner), data->vert_color[l_index], sizeof(*data->vert_color));
+	}
+}
+
 static Gwn_VertBuf *mesh_create_tri_vert_colors(
         MeshRenderData *rdata, bool use_hide)
 {
@@ -2616,8 +2840,6 @@ static Gwn_VertBuf *mesh_create_tri_vert_colors(
 
 	Gwn_VertBuf *vbo;
 	{
-		unsigned int cidx = 0;
-
 		static Gwn_VertFormat format = { 0 };
 		static struct { uint col; } attr_id;
 		if (format.attrib_ct == 0) {
@@ -2629,35 +2851,25 @@ static Gwn_VertBuf *mesh_create_tri_vert_colors(
 		vbo = GWN_vertbuf_create_with_format(&format);
 
 		const uint vbo_len_capacity = tri_len * 3;
+		int tri_len_used;
 		GWN_vertbuf_data_alloc(vbo, vbo_len_capacity);
 
 		mesh_render_data_ensure_vert_color(rdata);
-		const char (*vert_color)[3] = rdata->vert_color;
 
-		if (rdata->edit_bmesh) {
-			for (int i = 0; i < tri_len; i++) {
-				const BMLoop **ltri = (const BMLoop **)rdata->edit_bmesh->looptris[i];
-				/* Assume 'use_hide' */
-				if (!BM_elem_flag_test(ltri[0]->f, BM_ELEM_HIDDEN)) {
-					for (uint tri_corner = 0; tri_corner < 3; tri_corner++) {
-						const int l_index = BM_elem_index_get(ltri[tri_corner]);
-						GWN_vertbuf_attr_set(vbo, attr_id.col, cidx++, vert_color[l_index]);
-					}
-				}
-			}
-		}
-		else {
-			for (int i = 0; i < tri_len; i++) {
-				const MLoopTri *mlt = &rdata->mlooptri[i];
-				if (!(use_hide && (rdata->mpoly[mlt->poly].flag & ME_HIDE))) {
-					for (uint tri_corner = 0; tri_corner < 3; tri_corner++) {
-						const uint l_index = mlt->tri[tri_corner];
-						GWN_vertbuf_attr_set(vbo, attr_id.col, cidx++, vert_color[l_index]);
-					}
-				}
-			}
-		}
-		const uint vbo_len_used = cidx;
+		MeshExtractTriData data = {
+			.rdata = rdata,
+			/* Edit-mode assumes 'use_hide'. */
+			.tri_dst = mesh_render_data_ensure_looptri_dst(rdata, use_hide, &tri_len_used),
+			.vert_color = (const char (*)[3])rdata->vert_color,
+		};
+		GWN_vertbuf_attr_get_raw_data(vbo, attr_id.col, &data.col);
+
+		ParallelRangeSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.min_iter_per_thread = MESH_EXTRACT_TRI_TASK_LIMIT;
+		BLI_task_parallel_range(0, tri_len, &data, mesh_extract_tri_vert_colors_cb, &settings);
+
+		const uint vbo_len_used = tri_len_used * 3;
 
 		if (vbo_len_capacity != vbo_len_used) {
 			GWN_vertbuf_data_resize(vbo, vbo_len_used);
@@ -4008,10 +4220,20 @@ void DRW_mesh_cache_sculpt_coords_ensure(Mesh *me)
 	if (me->runtime.batch_cache) {
 		MeshBatchCache *cache = mesh_batch_cache_get(me);
 		if (cache && cache->pos_with_normals && cache->is_sculpt_points_tag) {
-			/* XXX Force update of all the batches that contains the pos_with_normals buffer.
-			 * TODO(fclem): Ideally, Gawain should provide a way to update a buffer without destroying it. */
-			mesh_batch_cache_clear_selective(me, cache->pos_with_normals);
-			GWN_VERTBUF_DISCARD_SAFE(cache->pos_with_normals);
+			bool updated = false;
+			if (cache->is_sculpt_points_dynamic) {
+				const int datatype = MR_DATATYPE_VERT | MR_DATATYPE_LOOPTRI | MR_DATATYPE_LOOP | MR_DATATYPE_POLY;
+				MeshRenderData *rdata = mesh_render_data_create(me, datatype);
+				updated = mesh_batch_cache_update_tri_pos_and_normals(rdata, cache->pos_with_normals);
+				mesh_render_data_free(rdata);
+			}
+			if (!updated) {
+				/* Force update of all the batches that contains the pos_with_normals buffer,
+				 * it's recreated keeping its data so following strokes update it in place. */
+				mesh_batch_cache_clear_selective(me, cache->pos_with_normals);
+				GWN_VERTBUF_DISCARD_SAFE(cache->pos_with_normals);
+				cache->is_sculpt_points_dynamic = true;
+			}
 		}
 		cache->is_sculpt_points_tag = false;
 	}
@@ -36,6 +36,8 @@
 #include "BLI_memarena.h"
 #include "BLI_string.h"
 #include "BLI_alloca.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BLT_translation.h"
 
@@ -803,6 +805,9 @@ void heat_bone_weighting(
 
 #define MESHDEFORM_MIN_INFLUENCE 0.0005f
 
+/** number of cage vertices solved together, the linear solver supports up to 4 right hand sides */
+#define MESHDEFORM_SOLVE_RHS 4
+
 static const int MESHDEFORM_OFFSET[7][3] = {
 	{0, 0, 0}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
 };
@@ -840,6 +845,7 @@ typedef struct MeshDeformBind {
 
 	/* grids */
 	MemArena *memarena;
+	SpinLock memarena_lock;
 	MDefBoundIsect *(*boundisect)[6];
 	int *semibound;
 	int *tag;
@@ -987,34 +993,42 @@ static void harmonic_ray_callback(void *userdata, int index, const BVHTreeRay *r
 	}
 }
 
-static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb, const float co1[3], const float co2[3])
+/* ray-cast only, doesn't allocate so it can run from multiple threads */
+static bool meshdeform_ray_tree_cast(
+        MeshDeformBind *mdb, const float co1[3], const float co2[3],
+        MeshDeformIsect *r_isect_mdef, BVHTreeRayHit *r_hit)
 {
-	BVHTreeRayHit hit;
-	MeshDeformIsect isect_mdef;
 	struct MeshRayCallbackData data = {
 		mdb,
-		&isect_mdef,
+		r_isect_mdef,
 	};
 	float end[3], vec_normal[3];
 
 	/* happens binding when a cage has no faces */
 	if (UNLIKELY(mdb->bvhtree == NULL))
-		return NULL;
+		return false;
 
 	/* setup isec */
-	memset(&isect_mdef, 0, sizeof(isect_mdef));
-	isect_mdef.lambda = 1e10f;
+	memset(r_isect_mdef, 0, sizeof(*r_isect_mdef));
+	r_isect_mdef->lambda = 1e10f;
 
-	copy_v3_v3(isect_mdef.start, co1);
+	copy_v3_v3(r_isect_mdef->start, co1);
 	copy_v3_v3(end, co2);
-	sub_v3_v3v3(isect_mdef.vec, end, isect_mdef.start);
-	isect_mdef.vec_length = normalize_v3_v3(vec_normal, isect_mdef.vec);
+	sub_v3_v3v3(r_isect_mdef->vec, end, r_isect_mdef->start);
+	r_isect_mdef->vec_length = normalize_v3_v3(vec_normal, r_isect_mdef->vec);
 
-	hit.index = -1;
-	hit.dist = BVH_RAYCAST_DIST_MAX;
-	if (BLI_bvhtree_ray_cast(mdb->bvhtree, isect_mdef.start, vec_normal,
-	                         0.0, &hit, harmonic_ray_callback, &data) != -1)
-	{
+	r_hit->index = -1;
+	r_hit->dist = BVH_RAYCAST_DIST_MAX;
+	return (BLI_bvhtree_ray_cast(mdb->bvhtree, r_isect_mdef->start, vec_normal,
+	                             0.0, r_hit, harmonic_ray_callback, &data) != -1);
+}
+
+static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb, const float co1[3], const float co2[3])
+{
+	BVHTreeRayHit hit;
+	MeshDeformIsect isect_mdef;
+
+	if (meshdeform_ray_tree_cast(mdb, co1, co2, &isect_mdef, &hit)) {
 		const MLoop *mloop = mdb->cagedm_cache.mloop;
 		const MLoopTri *lt = &mdb->cagedm_cache.looptri[hit.index];
 		const MPoly *mp = &mdb->cagedm_cache.mpoly[lt->poly];
@@ -1026,7 +1040,9 @@ static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb, const
 		int i;
 
 		/* create MDefBoundIsect, and extra for 'poly_weights[]' */
+		BLI_spin_lock(&mdb->memarena_lock);
 		isect = BLI_memarena_alloc(mdb->memarena, sizeof(*isect) + (sizeof(float) * mp->totloop));
+		BLI_spin_unlock(&mdb->memarena_lock);
 
 		/* compute intersection coordinate */
 		madd_v3_v3v3fl(isect->co, co1, isect_mdef.vec, len);
@@ -1052,7 +1068,8 @@ static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb, const
 
 static int meshdeform_inside_cage(MeshDeformBind *mdb, float *co)
 {
-	MDefBoundIsect *isect;
+	BVHTreeRayHit hit;
+	MeshDeformIsect isect_mdef;
 	float outside[3], start[3], dir[3];
 	int i;
 
@@ -1065,8 +1082,7 @@ static int meshdeform_inside_cage(MeshDeformBind *mdb, float *co)
 		sub_v3_v3v3(dir, outside, start);
 		normalize_v3(dir);
 		
-		isect = meshdeform_ray_tree_intersect(mdb, start, outside);
-		if (isect && !isect->facing)
+		if (meshdeform_ray_tree_cast(mdb, start, outside, &isect_mdef, &hit) && !isect_mdef.isect)
 			return 1;
 	}
 
@@ -1306,7 +1322,7 @@ static void meshdeform_matrix_add_cell(MeshDeformBind *mdb, LinearSolver *contex
 	}
 }
 
-static void meshdeform_matrix_add_rhs(MeshDeformBind *mdb, LinearSolver *context, int x, int y, int z, int cagevert)
+static void meshdeform_matrix_add_rhs(MeshDeformBind *mdb, LinearSolver *context, int x, int y, int z, int cagevert, int rhs_index)
 {
 	MDefBoundIsect *isect;
 	float rhs, weight, totweight;
@@ -1327,7 +1343,7 @@ static void meshdeform_matrix_add_rhs(MeshDeformBind *mdb, LinearSolver *context
 		if (isect) {
 			weight = (1.0f / isect->len) / totweight;
 			rhs = weight * meshdeform_boundary_phi(mdb, isect, cagevert);
-			EIG_linear_solver_right_hand_side_add(context, 0, mdb->varidx[acenter], rhs);
+			EIG_linear_solver_right_hand_side_add(context, rhs_index, mdb->varidx[acenter], rhs);
 		}
 	}
 }
@@ -1380,11 +1396,60 @@ static void meshdeform_matrix_add_exterior_phi(MeshDeformBind *mdb, int x, int y
 		mdb->phi[acenter] = phi / totweight;
 }
 
+static void meshdeform_inside_cage_task(
+        void *__restrict userdata,
+        const int a,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	MeshDeformBind *mdb = userdata;
+	float vec[3];
+
+	copy_v3_v3(vec, mdb->vertexcos[a]);
+	mdb->inside[a] = meshdeform_inside_cage(mdb, vec);
+}
+
+/* one z-slice of the grid, cells only write their own tag and intersections */
+static void meshdeform_add_intersections_task(
+        void *__restrict userdata,
+        const int z,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	MeshDeformBind *mdb = userdata;
+	int x, y;
+
+	for (y = 0; y < mdb->size; y++)
+		for (x = 0; x < mdb->size; x++)
+			meshdeform_add_intersections(mdb, x, y, z);
+}
+
+typedef struct MeshDeformWeightsData {
+	MeshDeformBind *mdb;
+	int cagevert;
+} MeshDeformWeightsData;
+
+static void meshdeform_interp_weights_task(
+        void *__restrict userdata,
+        const int b,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const MeshDeformWeightsData *data = userdata;
+	MeshDeformBind *mdb = data->mdb;
+	float vec[3], gridvec[3];
+
+	if (mdb->inside[b]) {
+		copy_v3_v3(vec, mdb->vertexcos[b]);
+		gridvec[0] = (vec[0] - mdb->min[0] - mdb->halfwidth[0]) / mdb->width[0];
+		gridvec[1] = (vec[1] - mdb->min[1] - mdb->halfwidth[1]) / mdb->width[1];
+		gridvec[2] = (vec[2] - mdb->min[2] - mdb->halfwidth[2]) / mdb->width[2];
+
+		mdb->weights[b * mdb->totcagevert + data->cagevert] = meshdeform_interp_w(mdb, gridvec, vec, data->cagevert);
+	}
+}
+
 static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind *mdb)
 {
 	LinearSolver *context;
-	float vec[3], gridvec[3];
-	int a, b, x, y, z, totvar;
+	int a, b, x, y, z, r, totvar;
 	char message[256];
 
 	/* setup variable indices */
@@ -1400,7 +1465,7 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
 	progress_bar(0, "Starting mesh deform solve");
 
 	/* setup linear solver */
-	context = EIG_linear_solver_new(totvar, totvar, 1);
+	context = EIG_linear_solver_new(totvar, totvar, MESHDEFORM_SOLVE_RHS);
 
 	/* build matrix */
 	for (z = 0; z < mdb->size; z++)
@@ -1408,55 +1473,64 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
 			for (x = 0; x < mdb->size; x++)
 				meshdeform_matrix_add_cell(mdb, context, x, y, z);
 
-	/* solve for each cage vert */
-	for (a = 0; a < mdb->totcagevert; a++) {
-		/* fill in right hand side and solve */
-		for (z = 0; z < mdb->size; z++)
-			for (y = 0; y < mdb->size; y++)
-				for (x = 0; x < mdb->size; x++)
-					meshdeform_matrix_add_rhs(mdb, context, x, y, z, a);
+	/* solve for several cage verts at once, sharing the passes over the factorization */
+	for (a = 0; a < mdb->totcagevert; a += MESHDEFORM_SOLVE_RHS) {
+		const int totrhs = min_ii(MESHDEFORM_SOLVE_RHS, mdb->totcagevert - a);
 
-		if (EIG_linear_solver_solve(context)) {
+		/* fill in right hand side and solve */
+		for (r = 0; r < totrhs; r++)
 			for (z = 0; z < mdb->size; z++)
 				for (y = 0; y < mdb->size; y++)
 					for (x = 0; x < mdb->size; x++)
-						meshdeform_matrix_add_semibound_phi(mdb, x, y, z, a);
+						meshdeform_matrix_add_rhs(mdb, context, x, y, z, a + r, r);
 
-			for (z = 0; z < mdb->size; z++)
-				for (y = 0; y < mdb->size; y++)
-					for (x = 0; x < mdb->size; x++)
-						meshdeform_matrix_add_exterior_phi(mdb, x, y, z, a);
+		if (EIG_linear_solver_solve(context)) {
+			for (r = 0; r < totrhs; r++) {
+				const int cagevert = a + r;
 
-			for (b = 0; b < mdb->size3; b++) {
-				if (mdb->tag[b] != MESHDEFORM_TAG_EXTERIOR)
-					mdb->phi[b] = EIG_linear_solver_variable_get(context, 0, mdb->varidx[b]);
-				mdb->totalphi[b] += mdb->phi[b];
-			}
+				for (z = 0; z < mdb->size; z++)
+					for (y = 0; y < mdb->size; y++)
+						for (x = 0; x < mdb->size; x++)
+							meshdeform_matrix_add_semibound_phi(mdb, x, y, z, cagevert);
 
-			if (mdb->weights) {
-				/* static bind : compute weights for each vertex */
-				for (b = 0; b < mdb->totvert; b++) {
-					if (mdb->inside[b]) {
-						copy_v3_v3(vec, mdb->vertexcos[b]);
-						gridvec[0] = (vec[0] - mdb->min[0] - mdb->halfwidth[0]) / mdb->width[0];
-						gridvec[1] = (vec[1] - mdb->min[1] - mdb->halfwidth[1]) / mdb->width[1];
-						gridvec[2] = (vec[2] - mdb->min[2] - mdb->halfwidth[2]) / mdb->width[2];
+				for (z = 0; z < mdb->size; z++)
+					for (y = 0; y < mdb->size; y++)
+						for (x = 0; x < mdb->size; x++)
+							meshdeform_matrix_add_exterior_phi(mdb, x, y, z, cagevert);
 
-						mdb->weights[b * mdb->totcagevert + a] = meshdeform_interp_w(mdb, gridvec, vec, a);
-					}
+				for (b = 0; b < mdb->size3; b++) {
+					if (mdb->tag[b] != MESHDEFORM_TAG_EXTERIOR)
+						mdb->phi[b] = EIG_linear_solver_variable_get(context, r, mdb->varidx[b]);
+					mdb->totalphi[b] += mdb->phi[b];
 				}
-			}
-			else {
-				MDefBindInfluence *inf;
 
-				/* dynamic bind */
-				for (b = 0; b < mdb->size3; b++) {
-					if (mdb->phi[b] >= MESHDEFORM_MIN_INFLUENCE) {
-						inf = BLI_memarena_alloc(mdb->memarena, sizeof(*inf));
-						inf->vertex = a;
-						inf->weight = mdb->phi[b];
-						inf->next = mdb->dyngrid[b];
-						mdb->dyngrid[b] = inf;
+				if (mdb->weights) {
+					/* static bind : compute weights for each vertex */
+					MeshDeformWeightsData data = {
+						.mdb = mdb,
+						.cagevert = cagevert,
+					};
+
+					ParallelRangeSettings settings;
+					BLI_parallel_range_settings_defaults(&settings);
+					settings.min_iter_per_thread = 1024;
+					BLI_task_parallel_range(0, mdb->totvert,
+					                        &data,
+					                        meshdeform_interp_weights_task,
+					                        &settings);
+				}
+				else {
+					MDefBindInfluence *inf;
+
+					/* dynamic bind */
+					for (b = 0; b < mdb->size3; b++) {
+						if (mdb->phi[b] >= MESHDEFORM_MIN_INFLUENCE) {
+							inf = BLI_memarena_alloc(mdb->memarena, sizeof(*inf));
+							inf->vertex = cagevert;
+							inf->weight = mdb->phi[b];
+							inf->next = mdb->dyngrid[b];
+							mdb->dyngrid[b] = inf;
+						}
 					}
 				}
 			}
@@ -1467,8 +1541,8 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
 			break;
 		}
 
-		BLI_snprintf(message, sizeof(message), "Mesh deform solve %d / %d       |||", a + 1, mdb->totcagevert);
-		progress_bar((float)(a + 1) / (float)(mdb->totcagevert), message);
+		BLI_snprintf(message, sizeof(message), "Mesh deform solve %d / %d       |||", a + totrhs, mdb->totcagevert);
+		progress_bar((float)(a + totrhs) / (float)(mdb->totcagevert), message);
 	}
 
 #if 0
@@ -1491,8 +1565,8 @@ static void harmonic_coordinates_bind(Scene *UNUSED(scene), MeshDeformModifierDa
 	MDefBindInfluence *inf;
 	MDefInfluence *mdinf;
 	MDefCell *cell;
-	float center[3], vec[3], maxwidth, totweight;
-	int a, b, x, y, z, totinside, offset;
+	float center[3], maxwidth, totweight;
+	int a, b, x, y, z, offset;
 
 	/* compute bounding box of the cage mesh */
 	INIT_MINMAX(mdb->min, mdb->max);
@@ -1518,6 +1592,7 @@ static void harmonic_coordinates_bind(Scene *UNUSED(scene), MeshDeformModifierDa
 
 	mdb->memarena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "harmonic coords arena");
 	BLI_memarena_use_calloc(mdb->memarena);
+	BLI_spin_init(&mdb->memarena_lock);
 
 	/* initialize data from 'cagedm' for reuse */
 	{
@@ -1550,27 +1625,25 @@ static void harmonic_coordinates_bind(Scene *UNUSED(scene), MeshDeformModifierDa
 
 	progress_bar(0, "Setting up mesh deform system");
 
-	totinside = 0;
-	for (a = 0; a < mdb->totvert; a++) {
-		copy_v3_v3(vec, mdb->vertexcos[a]);
-		mdb->inside[a] = meshdeform_inside_cage(mdb, vec);
-		if (mdb->inside[a])
-			totinside++;
-	}
-
-	/* free temporary MDefBoundIsects */
-	BLI_memarena_free(mdb->memarena);
-	mdb->memarena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "harmonic coords arena");
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 256;
+	BLI_task_parallel_range(0, mdb->totvert,
+	                        mdb,
+	                        meshdeform_inside_cage_task,
+	                        &settings);
 
 	/* start with all cells untyped */
 	for (a = 0; a < mdb->size3; a++)
 		mdb->tag[a] = MESHDEFORM_TAG_UNTYPED;
 	
 	/* detect intersections and tag boundary cells */
-	for (z = 0; z < mdb->size; z++)
-		for (y = 0; y < mdb->size; y++)
-			for (x = 0; x < mdb->size; x++)
-				meshdeform_add_intersections(mdb, x, y, z);
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 1;
+	BLI_task_parallel_range(0, mdb->size,
+	                        mdb,
+	                        meshdeform_add_intersections_task,
+	                        &settings);
 
 	/* compute exterior and interior tags */
 	meshdeform_bind_floodfill(mdb);
@@ -1633,6 +1706,7 @@ static void harmonic_coordinates_bind(Scene *UNUSED(scene), MeshDeformModifierDa
 	MEM_freeN(mdb->boundisect);
 	MEM_freeN(mdb->semibound);
 	BLI_memarena_free(mdb->memarena);
+	BLI_spin_end(&mdb->memarena_lock);
 	free_bvhtree_from_mesh(&mdb->bvhdata);
 }
 
@@ -244,6 +244,7 @@ int ED_object_modifier_convert(struct ReportList *reports, struct Main *bmain, s
 int ED_object_modifier_apply(struct ReportList *reports, struct Depsgraph *depsgraph, struct Scene *scene,
                              struct Object *ob, struct ModifierData *md, int mode);
 int ED_object_modifier_copy(struct ReportList *reports, struct Object *ob, struct ModifierData *md);
+bool ED_object_modifier_type_affects_other_objects(int type);
 
 bool ED_object_iter_other(
         struct Main *bmain, struct Object *orig_ob, const bool include_orig,
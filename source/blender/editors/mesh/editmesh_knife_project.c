@@ -66,7 +66,7 @@ static LinkNode *knifeproject_poly_from_object(const bContext *C, Scene *scene,
 	bool dm_needsFree;
 
 	if (ob->type == OB_MESH || ob->derivedFinal) {
-		dm = ob->derivedFinal ? ob->derivedFinal : mesh_get_derived_final(depsgraph, scene, ob, CD_MASK_BAREMESH);
+		dm = ob->derivedFinal ? object_get_derived_final_realized(ob) : mesh_get_derived_final(depsgraph, scene, ob, CD_MASK_BAREMESH);
 		dm_needsFree = false;
 	}
 	else if (ELEM(ob->type, OB_FONT, OB_CURVE, OB_SURF)) {
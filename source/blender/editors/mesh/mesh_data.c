@@ -986,6 +986,8 @@ void ED_mesh_update(Mesh *mesh, bContext *C, int calc_edges, int calc_tessface)
 		BKE_mesh_tessface_clear(mesh);
 	}
 
+	/* loops may have been written in place, e.g. with foreach_set() */
+	BKE_mesh_vert_loop_map_clear(mesh);
 	BKE_mesh_calc_normals(mesh);
 
 	DEG_id_tag_update(&mesh->id, 0);
@@ -83,6 +83,7 @@
 #include "BKE_material.h"
 #include "BKE_mball.h"
 #include "BKE_mesh.h"
+#include "BKE_modifier.h"
 #include "BKE_nla.h"
 #include "BKE_object.h"
 #include "BKE_particle.h"
@@ -1409,6 +1410,8 @@ static void make_object_duplilist_real(bContext *C, Scene *scene, Base *base,
 	ListBase *lb_duplis;
 	DupliObject *dob;
 	GHash *dupli_gh, *parent_gh = NULL;
+	ModifierData *md_instanced;
+	int md_instanced_index;
 
 	if (!(base->object->transflag & OB_DUPLI)) {
 		return;
@@ -1416,6 +1419,11 @@ static void make_object_duplilist_real(bContext *C, Scene *scene, Base *base,
 
 	lb_duplis = object_duplilist(depsgraph, scene, base->object);
 
+	/* array instances are copies of the object itself, which then keep
+	 * their geometry once the modifier generating them is removed */
+	md_instanced = (ModifierData *)modifiers_findInstancedArray(base->object);
+	md_instanced_index = md_instanced ? BLI_findindex(&base->object->modifiers, md_instanced) : -1;
+
 	dupli_gh = BLI_ghash_ptr_new(__func__);
 	if (use_hierarchy) {
 		if (base->object->transflag & OB_DUPLIGROUP) {
@@ -1458,6 +1466,10 @@ static void make_object_duplilist_real(bContext *C, Scene *scene, Base *base,
 		ob_dst->curve_cache = NULL;
 		ob_dst->transflag &= ~OB_DUPLI;
 
+		if ((dob->type == OB_DUPLIARRAY) && (md_instanced_index != -1)) {
+			ED_object_modifier_remove(NULL, bmain, ob_dst, BLI_findlink(&ob_dst->modifiers, md_instanced_index));
+		}
+
 		copy_m4_m4(ob_dst->obmat, dob->mat);
 		BKE_object_apply_mat4(ob_dst, ob_dst->obmat, false, false);
 
@@ -1556,6 +1568,10 @@ static void make_object_duplilist_real(bContext *C, Scene *scene, Base *base,
 
 	BKE_main_id_clear_newpoins(bmain);
 
+	if (md_instanced) {
+		ED_object_modifier_remove(NULL, bmain, base->object, md_instanced);
+	}
+
 	base->object->transflag &= ~OB_DUPLI;
 }
 
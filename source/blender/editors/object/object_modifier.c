@@ -96,6 +96,26 @@ static void modifier_skin_customdata_delete(struct Object *ob);
 
 /******************************** API ****************************/
 
+/* Collision, particle and similar modifiers are looked up by other objects when
+ * their relations are built, changing those needs all relations to be rebuilt.
+ */
+bool ED_object_modifier_type_affects_other_objects(int type)
+{
+	return ELEM(type,
+	            eModifierType_Collision, eModifierType_Surface, eModifierType_ParticleSystem,
+	            eModifierType_DynamicPaint, eModifierType_Smoke, eModifierType_Fluidsim);
+}
+
+static void object_modifier_relations_tag_update(Main *bmain, Object *ob, bool affects_other_objects)
+{
+	if (affects_other_objects) {
+		DEG_relations_tag_update(bmain);
+	}
+	else {
+		DEG_id_relations_tag_update(bmain, &ob->id);
+	}
+}
+
 ModifierData *ED_object_modifier_add(ReportList *reports, Main *bmain, Scene *scene, Object *ob, const char *name, int type)
 {
 	ModifierData *md = NULL, *new_md = NULL;
@@ -175,7 +195,7 @@ ModifierData *ED_object_modifier_add(ReportList *reports, Main *bmain, Scene *sc
 	}
 
 	DEG_id_tag_update(&ob->id, OB_RECALC_DATA);
-	DEG_relations_tag_update(bmain);
+	object_modifier_relations_tag_update(bmain, ob, ED_object_modifier_type_affects_other_objects(type));
 
 	return new_md;
 }
@@ -323,7 +343,9 @@ static bool object_modifier_remove(Main *bmain, Object *ob, ModifierData *md,
 		ob->mode &= ~OB_MODE_PARTICLE_EDIT;
 	}
 
-	DEG_relations_tag_update(bmain);
+	if (ED_object_modifier_type_affects_other_objects(md->type)) {
+		*r_sort_depsgraph = true;
+	}
 
 	BLI_remlink(&ob->modifiers, md);
 	modifier_free(md);
@@ -345,7 +367,7 @@ bool ED_object_modifier_remove(ReportList *reports, Main *bmain, Object *ob, Mod
 	}
 
 	DEG_id_tag_update(&ob->id, OB_RECALC_DATA);
-	DEG_relations_tag_update(bmain);
+	object_modifier_relations_tag_update(bmain, ob, sort_depsgraph);
 
 	return 1;
 }
@@ -369,7 +391,7 @@ void ED_object_modifier_clear(Main *bmain, Object *ob)
 	}
 
 	DEG_id_tag_update(&ob->id, OB_RECALC_DATA);
-	DEG_relations_tag_update(bmain);
+	object_modifier_relations_tag_update(bmain, ob, sort_depsgraph);
 }
 
 int ED_object_modifier_move_up(ReportList *reports, Object *ob, ModifierData *md)
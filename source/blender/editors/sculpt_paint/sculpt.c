@@ -5046,6 +5046,10 @@ static void sculpt_stroke_done(const bContext *C, struct PaintStroke *UNUSED(str
 		if (BKE_pbvh_type(ss->pbvh) == PBVH_BMESH)
 			BKE_pbvh_bmesh_after_stroke(ss->pbvh);
 
+		/* free vertex data kept by draw buffers for in place updates */
+		BKE_pbvh_draw_buffers_data_free(ss->pbvh);
+		BKE_mesh_batch_cache_dirty(ob->data, BKE_MESH_BATCH_DIRTY_SCULPT_STROKE_DONE);
+
 		/* optimization: if there is locked key and active modifiers present in */
 		/* the stack, keyblock is updating at each step. otherwise we could update */
 		/* keyblock only when stroke is finished */
@@ -172,7 +172,8 @@ static void iter_snap_objects(
 		{
 			bool use_obedit;
 			Object *obj = base->object;
-			if (obj->transflag & OB_DUPLI) {
+			/* array instances are part of the object's final derived mesh here */
+			if ((obj->transflag & OB_DUPLI) && !(obj->transflag & OB_DUPLIARRAY)) {
 				DupliObject *dupli_ob;
 				ListBase *lb = object_duplilist(sctx->depsgraph, sctx->scene, obj);
 				for (dupli_ob = lb->first; dupli_ob; dupli_ob = dupli_ob->next) {
@@ -48,6 +48,8 @@ enum {
 	GPU_SHADER_FLAGS_NONE = 0,
 	GPU_SHADER_FLAGS_SPECIAL_OPENSUBDIV = (1 << 0),
 	GPU_SHADER_FLAGS_NEW_SHADING        = (1 << 1),
+	/* Program binary can be read back with GPU_shader_binary_get. */
+	GPU_SHADER_FLAGS_BINARY_RETRIEVABLE = (1 << 2),
 };
 
 GPUShader *GPU_shader_create(
@@ -65,6 +67,10 @@ GPUShader *GPU_shader_create_ex(
         const int flags);
 void GPU_shader_free(GPUShader *shader);
 
+bool GPU_shader_binary_support(void);
+GPUShader *GPU_shader_create_from_binary(const void *binary, const int binary_len, const unsigned int binary_format);
+void *GPU_shader_binary_get(GPUShader *shader, int *r_binary_len, unsigned int *r_binary_format);
+
 void GPU_shader_bind(GPUShader *shader);
 void GPU_shader_unbind(void);
 
@@ -125,9 +125,17 @@ static void gpu_material_diffuse_get(int UNUSED(nr), float diff[4])
 }
 
 /* Allocates a non-initialized buffer to be sent to GPU.
+ * When \a r_is_reused is given the buffer keeps its data, if the vertex count
+ * did not change the data of the previous update is reused and is only
+ * partially sent to the GPU, see #gpu_pbvh_vert_update. The data is kept
+ * until the end of the stroke, see #GPU_pbvh_buffers_data_free.
  * Return is false it indicates that the memory map failed. */
-static bool gpu_pbvh_vert_buf_data_set(GPU_PBVH_Buffers *buffers, unsigned int vert_ct)
+static bool gpu_pbvh_vert_buf_data_set(GPU_PBVH_Buffers *buffers, unsigned int vert_ct, bool *r_is_reused)
 {
+	if (r_is_reused) {
+		*r_is_reused = false;
+	}
+
 	if (buffers->vert_buf == NULL) {
 		/* Initialize vertex buffer */
 		/* match 'VertexBufferFormat' */
@@ -146,13 +154,39 @@ static bool gpu_pbvh_vert_buf_data_set(GPU_PBVH_Buffers *buffers, unsigned int v
 		GWN_vertbuf_data_resize(buffers->vert_buf, vert_ct);
 	}
 #else
-		buffers->vert_buf = GWN_vertbuf_create_with_format_ex(&format, GWN_USAGE_STATIC);
+		buffers->vert_buf = GWN_vertbuf_create_with_format_ex(
+		        &format, r_is_reused ? GWN_USAGE_DYNAMIC : GWN_USAGE_STATIC);
+	}
+	else if (r_is_reused && buffers->vert_buf->data && buffers->vert_buf->vertex_ct == vert_ct) {
+		*r_is_reused = true;
+		return true;
+	}
+	else if (r_is_reused) {
+		/* data was freed after the last stroke, see #GPU_pbvh_buffers_data_free */
+		GWN_vertbuf_usage_set(buffers->vert_buf, GWN_USAGE_DYNAMIC);
 	}
 	GWN_vertbuf_data_alloc(buffers->vert_buf, vert_ct);
 #endif
 	return buffers->vert_buf->data != NULL;
 }
 
+/* Write a vertex attribute. For a reused buffer \a dirty_range is given,
+ * unchanged values are skipped so only the range of modified vertices
+ * has to be uploaded. */
+static void gpu_pbvh_vert_update(
+        Gwn_VertBufRaw *raw, unsigned int v_idx, const void *value, unsigned int *dirty_range)
+{
+	GLubyte *elem = raw->data_init + raw->stride * v_idx;
+	if (dirty_range == NULL) {
+		memcpy(elem, value, raw->size);
+	}
+	else if (memcmp(elem, value, raw->size) != 0) {
+		memcpy(elem, value, raw->size);
+		dirty_range[0] = MIN2(dirty_range[0], v_idx);
+		dirty_range[1] = MAX2(dirty_range[1], v_idx + 1);
+	}
+}
+
 static void gpu_pbvh_batch_init(GPU_PBVH_Buffers *buffers)
 {
 	/* force flushing to the GPU */
@@ -237,16 +271,29 @@ void GPU_pbvh_mesh_buffers_update(
 		uchar diffuse_color_ub[4];
 		rgba_float_to_uchar(diffuse_color_ub, diffuse_color);
 
+		/* Smooth-shaded buffers are updated in place, strokes usually
+		 * only modify a part of the vertices of a node. */
+		bool is_reused = false;
+
 		/* Build VBO */
-		if (gpu_pbvh_vert_buf_data_set(buffers, totelem)) {
+		if (gpu_pbvh_vert_buf_data_set(buffers, totelem, buffers->smooth ? &is_reused : NULL)) {
 			/* Vertex data is shared if smooth-shaded, but separate
 			 * copies are made for flat shading because normals
 			 * shouldn't be shared. */
 			if (buffers->smooth) {
+				Gwn_VertBufRaw pos_step, nor_step, col_step;
+				unsigned int dirty_range_buf[2] = {UINT_MAX, 0};
+				unsigned int *dirty_range = is_reused ? dirty_range_buf : NULL;
+
+				/* A new allocation is entirely uploaded anyway. */
+				GWN_vertbuf_attr_get_raw_data_ex(buffers->vert_buf, g_vbo_id.pos, &pos_step, !is_reused);
+				GWN_vertbuf_attr_get_raw_data_ex(buffers->vert_buf, g_vbo_id.nor, &nor_step, !is_reused);
+				GWN_vertbuf_attr_get_raw_data_ex(buffers->vert_buf, g_vbo_id.col, &col_step, !is_reused);
+
 				for (uint i = 0; i < totvert; ++i) {
 					const MVert *v = &mvert[vert_indices[i]];
-					GWN_vertbuf_attr_set(buffers->vert_buf, g_vbo_id.pos, i, v->co);
-					GWN_vertbuf_attr_set(buffers->vert_buf, g_vbo_id.nor, i, v->no);
+					gpu_pbvh_vert_update(&pos_step, i, v->co, dirty_range);
+					gpu_pbvh_vert_update(&nor_step, i, v->no, dirty_range);
 				}
 
 				for (uint i = 0; i < buffers->face_indices_len; i++) {
@@ -257,13 +304,17 @@ void GPU_pbvh_mesh_buffers_update(
 							int v_index = buffers->mloop[lt->tri[j]].v;
 							uchar color_ub[3];
 							gpu_color_from_mask_copy(vmask[v_index], diffuse_color, color_ub);
-							GWN_vertbuf_attr_set(buffers->vert_buf, g_vbo_id.col, vidx, color_ub);
+							gpu_pbvh_vert_update(&col_step, vidx, color_ub, dirty_range);
 						}
 						else {
-							GWN_vertbuf_attr_set(buffers->vert_buf, g_vbo_id.col, vidx, diffuse_color_ub);
+							gpu_pbvh_vert_update(&col_step, vidx, diffuse_color_ub, dirty_range);
 						}
 					}
 				}
+
+				if (is_reused && dirty_range[0] < dirty_range[1]) {
+					GWN_vertbuf_dirty_range_tag(buffers->vert_buf, dirty_range[0], dirty_range[1] - dirty_range[0]);
+				}
 			}
 			else {
 				/* calculate normal for each polygon only once */
@@ -430,7 +481,7 @@ void GPU_pbvh_grid_buffers_update(
 
 		uint vbo_index_offset = 0;
 		/* Build VBO */
-		if (gpu_pbvh_vert_buf_data_set(buffers, totgrid * key->grid_area)) {
+		if (gpu_pbvh_vert_buf_data_set(buffers, totgrid * key->grid_area, NULL)) {
 			for (i = 0; i < totgrid; ++i) {
 				CCGElem *grid = grids[grid_indices[i]];
 				int vbo_index = vbo_index_offset;
@@ -814,7 +865,7 @@ void GPU_pbvh_bmesh_buffers_update(
 	copy_v4_v4(buffers->diffuse_color, diffuse_color);
 
 	/* Fill vertex buffer */
-	if (gpu_pbvh_vert_buf_data_set(buffers, totvert)) {
+	if (gpu_pbvh_vert_buf_data_set(buffers, totvert, NULL)) {
 		int v_index = 0;
 
 		if (buffers->smooth) {
@@ -999,6 +1050,15 @@ bool GPU_pbvh_buffers_mask_changed(GPU_PBVH_Buffers *buffers, bool show_mask)
 	return (buffers->show_mask != show_mask);
 }
 
+/* Free the vertex data kept for in place updates, once it is uploaded.
+ * The next update allocates and keeps it again. */
+void GPU_pbvh_buffers_data_free(GPU_PBVH_Buffers *buffers)
+{
+	if (buffers->vert_buf && buffers->vert_buf->usage == GWN_USAGE_DYNAMIC) {
+		GWN_vertbuf_usage_set(buffers->vert_buf, GWN_USAGE_STATIC);
+	}
+}
+
 void GPU_pbvh_buffers_free(GPU_PBVH_Buffers *buffers)
 {
 	if (buffers) {
@@ -44,6 +44,13 @@
 #include "BLI_utildefines.h"
 #include "BLI_dynstr.h"
 #include "BLI_ghash.h"
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
+#include "BLI_system.h"
+#include BLI_SYSTEM_PID_H
+
+#include "BKE_appdir.h"
+#include "BKE_global.h"
 
 #include "PIL_time.h"
 
@@ -58,8 +65,11 @@
 
 #include "gpu_codegen.h"
 
+#include "atomic_ops.h"
+
 #include <string.h>
 #include <stdarg.h>
+#include <time.h>
 
 extern char datatoc_gpu_shader_material_glsl[];
 extern char datatoc_gpu_shader_vertex_glsl[];
@@ -77,10 +87,11 @@ static char *glsl_material_library = NULL;
 
 static LinkNode *pass_cache = NULL; /* GPUPass */
 
-static uint32_t gpu_pass_hash(const char *vert, const char *geom, const char *frag, const char *defs)
+static uint32_t gpu_pass_hash_ex(
+        const char *vert, const char *geom, const char *frag, const char *defs, uint32_t seed)
 {
 	BLI_HashMurmur2A hm2a;
-	BLI_hash_mm2a_init(&hm2a, 0);
+	BLI_hash_mm2a_init(&hm2a, seed);
 	BLI_hash_mm2a_add(&hm2a, (unsigned char *)frag, strlen(frag));
 	BLI_hash_mm2a_add(&hm2a, (unsigned char *)vert, strlen(vert));
 	if (defs)
@@ -91,6 +102,11 @@ static uint32_t gpu_pass_hash(const char *vert, const char *geom, const char *fr
 	return BLI_hash_mm2a_end(&hm2a);
 }
 
+static uint32_t gpu_pass_hash(const char *vert, const char *geom, const char *frag, const char *defs)
+{
+	return gpu_pass_hash_ex(vert, geom, frag, defs, 0);
+}
+
 /* Search by hash then by exact string match. */
 static GPUPass *gpu_pass_cache_lookup(
         const char *vert, const char *geom, const char *frag, const char *defs, uint32_t hash)
@@ -111,6 +127,163 @@ static GPUPass *gpu_pass_cache_lookup(
 	return NULL;
 }
 
+/* -------------------- GPUPass Disk Cache ------------------ */
+/**
+ * Program binaries of generated shaders, kept between sessions so opening a
+ * file doesn't recompile all of its materials. Binaries are only valid for the
+ * driver which created them. Files are named after the driver and two
+ * independent hashes of the GLSL code, cache files which were not used for
+ * #GPU_PASS_DISK_CACHE_MAX_AGE are removed on startup.
+ *
+ * Note that --debug-gpu-shaders only dumps shaders which are compiled.
+ **/
+
+#define GPU_PASS_DISK_CACHE_VERSION 1
+#define GPU_PASS_DISK_CACHE_MAX_AGE (30 * 24 * 60 * 60) /* seconds */
+#define GPU_PASS_DISK_CACHE_SOURCE_SEED 0x9747b28c
+
+typedef struct GPUPassDiskHeader {
+	char id[4];
+	uint32_t version;
+	uint32_t source_len;
+	uint32_t binary_format;
+	uint32_t binary_len;
+} GPUPassDiskHeader;
+
+static struct {
+	bool use;
+	uint32_t driver_hash;
+	char dirpath[FILE_MAX];
+} pass_disk_cache = {false};
+
+static void gpu_pass_disk_cache_prune(void)
+{
+	struct direntry *filelist;
+	const unsigned int filelist_len = BLI_filelist_dir_contents(pass_disk_cache.dirpath, &filelist);
+	const time_t now = time(NULL);
+
+	for (unsigned int i = 0; i < filelist_len; i++) {
+		const struct direntry *file = &filelist[i];
+		/* Also remove temporary files left by instances which didn't finish writing. */
+		if (S_ISREG(file->type) &&
+		    (BLI_testextensie(file->relname, ".bin") || BLI_testextensie(file->relname, "@")) &&
+		    (now - file->s.st_mtime > GPU_PASS_DISK_CACHE_MAX_AGE))
+		{
+			BLI_delete(file->path, false, false);
+		}
+	}
+
+	BLI_filelist_free(filelist, filelist_len);
+}
+
+/* Main thread only, needs an OpenGL context. */
+static void gpu_pass_disk_cache_init(void)
+{
+	pass_disk_cache.use = false;
+
+	if (!GPU_shader_binary_support()) {
+		return;
+	}
+
+	const char *dirpath = BKE_appdir_folder_id_create(BLENDER_USER_DATAFILES, "shader_cache");
+	if (dirpath == NULL) {
+		return;
+	}
+	BLI_strncpy(pass_disk_cache.dirpath, dirpath, sizeof(pass_disk_cache.dirpath));
+
+	const char *driver[] = {
+	    (const char *)glGetString(GL_VENDOR),
+	    (const char *)glGetString(GL_RENDERER),
+	    (const char *)glGetString(GL_VERSION),
+	};
+	BLI_HashMurmur2A hm2a;
+	BLI_hash_mm2a_init(&hm2a, GPU_PASS_DISK_CACHE_VERSION);
+	for (int i = 0; i < ARRAY_SIZE(driver); i++) {
+		if (driver[i]) {
+			BLI_hash_mm2a_add(&hm2a, (const unsigned char *)driver[i], strlen(driver[i]));
+		}
+	}
+	pass_disk_cache.driver_hash = BLI_hash_mm2a_end(&hm2a);
+	pass_disk_cache.use = true;
+
+	gpu_pass_disk_cache_prune();
+}
+
+static void gpu_pass_disk_cache_filepath(char filepath[FILE_MAX], uint32_t hash, uint32_t source_hash)
+{
+	char filename[64];
+	BLI_snprintf(filename, sizeof(filename), "%08x_%08x%08x.bin",
+	             pass_disk_cache.driver_hash, hash, source_hash);
+	BLI_join_dirfile(filepath, FILE_MAX, pass_disk_cache.dirpath, filename);
+}
+
+static GPUShader *gpu_pass_disk_cache_load(uint32_t hash, uint32_t source_hash, uint32_t source_len)
+{
+	char filepath[FILE_MAX];
+	size_t size;
+
+	gpu_pass_disk_cache_filepath(filepath, hash, source_hash);
+	char *mem = BLI_file_read_binary_as_mem(filepath, 0, &size);
+	if (mem == NULL) {
+		return NULL;
+	}
+
+	GPUShader *shader = NULL;
+	GPUPassDiskHeader header;
+	if (size >= sizeof(header)) {
+		memcpy(&header, mem, sizeof(header));
+		if (STREQLEN(header.id, "GPUB", sizeof(header.id)) &&
+		    (header.version == GPU_PASS_DISK_CACHE_VERSION) &&
+		    (header.source_len == source_len) &&
+		    (header.binary_len == size - sizeof(header)))
+		{
+			shader = GPU_shader_create_from_binary(mem + sizeof(header), header.binary_len, header.binary_format);
+		}
+	}
+	MEM_freeN(mem);
+
+	if (shader) {
+		/* Keep it from being pruned. */
+		BLI_file_touch(filepath);
+	}
+	return shader;
+}
+
+static void gpu_pass_disk_cache_store(GPUShader *shader, uint32_t hash, uint32_t source_hash, uint32_t source_len)
+{
+	GPUPassDiskHeader header = {
+		.id = {'G', 'P', 'U', 'B'},
+		.version = GPU_PASS_DISK_CACHE_VERSION,
+		.source_len = source_len,
+	};
+	int binary_len;
+	void *binary = GPU_shader_binary_get(shader, &binary_len, &header.binary_format);
+	if (binary == NULL) {
+		return;
+	}
+	header.binary_len = (uint32_t)binary_len;
+
+	/* Write to a temporary file first, other instances may be reading. The name
+	 * is unique to this process and call, other instances and threads may be
+	 * storing the same pass. */
+	static unsigned int tmp_counter = 0;
+	char filepath[FILE_MAX], filepath_tmp[FILE_MAX];
+	gpu_pass_disk_cache_filepath(filepath, hash, source_hash);
+	BLI_snprintf(filepath_tmp, sizeof(filepath_tmp), "%s.%d.%u@", filepath,
+	             abs(getpid()), atomic_add_and_fetch_u(&tmp_counter, 1));
+
+	FILE *fp = BLI_fopen(filepath_tmp, "wb");
+	if (fp) {
+		const bool ok = ((fwrite(&header, sizeof(header), 1, fp) == 1) &&
+		                 (fwrite(binary, (size_t)binary_len, 1, fp) == 1));
+		fclose(fp);
+		if (!ok || BLI_rename(filepath_tmp, filepath) != 0) {
+			BLI_delete(filepath_tmp, false, false);
+		}
+	}
+	MEM_freeN(binary);
+}
+
 /* -------------------- GPU Codegen ------------------ */
 
 /* type definitions and constants */
@@ -332,6 +505,7 @@ static GPUFunction *gpu_lookup_function(const char *name)
 void gpu_codegen_init(void)
 {
 	GPU_code_generate_glsl_lib();
+	gpu_pass_disk_cache_init();
 }
 
 void gpu_codegen_exit(void)
@@ -1862,6 +2036,7 @@ GPUPass *GPU_generate_pass_new(
 	char *vertexcode, *geometrycode, *fragmentcode;
 	GPUShader *shader;
 	GPUPass *pass;
+	const double time_start = PIL_check_seconds_timer();
 
 	/* prune unused nodes */
 	GPU_nodes_prune(nodes, frag_outlink);
@@ -1879,6 +2054,8 @@ GPUPass *GPU_generate_pass_new(
 	MEM_freeN(fragmentgen);
 	MEM_freeN(tmp);
 
+	const double time_codegen = PIL_check_seconds_timer();
+
 	/* Cache lookup: Reuse shaders already compiled */
 	uint32_t hash = gpu_pass_hash(vertexcode, geometrycode, fragmentcode, defines);
 	pass = gpu_pass_cache_lookup(vertexcode, geometrycode, fragmentcode, defines, hash);
@@ -1892,12 +2069,46 @@ GPUPass *GPU_generate_pass_new(
 		MEM_SAFE_FREE(geometrycode);
 	}
 	else {
-		/* Cache miss. (Re)compile the shader. */
-		shader = GPU_shader_create(vertexcode,
-		                           fragmentcode,
-		                           geometrycode,
-		                           NULL,
-		                           defines);
+		/* Cache miss. Load the shader from disk or (re)compile it. */
+		bool from_disk = false;
+		shader = NULL;
+
+		if (pass_disk_cache.use) {
+			const uint32_t source_hash = gpu_pass_hash_ex(
+			        vertexcode, geometrycode, fragmentcode, defines, GPU_PASS_DISK_CACHE_SOURCE_SEED);
+			const uint32_t source_len = (uint32_t)(
+			        strlen(vertexcode) + strlen(fragmentcode) +
+			        (geometrycode ? strlen(geometrycode) : 0) + (defines ? strlen(defines) : 0));
+
+			shader = gpu_pass_disk_cache_load(hash, source_hash, source_len);
+			from_disk = (shader != NULL);
+
+			if (shader == NULL) {
+				shader = GPU_shader_create_ex(vertexcode,
+				                              fragmentcode,
+				                              geometrycode,
+				                              NULL,
+				                              defines,
+				                              GPU_SHADER_FLAGS_BINARY_RETRIEVABLE);
+				if (shader) {
+					gpu_pass_disk_cache_store(shader, hash, source_hash, source_len);
+				}
+			}
+		}
+		else {
+			shader = GPU_shader_create(vertexcode,
+			                           fragmentcode,
+			                           geometrycode,
+			                           NULL,
+			                           defines);
+		}
+
+		if (G.debug & G_DEBUG_GPU_SHADERS) {
+			printf("GPUPass %08x: codegen %.2f ms, %s %.2f ms\n", hash,
+			       (time_codegen - time_start) * 1000.0,
+			       from_disk ? "load" : "compile",
+			       (PIL_check_seconds_timer() - time_codegen) * 1000.0);
+		}
 
 		/* We still create a pass even if shader compilation
 		 * fails to avoid trying to compile again and again. */
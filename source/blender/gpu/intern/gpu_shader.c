@@ -328,7 +328,6 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 #ifdef WITH_OPENSUBDIV
 	bool use_opensubdiv = (flags & GPU_SHADER_FLAGS_SPECIAL_OPENSUBDIV) != 0;
 #else
-	UNUSED_VARS(flags);
 	bool use_opensubdiv = false;
 #endif
 	GLint status;
@@ -469,6 +468,10 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 	}
 #endif
 
+	if ((flags & GPU_SHADER_FLAGS_BINARY_RETRIEVABLE) && GPU_shader_binary_support()) {
+		glProgramParameteri(shader->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
 	glLinkProgram(shader->program);
 	glGetProgramiv(shader->program, GL_LINK_STATUS, &status);
 	if (!status) {
@@ -509,6 +512,76 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 	return shader;
 }
 
+/**
+ * Program binaries are only valid for the driver which created them,
+ * the driver can also reject them at any time (e.g. after an update).
+ */
+bool GPU_shader_binary_support(void)
+{
+	if (!GLEW_ARB_get_program_binary) {
+		return false;
+	}
+	GLint format_len = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_len);
+	return (format_len > 0);
+}
+
+/**
+ * Create a shader from a binary of #GPU_shader_binary_get,
+ * returns NULL when the driver rejects the binary.
+ */
+GPUShader *GPU_shader_create_from_binary(const void *binary, const int binary_len, const unsigned int binary_format)
+{
+	GLint status;
+	GPUShader *shader = MEM_callocN(sizeof(GPUShader), "GPUShader");
+
+	shader->program = glCreateProgram();
+	if (!shader->program) {
+		fprintf(stderr, "GPUShader, object creation failed.\n");
+		GPU_shader_free(shader);
+		return NULL;
+	}
+
+	glProgramBinary(shader->program, binary_format, binary, binary_len);
+	glGetProgramiv(shader->program, GL_LINK_STATUS, &status);
+	if (!status) {
+		GPU_shader_free(shader);
+		return NULL;
+	}
+
+	shader->interface = GWN_shaderinterface_create(shader->program);
+
+	return shader;
+}
+
+/**
+ * Returns the program binary of a shader created with #GPU_SHADER_FLAGS_BINARY_RETRIEVABLE,
+ * NULL when not supported. The binary must be freed by the caller.
+ */
+void *GPU_shader_binary_get(GPUShader *shader, int *r_binary_len, unsigned int *r_binary_format)
+{
+	BLI_assert(shader && shader->program);
+
+	GLint binary_len = 0;
+	glGetProgramiv(shader->program, GL_PROGRAM_BINARY_LENGTH, &binary_len);
+	if (binary_len <= 0) {
+		return NULL;
+	}
+
+	void *binary = MEM_mallocN((size_t)binary_len, __func__);
+	GLenum binary_format;
+	GLsizei length = 0;
+	glGetProgramBinary(shader->program, binary_len, &length, &binary_format, binary);
+	if (length <= 0) {
+		MEM_freeN(binary);
+		return NULL;
+	}
+
+	*r_binary_len = length;
+	*r_binary_format = binary_format;
+	return binary;
+}
+
 #undef DEBUG_SHADER_GEOMETRY
 #undef DEBUG_SHADER_FRAGMENT
 #undef DEBUG_SHADER_VERTEX
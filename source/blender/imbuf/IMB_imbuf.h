@@ -394,6 +394,19 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum IMB_ScaleFilter {
+	IMB_SCALE_FILTER_BOX      = 0, /* area average when downscaling, nearest when upscaling */
+	IMB_SCALE_FILTER_BILINEAR = 1,
+	IMB_SCALE_FILTER_MITCHELL = 2, /* bicubic, B = C = 1/3 */
+	IMB_SCALE_FILTER_LANCZOS  = 3, /* sharpest, can ring at hard edges */
+} IMB_ScaleFilter;
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, IMB_ScaleFilter filter);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -0,0 +1,55 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2018 by Blender Foundation.
+ * All rights reserved.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ *
+ */
+
+#ifndef __IMB_CONVERSION_INTERN_H__
+#define __IMB_CONVERSION_INTERN_H__
+
+/** \file IMB_conversion_intern.h
+ *  \ingroup imbuf
+ *
+ * Per row kernels of the RGBA pixel conversions in divers.c and filter.c.
+ * The public functions use the SSE2 version when available, the scalar
+ * version is kept as reference.
+ */
+
+#include "BLI_sys_types.h"
+
+/* divers.c */
+void imb_float_to_byte_row(
+        uchar *to, const float *from, int width, bool to_srgb, bool predivide,
+        float dither, float inv_width, float t);
+void imb_byte_to_float_row(float *to, const uchar *from, int width);
+
+/* filter.c */
+void imb_premultiply_float_row(float *rect_float, size_t width);
+
+#ifdef __SSE2__
+void imb_float_to_byte_row_sse(
+        uchar *to, const float *from, int width, bool to_srgb, bool predivide,
+        float dither, float inv_width, float t);
+void imb_byte_to_float_row_sse(float *to, const uchar *from, int width);
+void imb_premultiply_float_row_sse(float *rect_float, size_t width);
+#endif
+
+#endif  /* __IMB_CONVERSION_INTERN_H__ */
@@ -1460,17 +1460,8 @@ static void *do_display_buffer_apply_thread(void *handle_v)
 		if (display_buffer) {
 			memcpy(display_buffer, linear_buffer, ((size_t)width) * height * channels * sizeof(float));
 
-			if (is_straight_alpha && channels == 4) {
-				const size_t i_last = ((size_t)width) * height;
-				size_t i;
-				float *fp;
-
-				for (i = 0, fp = display_buffer;
-				     i != i_last;
-				     i++, fp += channels)
-				{
-					straight_to_premul_v4(fp);
-				}
+			if (is_straight_alpha) {
+				IMB_premultiply_rect_float(display_buffer, channels, width, height);
 			}
 		}
 
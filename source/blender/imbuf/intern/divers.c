@@ -31,6 +31,8 @@
  *  \ingroup imbuf
  */
 
+#include <string.h>
+
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 
@@ -38,6 +40,7 @@
 #include "IMB_imbuf_types.h"
 #include "IMB_imbuf.h"
 #include "IMB_filter.h"
+#include "IMB_conversion_intern.h"
 
 #include "IMB_colormanagement.h"
 #include "IMB_colormanagement_intern.h"
@@ -161,6 +164,148 @@ MINLINE void float_to_byte_dither_v4(uchar b[4], const float f[4], DitherContext
 	b[3] = FTOCHAR(f[3]);
 }
 
+/* Convert a row of RGBA float pixels to bytes, optionally converting linear to sRGB,
+ * unpremultiplying and dithering. */
+void imb_float_to_byte_row(
+        uchar *to, const float *from, int width, bool to_srgb, bool predivide,
+        float dither, float inv_width, float t)
+{
+	DitherContext di = {dither};
+	unsigned short us[4];
+	float straight[4];
+	int x;
+
+	for (x = 0; x < width; x++, from += 4, to += 4) {
+		const float *pixel = from;
+
+		if (predivide) {
+			premul_to_straight_v4_v4(straight, from);
+			pixel = straight;
+		}
+
+		if (to_srgb) {
+			linearrgb_to_srgb_ushort4(us, pixel);
+			if (dither)
+				ushort_to_byte_dither_v4(to, us, &di, (float) x * inv_width, t);
+			else
+				ushort_to_byte_v4(to, us);
+		}
+		else {
+			if (dither)
+				float_to_byte_dither_v4(to, pixel, &di, (float) x * inv_width, t);
+			else
+				rgba_float_to_uchar(to, pixel);
+		}
+	}
+}
+
+/* Convert a row of RGBA byte pixels to float without color space conversion. */
+void imb_byte_to_float_row(float *to, const uchar *from, int width)
+{
+	int x;
+
+	for (x = 0; x < width; x++, from += 4, to += 4)
+		rgba_uchar_to_float(to, from);
+}
+
+#ifdef __SSE2__
+
+/* SSE2 kernels, process one RGBA pixel per register. Rounding matches FTOCHAR. */
+
+MALWAYS_INLINE __m128i float_to_byte_int_sse(const __m128 v)
+{
+	const __m128 clamped = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+/* Convert a premultiplied pixel to straight alpha, pixels with zero alpha are left untouched. */
+MALWAYS_INLINE __m128 premul_to_straight_sse(const __m128 v)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	const __m128 alpha = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+	const __m128 is_zero = _mm_cmpeq_ps(alpha, _mm_setzero_ps());
+	const __m128 inv_alpha = _mm_div_ps(one, _bli_math_blend_sse(is_zero, one, alpha));
+	return _mm_mul_ps(v, _bli_math_blend_sse(alpha_mask, one, inv_alpha));
+}
+
+MALWAYS_INLINE __m128 float_to_byte_pixel_prepare_sse(
+        const float from[4], const bool to_srgb, const bool predivide,
+        DitherContext *di, float s, float t)
+{
+	const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	__m128 v = _mm_loadu_ps(from);
+
+	if (predivide) {
+		v = premul_to_straight_sse(v);
+	}
+	if (to_srgb) {
+		v = _bli_math_blend_sse(alpha_mask, v, linearrgb_to_srgb_v4_simd(v));
+	}
+	if (di) {
+		const float dither_value = dither_random_value(s, t) * 0.005f * di->dither;
+		v = _mm_add_ps(v, _mm_set_ps(0.0f, dither_value, dither_value, dither_value));
+	}
+	return v;
+}
+
+/* SSE2 version of #imb_float_to_byte_row, four pixels are packed and stored at once. */
+void imb_float_to_byte_row_sse(
+        uchar *to, const float *from, int width, bool to_srgb, bool predivide,
+        float dither, float inv_width, float t)
+{
+	DitherContext di_dither = {dither};
+	DitherContext *di = dither ? &di_dither : NULL;
+	int x = 0;
+
+	for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+		const __m128i i0 = float_to_byte_int_sse(
+		        float_to_byte_pixel_prepare_sse(from, to_srgb, predivide, di, (float)x * inv_width, t));
+		const __m128i i1 = float_to_byte_int_sse(
+		        float_to_byte_pixel_prepare_sse(from + 4, to_srgb, predivide, di, (float)(x + 1) * inv_width, t));
+		const __m128i i2 = float_to_byte_int_sse(
+		        float_to_byte_pixel_prepare_sse(from + 8, to_srgb, predivide, di, (float)(x + 2) * inv_width, t));
+		const __m128i i3 = float_to_byte_int_sse(
+		        float_to_byte_pixel_prepare_sse(from + 12, to_srgb, predivide, di, (float)(x + 3) * inv_width, t));
+
+		_mm_storeu_si128((__m128i *)to, _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3)));
+	}
+
+	for (; x < width; x++, from += 4, to += 4) {
+		const __m128i i0 = float_to_byte_int_sse(
+		        float_to_byte_pixel_prepare_sse(from, to_srgb, predivide, di, (float)x * inv_width, t));
+		const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(i0, i0), _mm_setzero_si128());
+		const int rgba = _mm_cvtsi128_si32(packed);
+
+		memcpy(to, &rgba, sizeof(rgba));
+	}
+}
+
+/* SSE2 version of #imb_byte_to_float_row. */
+void imb_byte_to_float_row_sse(float *to, const uchar *from, int width)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+	const __m128i zero = _mm_setzero_si128();
+	int x = 0;
+
+	for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i *)from);
+		const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+		_mm_storeu_ps(to, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+		_mm_storeu_ps(to + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+		_mm_storeu_ps(to + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+		_mm_storeu_ps(to + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+	}
+
+	for (; x < width; x++, from += 4, to += 4) {
+		rgba_uchar_to_float(to, from);
+	}
+}
+
+#endif  /* __SSE2__ */
+
 /* float to byte pixels, output 4-channel RGBA */
 void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
                                 int channels_from, float dither, int profile_to, int profile_from, bool predivide,
@@ -224,62 +369,13 @@ void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
 			const float *from = rect_from + ((size_t)stride_from) * y * 4;
 			uchar *to = rect_to + ((size_t)stride_to) * y * 4;
 
-			if (profile_to == profile_from) {
-				float straight[4];
-
-				/* no color space conversion */
-				if (dither && predivide) {
-					for (x = 0; x < width; x++, from += 4, to += 4) {
-						premul_to_straight_v4_v4(straight, from);
-						float_to_byte_dither_v4(to, straight, di, (float) x * inv_width, t);
-					}
-				}
-				else if (dither) {
-					for (x = 0; x < width; x++, from += 4, to += 4)
-						float_to_byte_dither_v4(to, from, di, (float) x * inv_width, t);
-				}
-				else if (predivide) {
-					for (x = 0; x < width; x++, from += 4, to += 4) {
-						premul_to_straight_v4_v4(straight, from);
-						rgba_float_to_uchar(to, straight);
-					}
-				}
-				else {
-					for (x = 0; x < width; x++, from += 4, to += 4)
-						rgba_float_to_uchar(to, from);
-				}
-			}
-			else if (profile_to == IB_PROFILE_SRGB) {
-				/* convert from linear to sRGB */
-				unsigned short us[4];
-				float straight[4];
-
-				if (dither && predivide) {
-					for (x = 0; x < width; x++, from += 4, to += 4) {
-						premul_to_straight_v4_v4(straight, from);
-						linearrgb_to_srgb_ushort4(us, from);
-						ushort_to_byte_dither_v4(to, us, di, (float) x * inv_width, t);
-					}
-				}
-				else if (dither) {
-					for (x = 0; x < width; x++, from += 4, to += 4) {
-						linearrgb_to_srgb_ushort4(us, from);
-						ushort_to_byte_dither_v4(to, us, di, (float) x * inv_width, t);
-					}
-				}
-				else if (predivide) {
-					for (x = 0; x < width; x++, from += 4, to += 4) {
-						premul_to_straight_v4_v4(straight, from);
-						linearrgb_to_srgb_ushort4(us, from);
-						ushort_to_byte_v4(to, us);
-					}
-				}
-				else {
-					for (x = 0; x < width; x++, from += 4, to += 4) {
-						linearrgb_to_srgb_ushort4(us, from);
-						ushort_to_byte_v4(to, us);
-					}
-				}
+			if (profile_to == profile_from || profile_to == IB_PROFILE_SRGB) {
+				/* no color space conversion, or convert from linear to sRGB */
+#ifdef __SSE2__
+				imb_float_to_byte_row_sse(to, from, width, profile_to != profile_from, predivide, dither, inv_width, t);
+#else
+				imb_float_to_byte_row(to, from, width, profile_to != profile_from, predivide, dither, inv_width, t);
+#endif
 			}
 			else if (profile_to == IB_PROFILE_LINEAR_RGB) {
 				/* convert from sRGB to linear */
@@ -412,8 +508,11 @@ void IMB_buffer_float_from_byte(float *rect_to, const uchar *rect_from,
 
 		if (profile_to == profile_from) {
 			/* no color space conversion */
-			for (x = 0; x < width; x++, from += 4, to += 4)
-				rgba_uchar_to_float(to, from);
+#ifdef __SSE2__
+			imb_byte_to_float_row_sse(to, from, width);
+#else
+			imb_byte_to_float_row(to, from, width);
+#endif
 		}
 		else if (profile_to == IB_PROFILE_LINEAR_RGB) {
 			/* convert sRGB to linear */
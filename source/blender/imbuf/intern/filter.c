@@ -33,11 +33,13 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_math_base.h"
 #include "BLI_utildefines.h"
 
 #include "IMB_imbuf_types.h"
 #include "IMB_imbuf.h"
 #include "IMB_filter.h"
+#include "IMB_conversion_intern.h"
 
 #include "imbuf.h"
 
@@ -610,21 +612,44 @@ void IMB_premultiply_rect(unsigned int *rect, char planes, int w, int h)
 	}
 }
 
-void IMB_premultiply_rect_float(float *rect_float, int channels, int w, int h)
+void imb_premultiply_float_row(float *rect_float, size_t width)
 {
-	float val, *cp;
-	int x, y;
+	float val, *cp = rect_float;
+	size_t a;
+
+	for (a = width; a; a--, cp += 4) {
+		val = cp[3];
+		cp[0] = cp[0] * val;
+		cp[1] = cp[1] * val;
+		cp[2] = cp[2] * val;
+	}
+}
+
+#ifdef __SSE2__
+/* SSE2 version of #imb_premultiply_float_row. */
+void imb_premultiply_float_row_sse(float *rect_float, size_t width)
+{
+	const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	const __m128 one = _mm_set1_ps(1.0f);
+	float *cp = rect_float;
+	size_t a;
+
+	for (a = width; a; a--, cp += 4) {
+		const __m128 v = _mm_loadu_ps(cp);
+		const __m128 alpha = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+		_mm_storeu_ps(cp, _mm_mul_ps(v, _bli_math_blend_sse(alpha_mask, one, alpha)));
+	}
+}
+#endif
 
+void IMB_premultiply_rect_float(float *rect_float, int channels, int w, int h)
+{
 	if (channels == 4) {
-		cp = rect_float;
-		for (y = 0; y < h; y++) {
-			for (x = 0; x < w; x++, cp += 4) {
-				val = cp[3];
-				cp[0] = cp[0] * val;
-				cp[1] = cp[1] * val;
-				cp[2] = cp[2] * val;
-			}
-		}
+#ifdef __SSE2__
+		imb_premultiply_float_row_sse(rect_float, ((size_t)w) * h);
+#else
+		imb_premultiply_float_row(rect_float, ((size_t)w) * h);
+#endif
 	}
 
 }
@@ -1125,7 +1125,7 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
 
 				struct ImBuf *s_ibuf = IMB_dupImBuf(tmp_ibuf);
 
-				IMB_scalefastImBuf(s_ibuf, x, y);
+				IMB_scaleImBuf_filter(s_ibuf, x, y, IMB_SCALE_FILTER_BOX);
 
 				IMB_convert_rgba_to_abgr(s_ibuf);
 	
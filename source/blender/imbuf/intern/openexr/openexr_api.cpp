@@ -561,6 +561,8 @@ int imb_save_openexr(struct ImBuf *ibuf, const char *name, int flags)
  */
 
 static ListBase exrhandles = {NULL, NULL};
+/* handles can be created and closed from different threads, e.g. compositor file output */
+static ThreadMutex exrhandles_mutex = BLI_MUTEX_INITIALIZER;
 
 typedef struct ExrHandle {
 	struct ExrHandle *next, *prev;
@@ -622,7 +624,7 @@ typedef struct ExrLayer {
 
 /* ********************** */
 
-void *IMB_exr_get_handle(void)
+static ExrHandle *imb_exr_handle_new(void)
 {
 	ExrHandle *data = (ExrHandle *)MEM_callocN(sizeof(ExrHandle), "exr handle");
 	data->multiView = new StringVector();
@@ -631,14 +633,25 @@ void *IMB_exr_get_handle(void)
 	return data;
 }
 
+void *IMB_exr_get_handle(void)
+{
+	BLI_mutex_lock(&exrhandles_mutex);
+	ExrHandle *data = imb_exr_handle_new();
+	BLI_mutex_unlock(&exrhandles_mutex);
+	return data;
+}
+
 void *IMB_exr_get_handle_name(const char *name)
 {
+	/* keep the lock while creating, so two threads can't both add the same name */
+	BLI_mutex_lock(&exrhandles_mutex);
 	ExrHandle *data = (ExrHandle *) BLI_rfindstring(&exrhandles, name, offsetof(ExrHandle, name));
 
 	if (data == NULL) {
-		data = (ExrHandle *)IMB_exr_get_handle();
+		data = imb_exr_handle_new();
 		BLI_strncpy(data->name, name, strlen(name) + 1);
 	}
+	BLI_mutex_unlock(&exrhandles_mutex);
 	return data;
 }
 
@@ -1111,6 +1124,10 @@ void IMB_exrtile_write_channels(void *handle, int partx, int party, int level, c
 	}
 }
 
+/**
+ * Read the channels which have a buffer set with #IMB_exr_set_channel, channels without
+ * a buffer are skipped. This allows to load a single pass of a multilayer file.
+ */
 void IMB_exr_read_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
@@ -1131,6 +1148,7 @@ void IMB_exr_read_channels(void *handle)
 		/* Insert all matching channel into framebuffer. */
 		FrameBuffer frameBuffer;
 		ExrChannel *echan;
+		int totchan = 0;
 
 		for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
 			if (echan->m->part_number != i) {
@@ -1157,12 +1175,18 @@ void IMB_exr_read_channels(void *handle)
 				}
 
 				frameBuffer.insert(echan->m->internal_name, Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+				totchan++;
 			}
 			else
-				printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
+				exr_printf("channel with no rect set, skipped %s\n", echan->m->internal_name.c_str());
+		}
+
+		/* Nothing requested from this part, don't decode it. */
+		if (totchan == 0) {
+			continue;
 		}
 
-		/* Read pixels. */
+		/* Read pixels. Decompression is spread over the OpenEXR global thread pool. */
 		try {
 			in.setFrameBuffer(frameBuffer);
 			exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, dw.min.y, dw.max.y);
@@ -1246,7 +1270,9 @@ void IMB_exr_close(void *handle)
 	}
 	BLI_freelistN(&data->layers);
 
+	BLI_mutex_lock(&exrhandles_mutex);
 	BLI_remlink(&exrhandles, data);
+	BLI_mutex_unlock(&exrhandles_mutex);
 	MEM_freeN(data);
 }
 
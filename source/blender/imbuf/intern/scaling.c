@@ -32,7 +32,10 @@
  */
 
 
+#include <string.h>
+
 #include "BLI_utildefines.h"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
 #include "MEM_guardedalloc.h"
@@ -1775,3 +1778,356 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
 		ibuf->rect_float = init_data.float_buffer;
 	}
 }
+
+/* ******** filtered scaling ******** */
+
+/* Separable resampling, the image is filtered horizontally into an intermediate
+ * float buffer and then vertically into the new buffers. Byte buffers are
+ * premultiplied while filtering so transparent pixels don't bleed their color. */
+
+typedef struct ScaleFilterWeights {
+	/* first source sample of each target sample */
+	int *first;
+	/* taps weights per target sample, normalized */
+	float *weights;
+	int taps;
+} ScaleFilterWeights;
+
+static float scale_filter_radius(IMB_ScaleFilter filter)
+{
+	switch (filter) {
+		case IMB_SCALE_FILTER_BOX:
+			return 0.5f;
+		case IMB_SCALE_FILTER_BILINEAR:
+			return 1.0f;
+		case IMB_SCALE_FILTER_MITCHELL:
+			return 2.0f;
+		case IMB_SCALE_FILTER_LANCZOS:
+			return 3.0f;
+	}
+	return 1.0f;
+}
+
+static float scale_filter_eval(IMB_ScaleFilter filter, float x)
+{
+	x = fabsf(x);
+
+	switch (filter) {
+		case IMB_SCALE_FILTER_BOX:
+			return (x <= 0.5f) ? 1.0f : 0.0f;
+		case IMB_SCALE_FILTER_BILINEAR:
+			return (x < 1.0f) ? 1.0f - x : 0.0f;
+		case IMB_SCALE_FILTER_MITCHELL:
+		{
+			/* Mitchell-Netravali with B = C = 1/3 */
+			const float B = 1.0f / 3.0f, C = 1.0f / 3.0f;
+			if (x < 1.0f) {
+				return ((12.0f - 9.0f * B - 6.0f * C) * x * x * x +
+				        (-18.0f + 12.0f * B + 6.0f * C) * x * x +
+				        (6.0f - 2.0f * B)) / 6.0f;
+			}
+			else if (x < 2.0f) {
+				return ((-B - 6.0f * C) * x * x * x +
+				        (6.0f * B + 30.0f * C) * x * x +
+				        (-12.0f * B - 48.0f * C) * x +
+				        (8.0f * B + 24.0f * C)) / 6.0f;
+			}
+			return 0.0f;
+		}
+		case IMB_SCALE_FILTER_LANCZOS:
+		{
+			const float a = 3.0f;
+			if (x < 1e-6f) {
+				return 1.0f;
+			}
+			else if (x < a) {
+				const float px = (float)M_PI * x;
+				return a * sinf(px) * sinf(px / a) / (px * px);
+			}
+			return 0.0f;
+		}
+	}
+	return 0.0f;
+}
+
+/* Precompute the filter weights of all target samples along one axis. When
+ * downscaling the filter is widened to cover all source samples. */
+static void scale_filter_weights_init(ScaleFilterWeights *sfw, IMB_ScaleFilter filter, int src_len, int dst_len)
+{
+	const float scale = (float)src_len / (float)dst_len;
+	const float fscale = max_ff(scale, 1.0f);
+	const float support = scale_filter_radius(filter) * fscale;
+	int i, j;
+
+	sfw->taps = min_ii((int)ceilf(2.0f * support) + 1, src_len);
+	sfw->first = MEM_mallocN(sizeof(int) * dst_len, "scale filter first");
+	sfw->weights = MEM_mallocN(sizeof(float) * dst_len * sfw->taps, "scale filter weights");
+
+	for (i = 0; i < dst_len; i++) {
+		const float center = ((float)i + 0.5f) * scale;
+		const int first = CLAMPIS((int)floorf(center - support), 0, src_len - sfw->taps);
+		float *w = sfw->weights + i * sfw->taps;
+		float sum = 0.0f;
+
+		for (j = 0; j < sfw->taps; j++) {
+			w[j] = scale_filter_eval(filter, ((float)(first + j) + 0.5f - center) / fscale);
+			sum += w[j];
+		}
+
+		if (sum != 0.0f) {
+			const float sum_inv = 1.0f / sum;
+			for (j = 0; j < sfw->taps; j++) {
+				w[j] *= sum_inv;
+			}
+		}
+		else {
+			/* can only happen for degenerate sizes, use the nearest sample */
+			const int nearest = CLAMPIS((int)center - first, 0, sfw->taps - 1);
+			for (j = 0; j < sfw->taps; j++) {
+				w[j] = (j == nearest) ? 1.0f : 0.0f;
+			}
+		}
+
+		sfw->first[i] = first;
+	}
+}
+
+static void scale_filter_weights_free(ScaleFilterWeights *sfw)
+{
+	MEM_freeN(sfw->first);
+	MEM_freeN(sfw->weights);
+}
+
+typedef struct ScaleFilterData {
+	ScaleFilterWeights wx, wy;
+	int channels;
+	int oldx, newx;
+
+	/* source, only one of them is set */
+	const unsigned char *src_byte;
+	const float *src_float;
+
+	/* horizontally filtered, premultiplied float, oldy rows of newx pixels */
+	float *tmp;
+
+	/* target, only one of them is set */
+	unsigned char *dst_byte;
+	float *dst_float;
+} ScaleFilterData;
+
+static void scale_filter_row(const ScaleFilterWeights *wx, const float *in, float *out, int channels, int newx)
+{
+	const float *w = wx->weights;
+	int x, k, c;
+
+#ifdef __SSE2__
+	if (channels == 4) {
+		for (x = 0; x < newx; x++, w += wx->taps, out += 4) {
+			const float *pixel = in + ((size_t)wx->first[x]) * 4;
+			__m128 acc = _mm_setzero_ps();
+
+			for (k = 0; k < wx->taps; k++, pixel += 4) {
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(pixel)));
+			}
+			_mm_storeu_ps(out, acc);
+		}
+		return;
+	}
+#endif
+
+	for (x = 0; x < newx; x++, w += wx->taps, out += channels) {
+		const float *pixel = in + ((size_t)wx->first[x]) * channels;
+
+		for (c = 0; c < channels; c++) {
+			out[c] = 0.0f;
+		}
+		for (k = 0; k < wx->taps; k++, pixel += channels) {
+			for (c = 0; c < channels; c++) {
+				out[c] += w[k] * pixel[c];
+			}
+		}
+	}
+}
+
+/* out += w * in, for row_len floats */
+static void scale_filter_madd_row(float *out, const float *in, float w, size_t row_len)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	const __m128 w4 = _mm_set1_ps(w);
+	for (; i + 4 <= row_len; i += 4) {
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(w4, _mm_loadu_ps(in + i))));
+	}
+#endif
+
+	for (; i < row_len; i++) {
+		out[i] += w * in[i];
+	}
+}
+
+static void scale_filter_horizontal_thread(void *custom_data, int start_scanline, int num_scanlines)
+{
+	ScaleFilterData *data = custom_data;
+	float *row_float = NULL;
+	int y, x;
+
+	if (data->src_byte) {
+		row_float = MEM_mallocN(sizeof(float) * 4 * data->oldx, "scale filter row");
+	}
+
+	for (y = start_scanline; y < start_scanline + num_scanlines; y++) {
+		const float *in;
+
+		if (data->src_byte) {
+			const unsigned char *cp = data->src_byte + ((size_t)y) * data->oldx * 4;
+			for (x = 0; x < data->oldx; x++, cp += 4) {
+				straight_uchar_to_premul_float(row_float + x * 4, cp);
+			}
+			in = row_float;
+		}
+		else {
+			in = data->src_float + ((size_t)y) * data->oldx * data->channels;
+		}
+
+		scale_filter_row(&data->wx, in, data->tmp + ((size_t)y) * data->newx * data->channels,
+		                 data->channels, data->newx);
+	}
+
+	if (row_float) {
+		MEM_freeN(row_float);
+	}
+}
+
+static void scale_filter_vertical_thread(void *custom_data, int start_scanline, int num_scanlines)
+{
+	ScaleFilterData *data = custom_data;
+	const size_t row_len = ((size_t)data->newx) * data->channels;
+	float *row_float = NULL;
+	int y, x, k;
+
+	if (data->dst_byte) {
+		row_float = MEM_mallocN(sizeof(float) * row_len, "scale filter row");
+	}
+
+	for (y = start_scanline; y < start_scanline + num_scanlines; y++) {
+		const float *w = data->wy.weights + y * data->wy.taps;
+		const float *in = data->tmp + data->wy.first[y] * row_len;
+		float *out = (row_float) ? row_float : data->dst_float + y * row_len;
+
+		memset(out, 0, sizeof(float) * row_len);
+		for (k = 0; k < data->wy.taps; k++, in += row_len) {
+			if (w[k] != 0.0f) {
+				scale_filter_madd_row(out, in, w[k], row_len);
+			}
+		}
+
+		if (data->dst_byte) {
+			unsigned char *cp = data->dst_byte + y * row_len;
+			for (x = 0; x < data->newx; x++, cp += 4) {
+				premul_float_to_straight_uchar(cp, row_float + x * 4);
+			}
+		}
+	}
+
+	if (row_float) {
+		MEM_freeN(row_float);
+	}
+}
+
+static void scale_filter_buffer(ScaleFilterData *data, int oldy, int newy)
+{
+	data->tmp = MEM_mallocN(sizeof(float) * data->channels * data->newx * oldy, "scale filter buffer");
+
+	IMB_processor_apply_threaded_scanlines(oldy, scale_filter_horizontal_thread, data);
+	IMB_processor_apply_threaded_scanlines(newy, scale_filter_vertical_thread, data);
+
+	MEM_freeN(data->tmp);
+	data->tmp = NULL;
+}
+
+/**
+ * Resample \a ibuf using \a filter, byte and float buffers are both scaled.
+ * Scaling is multi-threaded, a size of 0 keeps that dimension unchanged.
+ * When downscaling the buffers are resampled in place, only the intermediate
+ * horizontally filtered image is allocated.
+ *
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, IMB_ScaleFilter filter)
+{
+	ScaleFilterData data = {{NULL}};
+	bool in_place;
+
+	if (ibuf == NULL) return false;
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return false;
+
+	if (newx == 0) newx = ibuf->x;
+	if (newy == 0) newy = ibuf->y;
+
+	if (newx == ibuf->x && newy == ibuf->y) {
+		return false;
+	}
+
+	/* The horizontal pass reads all of the source before the vertical pass writes any
+	 * output, so when the result fits the source buffer is reused for it. */
+	in_place = ((size_t)newx) * newy <= ((size_t)ibuf->x) * ibuf->y;
+
+	/* the Z-buffer is sampled, filtering depth makes no sense */
+	scalefast_Z_ImBuf(ibuf, newx, newy);
+
+	scale_filter_weights_init(&data.wx, filter, ibuf->x, newx);
+	scale_filter_weights_init(&data.wy, filter, ibuf->y, newy);
+	data.oldx = ibuf->x;
+	data.newx = newx;
+
+	if (ibuf->rect) {
+		const size_t size_new = sizeof(unsigned char) * 4 * newx * newy;
+
+		data.channels = 4;
+		data.src_byte = (unsigned char *)ibuf->rect;
+		data.dst_byte = (in_place && (ibuf->mall & IB_rect)) ?
+		                (unsigned char *)ibuf->rect : MEM_mallocN(size_new, "scale filter byte buffer");
+
+		scale_filter_buffer(&data, ibuf->y, newy);
+
+		if (data.dst_byte == data.src_byte) {
+			ibuf->rect = MEM_reallocN(ibuf->rect, size_new);
+		}
+		else {
+			imb_freerectImBuf(ibuf);
+			ibuf->mall |= IB_rect;
+			ibuf->rect = (unsigned int *)data.dst_byte;
+		}
+
+		data.src_byte = NULL;
+		data.dst_byte = NULL;
+	}
+
+	if (ibuf->rect_float) {
+		const size_t size_new = sizeof(float) * ibuf->channels * newx * newy;
+
+		data.channels = ibuf->channels;
+		data.src_float = ibuf->rect_float;
+		data.dst_float = (in_place && (ibuf->mall & IB_rectfloat)) ?
+		                 ibuf->rect_float : MEM_mallocN(size_new, "scale filter float buffer");
+
+		scale_filter_buffer(&data, ibuf->y, newy);
+
+		if (data.dst_float == data.src_float) {
+			ibuf->rect_float = MEM_reallocN(ibuf->rect_float, size_new);
+		}
+		else {
+			imb_freerectfloatImBuf(ibuf);
+			ibuf->mall |= IB_rectfloat;
+			ibuf->rect_float = data.dst_float;
+		}
+	}
+
+	scale_filter_weights_free(&data.wx);
+	scale_filter_weights_free(&data.wy);
+
+	ibuf->x = newx;
+	ibuf->y = newy;
+	return true;
+}
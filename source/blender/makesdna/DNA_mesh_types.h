@@ -70,6 +70,13 @@ typedef struct MeshRuntime {
 	struct EditMeshData *edit_data;
 	void *batch_cache;
 
+	/* MeshElemMap of vertex loops and its memory, kept while topology is
+	 * unchanged, see BKE_mesh_vert_loop_map_ensure() */
+	void *vert_loop_map;
+	void *vert_loop_map_mem;
+	void *vert_loop_map_mloop, *vert_loop_map_mpoly;
+	int vert_loop_map_totvert, vert_loop_map_totloop;
+
 	uint64_t cd_dirty_vert;
 	uint64_t cd_dirty_edge;
 	uint64_t cd_dirty_loop;
@@ -139,6 +139,8 @@ typedef struct SubsurfModifierData {
 	short use_opensubdiv, pad[3];
 
 	void *emCache, *mCache;
+	/* runtime, CustomDataInterpPlan of the loop data, kept while the topology doesn't change */
+	void *loopPlanCache;
 } SubsurfModifierData;
 
 typedef struct LatticeModifierData {
@@ -245,6 +247,7 @@ typedef struct ArrayModifierData {
 	int offset_type;
 	/* general flags:
 	 * MOD_ARR_MERGE -> merge vertices in adjacent duplicates
+	 * MOD_ARR_INSTANCE -> output duplicates as instances of the mesh when possible
 	 */
 	int flags;
 	/* the number of duplicates to generate for MOD_ARR_FIXEDCOUNT */
@@ -270,6 +273,7 @@ enum {
 enum {
 	MOD_ARR_MERGE      = (1 << 0),
 	MOD_ARR_MERGEFINAL = (1 << 1),
+	MOD_ARR_INSTANCE   = (1 << 2),
 };
 
 typedef struct MirrorModifierData {
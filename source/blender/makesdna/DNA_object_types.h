@@ -55,6 +55,7 @@ struct SoftBody;
 struct FluidsimSettings;
 struct ParticleSystem;
 struct DerivedMesh;
+struct ObjectArrayInstances;
 struct SculptSession;
 struct bGPdata;
 struct RigidBodyOb;
@@ -270,7 +271,8 @@ typedef struct Object {
 	struct FluidsimSettings *fluidsimSettings; /* if fluidsim enabled, store additional settings */
 
 	struct DerivedMesh *derivedDeform, *derivedFinal;
-	void *pad7;
+	/* Runtime copies of derivedFinal output as instances by the array modifier, see OB_DUPLIARRAY */
+	struct ObjectArrayInstances *array_instances;
 	uint64_t lastDataMask;   /* the custom data layer mask that was last used to calculate derivedDeform and derivedFinal */
 	uint64_t customdata_mask; /* (extra) custom data layer mask to use for creating derivedmesh, set by depsgraph */
 
@@ -405,8 +407,10 @@ enum {
 };
 
 /* (short) transflag */
-/* flags 1 and 2 were unused or relics from past features */
+/* flags 1 and 2 were unused or relics from past features,
+ * 2 is re-used for a runtime flag which is cleared on file read */
 enum {
+	OB_DUPLIARRAY       = 1 << 1,  /* runtime, array modifier outputs its copies as instances */
 	OB_NEG_SCALE        = 1 << 2,
 	OB_DUPLIFRAMES      = 1 << 3,
 	OB_DUPLIVERTS       = 1 << 4,
@@ -421,7 +425,8 @@ enum {
 	OB_NO_CONSTRAINTS   = 1 << 13,  /* runtime constraints disable */
 	OB_NO_PSYS_UPDATE   = 1 << 14,  /* hack to work around particle issue */
 
-	OB_DUPLI            = OB_DUPLIFRAMES | OB_DUPLIVERTS | OB_DUPLIGROUP | OB_DUPLIFACES | OB_DUPLIPARTS,
+	OB_DUPLI            = OB_DUPLIFRAMES | OB_DUPLIVERTS | OB_DUPLIGROUP | OB_DUPLIFACES | OB_DUPLIPARTS |
+	                      OB_DUPLIARRAY,
 };
 
 /* (short) trackflag / upflag */
@@ -151,6 +151,17 @@ static void rna_Depsgraph_debug_stats_gnuplot(Depsgraph *depsgraph,
 	fclose(f);
 }
 
+static void rna_Depsgraph_debug_trace_chrome(Depsgraph *depsgraph,
+                                             const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == NULL) {
+		return;
+	}
+	DEG_debug_eval_trace_chrome(depsgraph, f);
+	fclose(f);
+}
+
 static void rna_Depsgraph_debug_tag_update(Depsgraph *depsgraph)
 {
 	DEG_graph_tag_relations_update(depsgraph);
@@ -369,6 +380,13 @@ static void rna_def_depsgraph(BlenderRNA *brna)
 	                                "File name where gnuplot script will save the result");
 	RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
 
+	func = RNA_def_function(srna, "debug_trace_chrome", "rna_Depsgraph_debug_trace_chrome");
+	RNA_def_function_ui_description(func, "Save timing of the last evaluation in Chrome's trace format, "
+	                                "requires evaluation time debugging to be enabled (--debug-depsgraph-time)");
+	parm = RNA_def_string_file_path(func, "filename", NULL, FILE_MAX, "File Name",
+	                                "File in which to store the trace");
+	RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
 	func = RNA_def_function(srna, "debug_tag_update", "rna_Depsgraph_debug_tag_update");
 
 	func = RNA_def_function(srna, "debug_stats", "rna_Depsgraph_debug_stats");
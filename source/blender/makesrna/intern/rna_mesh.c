@@ -444,6 +444,7 @@ static void rna_MeshPolygon_flip(ID *id, MPoly *mp)
 
 	BKE_mesh_polygon_flip(mp, me->mloop, &me->ldata);
 	BKE_mesh_tessface_clear(me);
+	BKE_mesh_vert_loop_map_clear(me);
 }
 
 static void rna_MeshTessFace_normal_get(PointerRNA *ptr, float *values)
@@ -1353,6 +1354,16 @@ static int rna_MeshLoop_index_get(PointerRNA *ptr)
 	return (int)(mloop - me->mloop);
 }
 
+static void rna_MeshLoop_vertex_index_set(PointerRNA *ptr, int value)
+{
+	Mesh *me = rna_mesh(ptr);
+	MLoop *mloop = (MLoop *)ptr->data;
+
+	mloop->v = (unsigned int)value;
+	/* loops are edited in place, which the vertex to loop map can't detect */
+	BKE_mesh_vert_loop_map_clear(me);
+}
+
 /* path construction */
 
 static char *rna_VertexGroupElement_path(PointerRNA *ptr)
@@ -2124,6 +2135,7 @@ static void rna_def_mloop(BlenderRNA *brna)
 
 	prop = RNA_def_property(srna, "vertex_index", PROP_INT, PROP_UNSIGNED);
 	RNA_def_property_int_sdna(prop, NULL, "v");
+	RNA_def_property_int_funcs(prop, NULL, "rna_MeshLoop_vertex_index_set", NULL);
 	RNA_def_property_ui_text(prop, "Vertex", "Vertex index");
 
 	prop = RNA_def_property(srna, "edge_index", PROP_INT, PROP_UNSIGNED);
@@ -205,6 +205,7 @@ static void rna_Mesh_flip_normals(Mesh *mesh)
 {
 	BKE_mesh_polygons_flip(mesh->mpoly, mesh->mloop, &mesh->ldata, mesh->totpoly);
 	BKE_mesh_tessface_clear(mesh);
+	BKE_mesh_vert_loop_map_clear(mesh);
 	BKE_mesh_calc_normals(mesh);
 
 	DEG_id_tag_update(&mesh->id, 0);
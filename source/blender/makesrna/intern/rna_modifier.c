@@ -294,6 +294,8 @@ const EnumPropertyItem rna_enum_axis_flag_xyz_items[] = {
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
 
+#include "ED_object.h"
+
 #ifdef WITH_ALEMBIC
 #  include "ABC_alembic.h"
 #endif
@@ -461,8 +463,17 @@ static void rna_Modifier_update(Main *UNUSED(bmain), Scene *UNUSED(scene), Point
 
 static void rna_Modifier_dependency_update(Main *bmain, Scene *scene, PointerRNA *ptr)
 {
+	ModifierData *md = ptr->data;
+
 	rna_Modifier_update(bmain, scene, ptr);
-	DEG_relations_tag_update(bmain);
+
+	/* other objects look these modifiers up when building their own relations */
+	if (ED_object_modifier_type_affects_other_objects(md->type)) {
+		DEG_relations_tag_update(bmain);
+	}
+	else {
+		DEG_id_relations_tag_update(bmain, ptr->id.data);
+	}
 }
 
 /* Vertex Groups */
@@ -795,7 +806,7 @@ static void rna_CurveModifier_dependency_update(Main *bmain, Scene *scene, Point
 {
 	CurveModifierData *cmd = (CurveModifierData *)ptr->data;
 	rna_Modifier_update(bmain, scene, ptr);
-	DEG_relations_tag_update(bmain);
+	DEG_id_relations_tag_update(bmain, ptr->id.data);
 	if (cmd->object != NULL) {
 		Curve *curve = cmd->object->data;
 		if ((curve->flag & CU_PATH) == 0) {
@@ -808,7 +819,7 @@ static void rna_ArrayModifier_dependency_update(Main *bmain, Scene *scene, Point
 {
 	ArrayModifierData *amd = (ArrayModifierData *)ptr->data;
 	rna_Modifier_update(bmain, scene, ptr);
-	DEG_relations_tag_update(bmain);
+	DEG_id_relations_tag_update(bmain, ptr->id.data);
 	if (amd->curve_ob != NULL) {
 		Curve *curve = amd->curve_ob->data;
 		if ((curve->flag & CU_PATH) == 0) {
@@ -2124,6 +2135,13 @@ static void rna_def_modifier_array(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Merge Distance", "Limit below which to merge vertices");
 	RNA_def_property_update(prop, 0, "rna_Modifier_update");
 
+	prop = RNA_def_property(srna, "use_instancing", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flags", MOD_ARR_INSTANCE);
+	RNA_def_property_ui_text(prop, "Instancing",
+	                         "Add duplicates as instances of the object instead of copying the geometry, "
+	                         "when the modifier is last in the stack and no merging, caps or UV offsets are used");
+	RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
 	/* Offset object */
 	prop = RNA_def_property(srna, "use_object_offset", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "offset_type", MOD_ARR_OFF_OBJ);
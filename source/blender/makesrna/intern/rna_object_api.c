@@ -297,21 +297,22 @@ static void rna_Object_ray_cast(
         int *r_success, float r_location[3], float r_normal[3], int *r_index)
 {
 	bool success = false;
+	DerivedMesh *dm = object_get_derived_final_realized(ob);
 
-	if (ob->derivedFinal == NULL) {
+	if (dm == NULL) {
 		BKE_reportf(reports, RPT_ERROR, "Object '%s' has no mesh data to be used for ray casting", ob->id.name + 2);
 		return;
 	}
 
-	/* Test BoundBox first (efficiency) */
-	BoundBox *bb = BKE_object_boundbox_get(ob);
+	/* Test BoundBox first (efficiency), it doesn't include array instances */
+	BoundBox *bb = ob->array_instances ? NULL : BKE_object_boundbox_get(ob);
 	float distmin;
 	if (!bb || (isect_ray_aabb_v3_simple(origin, direction, bb->vec[0], bb->vec[6], &distmin, NULL) && distmin <= distance)) {
 
 		BVHTreeFromMesh treeData = {NULL};
 
 		/* no need to managing allocation or freeing of the BVH data. this is generated and freed as needed */
-		bvhtree_from_mesh_looptri(&treeData, ob->derivedFinal, 0.0f, 4, 6);
+		bvhtree_from_mesh_looptri(&treeData, dm, 0.0f, 4, 6);
 
 		/* may fail if the mesh has no faces, in that case the ray-cast misses */
 		if (treeData.tree != NULL) {
@@ -331,7 +332,7 @@ static void rna_Object_ray_cast(
 
 					copy_v3_v3(r_location, hit.co);
 					copy_v3_v3(r_normal, hit.no);
-					*r_index = dm_looptri_to_poly_index(ob->derivedFinal, &treeData.looptri[hit.index]);
+					*r_index = dm_looptri_to_poly_index(dm, &treeData.looptri[hit.index]);
 				}
 			}
 
@@ -352,15 +353,16 @@ static void rna_Object_closest_point_on_mesh(
         int *r_success, float r_location[3], float r_normal[3], int *r_index)
 {
 	BVHTreeFromMesh treeData = {NULL};
+	DerivedMesh *dm = object_get_derived_final_realized(ob);
 	
-	if (ob->derivedFinal == NULL) {
+	if (dm == NULL) {
 		BKE_reportf(reports, RPT_ERROR, "Object '%s' has no mesh data to be used for finding nearest point",
 		            ob->id.name + 2);
 		return;
 	}
 
 	/* no need to managing allocation or freeing of the BVH data. this is generated and freed as needed */
-	bvhtree_from_mesh_looptri(&treeData, ob->derivedFinal, 0.0f, 4, 6);
+	bvhtree_from_mesh_looptri(&treeData, dm, 0.0f, 4, 6);
 
 	if (treeData.tree == NULL) {
 		BKE_reportf(reports, RPT_ERROR, "Object '%s' could not create internal data for finding nearest point",
@@ -378,7 +380,7 @@ static void rna_Object_closest_point_on_mesh(
 
 			copy_v3_v3(r_location, nearest.co);
 			copy_v3_v3(r_normal, nearest.no);
-			*r_index = dm_looptri_to_poly_index(ob->derivedFinal, &treeData.looptri[nearest.index]);
+			*r_index = dm_looptri_to_poly_index(dm, &treeData.looptri[nearest.index]);
 
 			goto finally;
 		}
@@ -38,6 +38,8 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math.h"
+#include "BLI_spatial_hash.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_curve_types.h"
@@ -52,6 +54,7 @@
 #include "BKE_library_query.h"
 #include "BKE_modifier.h"
 #include "BKE_mesh.h"
+#include "BKE_object.h"
 #include "BKE_object_deform.h"
 
 #include "MOD_util.h"
@@ -119,37 +122,30 @@ static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphConte
 	}
 }
 
-BLI_INLINE float sum_v3(const float v[3])
+typedef struct MapDoublesData {
+	const SpatialHash *hash;
+	const MVert *mverts;
+	const int *doubles_map;
+	int source_start;
+	float dist;
+	/* Nearest target of each source vertex, or -1. */
+	int *source_nearest;
+} MapDoublesData;
+
+static void dm_mvert_map_doubles_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-	return v[0] + v[1] + v[2];
-}
-
-/* Structure used for sorting vertices, when processing doubles */
-typedef struct SortVertsElem {
-	int vertex_num;     /* The original index of the vertex, prior to sorting */
-	float co[3];        /* Its coordinates */
-	float sum_co;       /* sum_v3(co), just so we don't do the sum many times.  */
-} SortVertsElem;
-
+	MapDoublesData *data = userdata;
+	const int i_source = data->source_start + i;
 
-static int svert_sum_cmp(const void *e1, const void *e2)
-{
-	const SortVertsElem *sv1 = e1;
-	const SortVertsElem *sv2 = e2;
-
-	if      (sv1->sum_co > sv2->sum_co) return  1;
-	else if (sv1->sum_co < sv2->sum_co) return -1;
-	else                                return  0;
-}
-
-static void svert_from_mvert(SortVertsElem *sv, const MVert *mv, const int i_begin, const int i_end)
-{
-	int i;
-	for (i = i_begin; i < i_end; i++, sv++, mv++) {
-		sv->vertex_num = i;
-		copy_v3_v3(sv->co, mv->co);
-		sv->sum_co = sum_v3(mv->co);
+	/* If source has already been assigned to a target (in an earlier call, with other chunks) */
+	if (data->doubles_map[i_source] != -1) {
+		data->source_nearest[i] = -1;
+		return;
 	}
+	data->source_nearest[i] = BLI_spatial_hash_find_nearest(data->hash, data->mverts[i_source].co, data->dist, NULL);
 }
 
 /**
@@ -167,112 +163,59 @@ static void dm_mvert_map_doubles(
         const int source_num_verts,
         const float dist)
 {
-	const float dist3 = ((float)M_SQRT3 + 0.00005f) * dist;   /* Just above sqrt(3) */
-	int i_source, i_target, i_target_low_bound, target_end, source_end;
-	SortVertsElem *sorted_verts_target, *sorted_verts_source;
-	SortVertsElem *sve_source, *sve_target, *sve_target_low_bound;
-	bool target_scan_completed;
-
-	target_end = target_start + target_num_verts;
-	source_end = source_start + source_num_verts;
-
-	/* build array of MVerts to be tested for merging */
-	sorted_verts_target = MEM_malloc_arrayN(target_num_verts, sizeof(SortVertsElem), __func__);
-	sorted_verts_source = MEM_malloc_arrayN(source_num_verts, sizeof(SortVertsElem), __func__);
-
-	/* Copy target vertices index and cos into SortVertsElem array */
-	svert_from_mvert(sorted_verts_target, mverts + target_start, target_start, target_end);
-
-	/* Copy source vertices index and cos into SortVertsElem array */
-	svert_from_mvert(sorted_verts_source, mverts + source_start, source_start, source_end);
-
-	/* sort arrays according to sum of vertex coordinates (sumco) */
-	qsort(sorted_verts_target, target_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
-	qsort(sorted_verts_source, source_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
-
-	sve_target_low_bound = sorted_verts_target;
-	i_target_low_bound = 0;
-	target_scan_completed = false;
-
-	/* Scan source vertices, in SortVertsElem sorted array, */
-	/* all the while maintaining the lower bound of possible doubles in target vertices */
-	for (i_source = 0, sve_source = sorted_verts_source;
-	     i_source < source_num_verts;
-	     i_source++, sve_source++)
-	{
-		int best_target_vertex = -1;
-		float best_dist_sq = dist * dist;
-		float sve_source_sumco;
-
-		/* If source has already been assigned to a target (in an earlier call, with other chunks) */
-		if (doubles_map[sve_source->vertex_num] != -1) {
-			continue;
-		}
+	SpatialHash *hash;
+	int i;
 
-		/* If target fully scanned already, then all remaining source vertices cannot have a double */
-		if (target_scan_completed) {
-			doubles_map[sve_source->vertex_num] = -1;
+	/* build a spatial hash of the target vertices to be tested for merging */
+	hash = BLI_spatial_hash_new((uint)target_num_verts, dist * 2.0f);
+	for (i = target_start; i < target_start + target_num_verts; i++) {
+		BLI_spatial_hash_insert(hash, i, mverts[i].co);
+	}
+	BLI_spatial_hash_balance(hash);
+
+	/* Find the nearest target of all source vertices in parallel. */
+	MapDoublesData data = {
+		.hash = hash,
+		.mverts = mverts,
+		.doubles_map = doubles_map,
+		.source_start = source_start,
+		.dist = dist,
+		.source_nearest = MEM_malloc_arrayN((size_t)source_num_verts, sizeof(int), __func__),
+	};
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (source_num_verts > 10000);
+	BLI_task_parallel_range(0, source_num_verts, &data, dm_mvert_map_doubles_cb, &settings);
+
+	BLI_spatial_hash_free(hash);
+
+	/* Targets may map into the source range (merging first and last chunk),
+	 * so mappings are followed in order in a single thread. */
+	for (i = 0; i < source_num_verts; i++) {
+		const int i_source = source_start + i;
+		int best_target_vertex = data.source_nearest[i];
+
+		if (doubles_map[i_source] != -1) {
 			continue;
 		}
 
-		sve_source_sumco = sum_v3(sve_source->co);
-
-		/* Skip all target vertices that are more than dist3 lower in terms of sumco */
-		/* and advance the overall lower bound, applicable to all remaining vertices as well. */
-		while ((i_target_low_bound < target_num_verts) &&
-		       (sve_target_low_bound->sum_co < sve_source_sumco - dist3))
-		{
-			i_target_low_bound++;
-			sve_target_low_bound++;
-		}
-		/* If end of target list reached, then no more possible doubles */
-		if (i_target_low_bound >= target_num_verts) {
-			doubles_map[sve_source->vertex_num] = -1;
-			target_scan_completed = true;
-			continue;
-		}
-		/* Test target candidates starting at the low bound of possible doubles, ordered in terms of sumco */
-		i_target = i_target_low_bound;
-		sve_target = sve_target_low_bound;
-
-		/* i_target will scan vertices in the [v_source_sumco - dist3;  v_source_sumco + dist3] range */
-
-		while ((i_target < target_num_verts) &&
-		       (sve_target->sum_co <= sve_source_sumco + dist3))
-		{
-			/* Testing distance for candidate double in target */
-			/* v_target is within dist3 of v_source in terms of sumco;  check real distance */
-			float dist_sq;
-			if ((dist_sq = len_squared_v3v3(sve_source->co, sve_target->co)) <= best_dist_sq) {
-				/* Potential double found */
-				best_dist_sq = dist_sq;
-				best_target_vertex = sve_target->vertex_num;
-
-				/* If target is already mapped, we only follow that mapping if final target remains
-				 * close enough from current vert (otherwise no mapping at all).
-				 * Note that if we later find another target closer than this one, then we check it. But if other
-				 * potential targets are farther, then there will be no mapping at all for this source. */
-				while (best_target_vertex != -1 && !ELEM(doubles_map[best_target_vertex], -1, best_target_vertex)) {
-					if (compare_len_v3v3(mverts[sve_source->vertex_num].co,
-					                     mverts[doubles_map[best_target_vertex]].co,
-					                     dist))
-					{
-						best_target_vertex = doubles_map[best_target_vertex];
-					}
-					else {
-						best_target_vertex = -1;
-					}
-				}
+		/* If target is already mapped, we only follow that mapping if final target remains
+		 * close enough from current vert (otherwise no mapping at all). */
+		while (best_target_vertex != -1 && !ELEM(doubles_map[best_target_vertex], -1, best_target_vertex)) {
+			if (compare_len_v3v3(mverts[i_source].co,
+			                     mverts[doubles_map[best_target_vertex]].co,
+			                     dist))
+			{
+				best_target_vertex = doubles_map[best_target_vertex];
+			}
+			else {
+				best_target_vertex = -1;
 			}
-			i_target++;
-			sve_target++;
 		}
-		/* End of candidate scan: if none found then no doubles */
-		doubles_map[sve_source->vertex_num] = best_target_vertex;
+		doubles_map[i_source] = best_target_vertex;
 	}
 
-	MEM_freeN(sorted_verts_source);
-	MEM_freeN(sorted_verts_target);
+	MEM_freeN(data.source_nearest);
 }
 
 
@@ -350,6 +293,52 @@ static void mesh_merge_transform(
 	}
 }
 
+/**
+ * Copies can be output as instances of the resulting mesh (see #OB_DUPLIARRAY)
+ * when each of them is an exact transformed copy and nothing else in the stack
+ * depends on the combined geometry.
+ */
+static bool arrayModifier_use_instancing(ArrayModifierData *amd, const ModifierEvalContext *ctx)
+{
+	const int mode_all = eModifierMode_Realtime | eModifierMode_Render;
+	Object *ob = ctx->object;
+	ModifierData *md;
+
+	if ((ob == NULL) || !(ctx->flag & MOD_APPLY_ALLOW_INSTANCES)) {
+		return false;
+	}
+
+	if ((amd->flags & MOD_ARR_INSTANCE) == 0 ||
+	    (amd->flags & MOD_ARR_MERGE) ||
+	    (amd->start_cap && amd->start_cap != ob) ||
+	    (amd->end_cap && amd->end_cap != ob) ||
+	    (amd->uv_offset[0] != 0.0f) ||
+	    (amd->uv_offset[1] != 0.0f))
+	{
+		return false;
+	}
+
+	/* edit and paint modes use derivedFinal directly, other dupli types use the mesh as a source */
+	if ((ob->mode != OB_MODE_OBJECT) ||
+	    (ob->transflag & (OB_DUPLIFRAMES | OB_DUPLIVERTS | OB_DUPLIFACES | OB_DUPLIGROUP)))
+	{
+		return false;
+	}
+
+	/* Viewport and render evaluation must agree,
+	 * since duplis are generated from the object's last evaluation. */
+	if ((amd->modifier.mode & mode_all) != mode_all) {
+		return false;
+	}
+	for (md = amd->modifier.next; md; md = md->next) {
+		if (md->mode & mode_all) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static Mesh *arrayModifier_doArray(
         ArrayModifierData *amd, const ModifierEvalContext *ctx, Mesh *mesh)
 {
@@ -490,6 +479,18 @@ static Mesh *arrayModifier_doArray(
 	if (count < 1)
 		count = 1;
 
+	if ((count > 1) && arrayModifier_use_instancing(amd, ctx)) {
+		/* no caps are used, the object generates the other copies as duplis,
+		 * the instances are freed along with its derivedFinal */
+		Object *ob = ctx->object;
+		if (ob->array_instances == NULL) {
+			ob->array_instances = MEM_callocN(sizeof(*ob->array_instances), __func__);
+		}
+		copy_m4_m4(ob->array_instances->offset, offset);
+		ob->array_instances->count = count;
+		return mesh;
+	}
+
 	/* The number of verts, edges, loops, polys, before eventually merging doubles */
 	result_nverts = chunk_nverts * count + start_cap_nverts + end_cap_nverts;
 	result_nedges = chunk_nedges * count + start_cap_nedges + end_cap_nedges;
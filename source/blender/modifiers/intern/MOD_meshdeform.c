@@ -305,7 +305,7 @@ static void meshdeformModifier_do(
 			tmpdm->release(tmpdm);
 	}
 	else
-		cagedm = mmd->object->derivedFinal;
+		cagedm = object_get_derived_final_realized(mmd->object);
 
 	/* if we don't have one computed, use derivedmesh from data
 	 * without any modifiers */
@@ -28,6 +28,7 @@
 
 #include "BLI_math_base.h"
 #include "BLI_math_vector.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cdderivedmesh.h"
@@ -181,7 +182,8 @@ static DerivedMesh *applyModifier(ModifierData *md,
 	                 rmd->threshold,
 	                 rmd->hermite_num,
 	                 rmd->scale,
-	                 rmd->depth);
+	                 rmd->depth,
+	                 BLI_system_thread_count());
 	result = output->dm;
 	MEM_freeN(output);
 
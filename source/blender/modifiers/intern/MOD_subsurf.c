@@ -46,6 +46,7 @@
 
 
 #include "BKE_cdderivedmesh.h"
+#include "BKE_customdata.h"
 #include "BKE_scene.h"
 #include "BKE_subsurf.h"
 
@@ -75,6 +76,7 @@ static void copyData(ModifierData *md, ModifierData *target)
 	modifier_copyData_generic(md, target);
 
 	tsmd->emCache = tsmd->mCache = NULL;
+	tsmd->loopPlanCache = NULL;
 
 }
 
@@ -88,6 +90,9 @@ static void freeData(ModifierData *md)
 	if (smd->emCache) {
 		ccgSubSurf_free(smd->emCache);
 	}
+	if (smd->loopPlanCache) {
+		CustomData_interp_plan_free(smd->loopPlanCache);
+	}
 }
 
 static bool isDisabled(ModifierData *md, int useRenderParams)
@@ -1045,49 +1045,59 @@ static void deformVert(
 {
 	const SDefDeformData * const data = (SDefDeformData *)userdata;
 	const SDefBind *sdbind = data->bind_verts[index].binds;
+	const float (* const targetCos)[3] = (const float (*)[3])data->targetCos;
 	float * const vertexCos = data->vertexCos[index];
 	float norm[3], temp[3];
 
 	zero_v3(vertexCos);
 
 	for (int j = 0; j < data->bind_verts[index].numbinds; j++, sdbind++) {
-		/* Mode-generic operations (allocate poly coordinates) */
-		float (*coords)[3] = MEM_malloc_arrayN(sdbind->numverts, sizeof(*coords), "SDefDoPolyCoords");
+		const unsigned int *vert_inds = sdbind->vert_inds;
 
+		/* Mode-generic operations (poly normal, read the coordinates in place
+		 * instead of copying them, same as #normal_poly_v3) */
+		const float *v_prev = targetCos[vert_inds[sdbind->numverts - 1]];
+
+		zero_v3(norm);
 		for (int k = 0; k < sdbind->numverts; k++) {
-			copy_v3_v3(coords[k], data->targetCos[sdbind->vert_inds[k]]);
+			const float *v_curr = targetCos[vert_inds[k]];
+			add_newell_cross_v3_v3v3(norm, v_prev, v_curr);
+			v_prev = v_curr;
 		}
+		normalize_v3(norm);
 
-		normal_poly_v3(norm, coords, sdbind->numverts);
 		zero_v3(temp);
 
 		/* ---------- looptri mode ---------- */
 		if (sdbind->mode == MOD_SDEF_MODE_LOOPTRI) {
-			madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[0]], sdbind->vert_weights[0]);
-			madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[1]], sdbind->vert_weights[1]);
-			madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[2]], sdbind->vert_weights[2]);
+			madd_v3_v3fl(temp, targetCos[vert_inds[0]], sdbind->vert_weights[0]);
+			madd_v3_v3fl(temp, targetCos[vert_inds[1]], sdbind->vert_weights[1]);
+			madd_v3_v3fl(temp, targetCos[vert_inds[2]], sdbind->vert_weights[2]);
 		}
 		else {
 			/* ---------- ngon mode ---------- */
 			if (sdbind->mode == MOD_SDEF_MODE_NGON) {
 				for (int k = 0; k < sdbind->numverts; k++) {
-					madd_v3_v3fl(temp, coords[k], sdbind->vert_weights[k]);
+					madd_v3_v3fl(temp, targetCos[vert_inds[k]], sdbind->vert_weights[k]);
 				}
 			}
 
 			/* ---------- centroid mode ---------- */
 			else if (sdbind->mode == MOD_SDEF_MODE_CENTROID) {
+				const float factor = 1.0f / (float)sdbind->numverts;
 				float cent[3];
-				mid_v3_v3_array(cent, coords, sdbind->numverts);
 
-				madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[0]], sdbind->vert_weights[0]);
-				madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[1]], sdbind->vert_weights[1]);
+				zero_v3(cent);
+				for (int k = 0; k < sdbind->numverts; k++) {
+					madd_v3_v3fl(cent, targetCos[vert_inds[k]], factor);
+				}
+
+				madd_v3_v3fl(temp, targetCos[vert_inds[0]], sdbind->vert_weights[0]);
+				madd_v3_v3fl(temp, targetCos[vert_inds[1]], sdbind->vert_weights[1]);
 				madd_v3_v3fl(temp, cent, sdbind->vert_weights[2]);
 			}
 		}
 
-		MEM_freeN(coords);
-
 		/* Apply normal offset (generic for all modes) */
 		madd_v3_v3fl(temp, norm, sdbind->normal_dist);
 
@@ -1115,7 +1125,7 @@ static void surfacedeformModifier_do(
 		tdm = em->derivedFinal;
 	}
 	else {
-		tdm = smd->target->derivedFinal;
+		tdm = object_get_derived_final_realized(smd->target);
 	}
 
 	if (!tdm) {
@@ -211,10 +211,10 @@ DerivedMesh *get_dm_for_modifier(Object *ob, ModifierApplyFlag flag)
 {
 	if (flag & MOD_APPLY_RENDER) {
 		/* TODO(sergey): Use proper derived render in the future. */
-		return ob->derivedFinal;
+		return object_get_derived_final_realized(ob);
 	}
 	else {
-		return ob->derivedFinal;
+		return object_get_derived_final_realized(ob);
 	}
 }
 
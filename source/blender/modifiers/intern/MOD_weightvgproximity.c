@@ -484,7 +484,7 @@ static DerivedMesh *applyModifier(ModifierData *md, const ModifierEvalContext *c
 		const bool use_trgt_faces = (wmd->proximity_flags & MOD_WVG_PROXIMITY_GEOM_FACES) != 0;
 
 		if (use_trgt_verts || use_trgt_edges || use_trgt_faces) {
-			DerivedMesh *target_dm = obr->derivedFinal;
+			DerivedMesh *target_dm = object_get_derived_final_realized(obr);
 			bool free_target_dm = false;
 			if (!target_dm) {
 				if (ELEM(obr->type, OB_CURVE, OB_SURF, OB_FONT))
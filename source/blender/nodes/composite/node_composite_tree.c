@@ -238,6 +238,23 @@ void ntreeCompositExecTree(Scene *scene, bNodeTree *ntree, RenderData *rd, int r
 	UNUSED_VARS(do_preview);
 }
 
+/* Pipelines image loading and file output while rendering a frame range. */
+void ntreeCompositBatchBegin(int prefetch_frames, int frame_step)
+{
+#ifdef WITH_COMPOSITOR
+	COM_batch_begin(prefetch_frames, frame_step);
+#else
+	UNUSED_VARS(prefetch_frames, frame_step);
+#endif
+}
+
+void ntreeCompositBatchEnd(void)
+{
+#ifdef WITH_COMPOSITOR
+	COM_batch_end();
+#endif
+}
+
 /* *********************************************** */
 
 /* Update the outputs of the render layer nodes.
@@ -132,6 +132,9 @@
  */
 
 
+/* number of frames the compositor loads ahead for image sequences when rendering animations */
+#define RE_COMPOSITE_PREFETCH_FRAMES 4
+
 /* ********* globals ******** */
 
 /* here we store all renders */
@@ -2533,6 +2536,7 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 	const bool is_movie = BKE_imtype_is_movie(scene->r.im_format.imtype);
 	const bool is_multiview_name = ((scene->r.scemode & R_MULTIVIEW) != 0 &&
 	                                (scene->r.im_format.views_format == R_IMF_VIEWS_INDIVIDUAL));
+	const bool use_composite = (scene->use_nodes && scene->nodetree && (scene->r.scemode & R_DOCOMP));
 
 	BLI_callback_exec(re->main, (ID *)scene, BLI_CB_EVT_RENDER_INIT);
 
@@ -2588,6 +2592,11 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 
 	re->flag |= R_ANIMATION;
 
+	/* load compositor input sequences ahead and write file outputs in the background */
+	if (use_composite) {
+		ntreeCompositBatchBegin(RE_COMPOSITE_PREFETCH_FRAMES, tfra);
+	}
+
 	{
 		for (nfra = sfra, scene->r.cfra = sfra; scene->r.cfra <= efra; scene->r.cfra++) {
 			char name[FILE_MAX];
@@ -2758,6 +2767,10 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 		}
 	}
 	
+	if (use_composite) {
+		ntreeCompositBatchEnd();
+	}
+
 	/* end movie */
 	if (is_movie) {
 		re_movie_free_all(re, mh, totvideos);
@@ -0,0 +1,105 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_threads.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "BKE_lattice.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "BKE_test_util.h"
+
+/* Run the longest tests! */
+//#define ARMATURE_DEFORM_RUN_BIG
+
+#ifdef ARMATURE_DEFORM_RUN_BIG
+#  define ARMATURE_DEFORM_TOTVERT 1000000
+#else
+#  define ARMATURE_DEFORM_TOTVERT 100000
+#endif
+
+#define ARMATURE_DEFORM_TOTBONE 150
+#define ARMATURE_DEFORM_WEIGHTS 4
+#define ARMATURE_DEFORM_ITER 10
+
+class armature_deform : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		ob_arm = BKE_object_add_only_object(bmain, OB_ARMATURE, "Armature");
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Mesh");
+		unit_m4(ob_arm->obmat);
+		unit_m4(ob->obmat);
+
+		mesh = test_armature_skin_create(bmain, ob_arm, ob, ARMATURE_DEFORM_TOTVERT,
+		                                 ARMATURE_DEFORM_TOTBONE, ARMATURE_DEFORM_WEIGHTS);
+		co = (float (*)[3])MEM_malloc_arrayN(mesh->totvert, sizeof(*co), __func__);
+	}
+
+	void TearDown()
+	{
+		MEM_freeN(co);
+		ob->data = NULL;
+		BKE_main_free(bmain);
+		test_mesh_free(mesh);
+	}
+
+	void coords_reset()
+	{
+		for (int i = 0; i < mesh->totvert; i++) {
+			copy_v3_v3(co[i], mesh->mvert[i].co);
+		}
+	}
+
+	void deform(int deformflag)
+	{
+		armature_deform_verts(ob_arm, ob, mesh, co, NULL, mesh->totvert, deformflag, NULL, NULL);
+	}
+
+	Main *bmain;
+	Object *ob_arm, *ob;
+	Mesh *mesh;
+	float (*co)[3];
+};
+
+TEST_F(armature_deform, Performance)
+{
+	printf("\n========== %d vertices, %d bones, %d weights per vertex ==========\n",
+	       ARMATURE_DEFORM_TOTVERT, ARMATURE_DEFORM_TOTBONE, ARMATURE_DEFORM_WEIGHTS);
+
+	TIMEIT_START(armature_deform_linear);
+	for (int iter = 0; iter < ARMATURE_DEFORM_ITER; iter++) {
+		coords_reset();
+		deform(ARM_DEF_VGROUP);
+	}
+	TIMEIT_END(armature_deform_linear);
+
+	TIMEIT_START(armature_deform_quaternion);
+	for (int iter = 0; iter < ARMATURE_DEFORM_ITER; iter++) {
+		coords_reset();
+		deform(ARM_DEF_VGROUP | ARM_DEF_QUATERNION);
+	}
+	TIMEIT_END(armature_deform_quaternion);
+}
@@ -0,0 +1,128 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "DNA_armature_types.h"
+#include "DNA_action_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "BKE_action.h"
+#include "BKE_lattice.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+}
+
+#include "BKE_test_util.h"
+
+#define ARMATURE_DEFORM_TOTVERT 2000
+#define ARMATURE_DEFORM_TOTBONE 20
+#define ARMATURE_DEFORM_WEIGHTS 4
+
+class armature_deform : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		ob_arm = BKE_object_add_only_object(bmain, OB_ARMATURE, "Armature");
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Mesh");
+		unit_m4(ob_arm->obmat);
+		unit_m4(ob->obmat);
+
+		mesh = test_armature_skin_create(bmain, ob_arm, ob, ARMATURE_DEFORM_TOTVERT,
+		                                 ARMATURE_DEFORM_TOTBONE, ARMATURE_DEFORM_WEIGHTS);
+		co = (float (*)[3])MEM_malloc_arrayN(mesh->totvert, sizeof(*co), __func__);
+	}
+
+	void TearDown()
+	{
+		MEM_freeN(co);
+		ob->data = NULL;
+		BKE_main_free(bmain);
+		test_mesh_free(mesh);
+	}
+
+	void coords_reset()
+	{
+		for (int i = 0; i < mesh->totvert; i++) {
+			copy_v3_v3(co[i], mesh->mvert[i].co);
+		}
+	}
+
+	void deform(int deformflag)
+	{
+		armature_deform_verts(ob_arm, ob, mesh, co, NULL, mesh->totvert, deformflag, NULL, NULL);
+	}
+
+	Main *bmain;
+	Object *ob_arm, *ob;
+	Mesh *mesh;
+	float (*co)[3];
+};
+
+TEST_F(armature_deform, LinearMatchesReference)
+{
+	coords_reset();
+	deform(ARM_DEF_VGROUP);
+
+	for (int i = 0; i < mesh->totvert; i++) {
+		const MDeformVert *dvert = &mesh->dvert[i];
+		float co_ref[3] = {0.0f, 0.0f, 0.0f};
+		float totweight = 0.0f;
+
+		for (int j = 0; j < dvert->totweight; j++) {
+			char name[MAXBONENAME];
+			float tco[3];
+			BLI_snprintf(name, sizeof(name), "Bone%d", dvert->dw[j].def_nr);
+			bPoseChannel *pchan = BKE_pose_channel_find_name(ob_arm->pose, name);
+
+			mul_v3_m4v3(tco, pchan->chan_mat, mesh->mvert[i].co);
+			madd_v3_v3fl(co_ref, tco, dvert->dw[j].weight);
+			totweight += dvert->dw[j].weight;
+		}
+		mul_v3_fl(co_ref, 1.0f / totweight);
+
+		EXPECT_V3_NEAR(co[i], co_ref, 1e-5f);
+	}
+}
+
+TEST_F(armature_deform, SingleBoneRigid)
+{
+	/* with one bone per vertex both methods apply the bone's transform */
+	for (int i = 0; i < mesh->totvert; i++) {
+		mesh->dvert[i].totweight = 1;
+	}
+
+	const int deformflags[2] = {ARM_DEF_VGROUP, ARM_DEF_VGROUP | ARM_DEF_QUATERNION};
+	for (int f = 0; f < 2; f++) {
+		coords_reset();
+		deform(deformflags[f]);
+
+		for (int i = 0; i < mesh->totvert; i++) {
+			char name[MAXBONENAME];
+			float co_ref[3];
+			BLI_snprintf(name, sizeof(name), "Bone%d", mesh->dvert[i].dw[0].def_nr);
+			bPoseChannel *pchan = BKE_pose_channel_find_name(ob_arm->pose, name);
+
+			mul_v3_m4v3(co_ref, pchan->chan_mat, mesh->mvert[i].co);
+			EXPECT_V3_NEAR(co[i], co_ref, 1e-5f);
+		}
+	}
+}
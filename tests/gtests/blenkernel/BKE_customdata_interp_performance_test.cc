@@ -0,0 +1,100 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+#include "BKE_customdata.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "BKE_test_util.h"
+
+/* Run the longest tests! */
+//#define INTERP_RUN_BIG
+
+#ifdef INTERP_RUN_BIG
+#  define INTERP_TOTELEM 4000000
+#else
+#  define INTERP_TOTELEM 400000
+#endif
+
+/* loops of a quad subdivided once, each interpolated from the 4 corners */
+#define INTERP_TOTSRC 4
+#define INTERP_UV_LAYERS 8
+#define INTERP_COL_LAYERS 8
+#define INTERP_NOR_LAYERS 1
+
+class customdata_interp : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		RNG *rng = BLI_rng_new(0);
+
+		totsrc_elem = INTERP_TOTELEM / 4;
+		CustomData_reset(&source);
+		CustomData_reset(&dest_ref);
+		CustomData_reset(&dest);
+
+		test_customdata_random_layers(
+		        &source, totsrc_elem, INTERP_UV_LAYERS, INTERP_COL_LAYERS, INTERP_NOR_LAYERS, rng);
+
+		CustomData_copy(&source, &dest_ref, CD_MASK_EVERYTHING, CD_CALLOC, INTERP_TOTELEM);
+		CustomData_copy(&source, &dest, CD_MASK_EVERYTHING, CD_CALLOC, INTERP_TOTELEM);
+
+		plan = test_customdata_interp_plan(INTERP_TOTELEM, totsrc_elem, INTERP_TOTSRC, false, rng);
+
+		BLI_rng_free(rng);
+	}
+
+	void TearDown()
+	{
+		CustomData_interp_plan_free(plan);
+		CustomData_free(&source, totsrc_elem);
+		CustomData_free(&dest_ref, INTERP_TOTELEM);
+		CustomData_free(&dest, INTERP_TOTELEM);
+	}
+
+	void interp_ref()
+	{
+		for (int i = 0; i < INTERP_TOTELEM; i++) {
+			const int offset = plan->offsets[i];
+			CustomData_interp(&source, &dest_ref,
+			                  &plan->src_indices[offset], &plan->weights[offset], NULL,
+			                  plan->offsets[i + 1] - offset, i);
+		}
+	}
+
+	int totsrc_elem;
+	CustomData source, dest_ref, dest;
+	CustomDataInterpPlan *plan;
+};
+
+TEST_F(customdata_interp, Performance)
+{
+	printf("\n========== %d elements, %d layers ==========\n", INTERP_TOTELEM, source.totlayer);
+
+	TIMEIT_START(customdata_interp);
+	interp_ref();
+	TIMEIT_END(customdata_interp);
+
+	TIMEIT_START(customdata_interp_plan);
+	CustomData_interp_plan_apply(&source, &dest, plan, 0);
+	TIMEIT_END(customdata_interp_plan);
+}
@@ -0,0 +1,87 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+#include "BKE_customdata.h"
+}
+
+#include "BKE_test_util.h"
+
+#define INTERP_TOTELEM 1000
+#define INTERP_TOTSRC_MAX 4
+
+class customdata_interp : public testing::Test {
+protected:
+	void SetUp()
+	{
+		RNG *rng = BLI_rng_new(0);
+
+		totsrc_elem = INTERP_TOTELEM / 4;
+		CustomData_reset(&source);
+		CustomData_reset(&dest_ref);
+		CustomData_reset(&dest);
+
+		test_customdata_random_layers(&source, totsrc_elem, 2, 1, 1, rng);
+
+		/* the destination has room for the elements twice, to write at an offset */
+		CustomData_copy(&source, &dest_ref, CD_MASK_EVERYTHING, CD_CALLOC, INTERP_TOTELEM * 2);
+		CustomData_copy(&source, &dest, CD_MASK_EVERYTHING, CD_CALLOC, INTERP_TOTELEM * 2);
+
+		/* elements are interpolated from a varying number of sources */
+		plan = test_customdata_interp_plan(INTERP_TOTELEM, totsrc_elem, INTERP_TOTSRC_MAX, true, rng);
+
+		BLI_rng_free(rng);
+	}
+
+	void TearDown()
+	{
+		CustomData_interp_plan_free(plan);
+		CustomData_free(&source, totsrc_elem);
+		CustomData_free(&dest_ref, INTERP_TOTELEM * 2);
+		CustomData_free(&dest, INTERP_TOTELEM * 2);
+	}
+
+	void interp_ref(int dest_index)
+	{
+		for (int i = 0; i < INTERP_TOTELEM; i++) {
+			const int offset = plan->offsets[i];
+			CustomData_interp(&source, &dest_ref,
+			                  &plan->src_indices[offset], &plan->weights[offset], NULL,
+			                  plan->offsets[i + 1] - offset, dest_index + i);
+		}
+	}
+
+	void expect_dest_matches_ref()
+	{
+		ASSERT_EQ(dest.totlayer, dest_ref.totlayer);
+		for (int i = 0; i < dest.totlayer; i++) {
+			const size_t size = (size_t)CustomData_sizeof(dest.layers[i].type) * INTERP_TOTELEM * 2;
+			EXPECT_EQ(memcmp(dest.layers[i].data, dest_ref.layers[i].data, size), 0);
+		}
+	}
+
+	int totsrc_elem;
+	CustomData source, dest_ref, dest;
+	CustomDataInterpPlan *plan;
+};
+
+TEST_F(customdata_interp, PlanMatchesInterp)
+{
+	interp_ref(0);
+	CustomData_interp_plan_apply(&source, &dest, plan, 0);
+	expect_dest_matches_ref();
+}
+
+TEST_F(customdata_interp, PlanDestIndex)
+{
+	interp_ref(INTERP_TOTELEM);
+	CustomData_interp_plan_apply(&source, &dest, plan, INTERP_TOTELEM);
+	expect_dest_matches_ref();
+}
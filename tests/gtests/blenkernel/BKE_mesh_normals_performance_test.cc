@@ -0,0 +1,76 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
+#include "DNA_meshdata_types.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "BKE_test_util.h"
+
+/* Run the longest tests! */
+//#define MESH_NORMALS_RUN_BIG
+
+#ifdef MESH_NORMALS_RUN_BIG
+#  define MESH_ITERATIONS 10
+#else
+#  define MESH_ITERATIONS 1
+#endif
+
+class mesh_normals : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(mesh_normals, Performance)
+{
+	/* A bit over 10M vertices. */
+	TestMesh mesh;
+	test_mesh_arrays_grid(&mesh, 3163);
+
+	printf("\n========== %d vertices, %d polygons ==========\n", mesh.totvert, mesh.totpoly);
+
+	MeshElemMap *vert_loop_map;
+	int *vert_loop_mem;
+
+	printf("BKE_mesh_vert_loop_map_create:\n");
+	TIMEIT_START(map_create);
+	BKE_mesh_vert_loop_map_create(&vert_loop_map, &vert_loop_mem, mesh.mpoly, mesh.mloop,
+	                              mesh.totvert, mesh.totpoly, mesh.totloop);
+	TIMEIT_END(map_create);
+
+	printf("serial accumulation:\n");
+	TIMEIT_START(normals_serial);
+	for (int i = 0; i < MESH_ITERATIONS; i++) {
+		BKE_mesh_calc_normals_poly(mesh.mvert, NULL, mesh.totvert, mesh.mloop, mesh.mpoly,
+		                           mesh.totloop, mesh.totpoly, NULL, false);
+	}
+	TIMEIT_END(normals_serial);
+
+	printf("vertex to loop map:\n");
+	TIMEIT_START(normals_map);
+	for (int i = 0; i < MESH_ITERATIONS; i++) {
+		BKE_mesh_calc_normals_poly_ex(mesh.mvert, NULL, mesh.totvert, mesh.mloop, mesh.mpoly,
+		                              mesh.totloop, mesh.totpoly, NULL, false, vert_loop_map);
+	}
+	TIMEIT_END(normals_map);
+
+	MEM_freeN(vert_loop_map);
+	MEM_freeN(vert_loop_mem);
+	test_mesh_arrays_free(&mesh);
+}
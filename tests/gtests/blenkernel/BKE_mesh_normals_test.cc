@@ -0,0 +1,98 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "BKE_customdata.h"
+#include "BKE_library.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+}
+
+#include "BKE_test_util.h"
+
+class mesh_normals : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+/* Gathering through the vertex to loop map sums in the same order as the
+ * serial accumulation, so results are expected to match exactly. */
+TEST_F(mesh_normals, VertLoopMapMatches)
+{
+	TestMesh mesh;
+	test_mesh_arrays_grid(&mesh, 100);
+
+	float (*vnors_serial)[3] = (float (*)[3])MEM_malloc_arrayN(mesh.totvert, sizeof(float[3]), __func__);
+	float (*vnors_map)[3] = (float (*)[3])MEM_malloc_arrayN(mesh.totvert, sizeof(float[3]), __func__);
+	MeshElemMap *vert_loop_map;
+	int *vert_loop_mem;
+
+	BKE_mesh_vert_loop_map_create(&vert_loop_map, &vert_loop_mem, mesh.mpoly, mesh.mloop,
+	                              mesh.totvert, mesh.totpoly, mesh.totloop);
+
+	BKE_mesh_calc_normals_poly(mesh.mvert, vnors_serial, mesh.totvert, mesh.mloop, mesh.mpoly,
+	                           mesh.totloop, mesh.totpoly, NULL, false);
+	BKE_mesh_calc_normals_poly_ex(mesh.mvert, vnors_map, mesh.totvert, mesh.mloop, mesh.mpoly,
+	                              mesh.totloop, mesh.totpoly, NULL, false, vert_loop_map);
+
+	for (int i = 0; i < mesh.totvert; i++) {
+		EXPECT_EQ(vnors_serial[i][0], vnors_map[i][0]);
+		EXPECT_EQ(vnors_serial[i][1], vnors_map[i][1]);
+		EXPECT_EQ(vnors_serial[i][2], vnors_map[i][2]);
+		EXPECT_NEAR(len_v3(vnors_map[i]), 1.0f, 1e-5f);
+	}
+
+	MEM_freeN(vert_loop_map);
+	MEM_freeN(vert_loop_mem);
+	MEM_freeN(vnors_serial);
+	MEM_freeN(vnors_map);
+	test_mesh_arrays_free(&mesh);
+}
+
+/* The map is kept for unchanged topology, built the second time it is seen. */
+TEST_F(mesh_normals, VertLoopMapEnsure)
+{
+	TestMesh grid;
+	test_mesh_arrays_grid(&grid, 10);
+
+	Mesh *mesh = (Mesh *)BKE_libblock_alloc_notest(ID_ME);
+	BKE_mesh_init(mesh);
+	mesh->totvert = grid.totvert;
+	mesh->totloop = grid.totloop;
+	mesh->totpoly = grid.totpoly;
+	CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_ASSIGN, grid.mvert, mesh->totvert);
+	CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_ASSIGN, grid.mloop, mesh->totloop);
+	CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_ASSIGN, grid.mpoly, mesh->totpoly);
+	BKE_mesh_update_customdata_pointers(mesh, false);
+
+	EXPECT_EQ(BKE_mesh_vert_loop_map_ensure(mesh), (const MeshElemMap *)NULL);
+	const MeshElemMap *map = BKE_mesh_vert_loop_map_ensure(mesh);
+	ASSERT_NE(map, (const MeshElemMap *)NULL);
+	EXPECT_EQ(BKE_mesh_vert_loop_map_ensure(mesh), map);
+
+	/* the corner vertex is only used by the first loop */
+	EXPECT_EQ(map[0].count, 1);
+	EXPECT_EQ(map[0].indices[0], 0);
+
+	/* changed in place, so the topology has to be seen twice again */
+	BKE_mesh_vert_loop_map_clear(mesh);
+	EXPECT_EQ(BKE_mesh_vert_loop_map_ensure(mesh), (const MeshElemMap *)NULL);
+	EXPECT_NE(BKE_mesh_vert_loop_map_ensure(mesh), (const MeshElemMap *)NULL);
+
+	test_mesh_free(mesh);
+}
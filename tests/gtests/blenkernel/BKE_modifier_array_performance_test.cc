@@ -0,0 +1,102 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "BKE_customdata.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "BKE_test_util.h"
+
+/* Run the longest tests! */
+//#define ARRAY_RUN_BIG
+
+#ifdef ARRAY_RUN_BIG
+#  define ARRAY_GRID_SIZE 317
+#  define ARRAY_COUNT 1000
+#else
+#  define ARRAY_GRID_SIZE 101
+#  define ARRAY_COUNT 200
+#endif
+
+class modifier_array : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		BKE_modifier_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Array");
+		amd = (ArrayModifierData *)modifier_new(eModifierType_Array);
+		BLI_addtail(&ob->modifiers, amd);
+	}
+
+	void TearDown()
+	{
+		BKE_main_free(bmain);
+	}
+
+	Mesh *array_apply(Mesh *mesh, ModifierApplyFlag flag)
+	{
+		const ModifierTypeInfo *mti = modifierType_getInfo(eModifierType_Array);
+		const ModifierEvalContext mectx = {NULL, ob, flag};
+		return mti->applyModifier(&amd->modifier, &mectx, mesh);
+	}
+
+	Main *bmain;
+	Object *ob;
+	ArrayModifierData *amd;
+};
+
+TEST_F(modifier_array, Performance)
+{
+	Mesh *mesh = test_mesh_grid(NULL, ARRAY_GRID_SIZE, 0.0f);
+	amd->count = ARRAY_COUNT;
+
+	printf("\n========== %d faces, %d copies ==========\n", mesh->totpoly, ARRAY_COUNT);
+
+	{
+		Mesh *result;
+		TIMEIT_START(array_copy);
+		result = array_apply(mesh, MOD_APPLY_USECACHE);
+		TIMEIT_END(array_copy);
+		printf("result: %d faces\n", result->totpoly);
+		test_mesh_free(result);
+	}
+
+	amd->flags |= MOD_ARR_INSTANCE;
+	{
+		Mesh *result;
+		TIMEIT_START(array_instance);
+		result = array_apply(mesh, (ModifierApplyFlag)(MOD_APPLY_USECACHE | MOD_APPLY_ALLOW_INSTANCES));
+		TIMEIT_END(array_instance);
+		printf("result: %d faces, %d instances\n", result->totpoly, ob->array_instances->count);
+		EXPECT_EQ(mesh, result);
+	}
+
+	test_mesh_free(mesh);
+}
@@ -0,0 +1,180 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "BKE_anim.h"
+#include "BKE_customdata.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "IMB_imbuf.h"
+}
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "BKE_test_util.h"
+
+class modifier_array : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+		BKE_modifier_init();
+		DEG_register_node_types();
+	}
+
+	static void TearDownTestCase()
+	{
+		DEG_free_node_types();
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		/* Freeing a scene looks for its users in G.main. */
+		G.main = bmain;
+		scene = BKE_scene_add(bmain, "Scene");
+		ViewLayer *view_layer = (ViewLayer *)scene->view_layers.first;
+
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Array");
+		ob->data = test_mesh_grid(bmain, 5, 0.0f);
+		unit_m4(ob->obmat);
+		amd = (ArrayModifierData *)modifier_new(eModifierType_Array);
+		amd->count = 10;
+		copy_v3_fl3(amd->scale, 1.0f, 0.5f, 0.0f);
+		BLI_addtail(&ob->modifiers, amd);
+
+		depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_VIEWPORT);
+		/* evaluating the object's own derived mesh looks up the evaluated view layer */
+		DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+	}
+
+	void TearDown()
+	{
+		DEG_graph_free(depsgraph);
+		BKE_main_free(bmain);
+		G.main = NULL;
+	}
+
+	Mesh *array_apply(Mesh *mesh, ModifierApplyFlag flag)
+	{
+		const ModifierTypeInfo *mti = modifierType_getInfo(eModifierType_Array);
+		const ModifierEvalContext mectx = {depsgraph, ob, flag};
+		return mti->applyModifier(&amd->modifier, &mectx, mesh);
+	}
+
+	Main *bmain;
+	Scene *scene;
+	Object *ob;
+	ArrayModifierData *amd;
+	Depsgraph *depsgraph;
+};
+
+TEST_F(modifier_array, Instancing)
+{
+	Mesh *mesh = (Mesh *)ob->data;
+
+	Mesh *result = array_apply(mesh, (ModifierApplyFlag)0);
+	EXPECT_NE(mesh, result);
+	EXPECT_EQ(result->totpoly, mesh->totpoly * 10);
+
+	/* only the object's own evaluation allows instances */
+	amd->flags |= MOD_ARR_INSTANCE;
+	Mesh *result_full = array_apply(mesh, MOD_APPLY_USECACHE);
+	EXPECT_EQ(result_full->totpoly, result->totpoly);
+	EXPECT_EQ(ob->array_instances, (ObjectArrayInstances *)NULL);
+	test_mesh_free(result_full);
+
+	Mesh *result_instanced = array_apply(mesh, MOD_APPLY_ALLOW_INSTANCES);
+	EXPECT_EQ(mesh, result_instanced);
+	ASSERT_NE(ob->array_instances, (ObjectArrayInstances *)NULL);
+	EXPECT_EQ(ob->array_instances->count, 10);
+
+	/* duplis accumulate the offset to the same positions as the copies */
+	float offset[4][4];
+	unit_m4(offset);
+	for (int c = 0; c < ob->array_instances->count; c++) {
+		for (int i = 0; i < mesh->totvert; i++) {
+			float co[3];
+			mul_v3_m4v3(co, offset, mesh->mvert[i].co);
+			EXPECT_V3_NEAR(result->mvert[c * mesh->totvert + i].co, co, 1e-5f);
+		}
+		mul_m4_m4m4(offset, offset, ob->array_instances->offset);
+	}
+
+	/* the instances belong to the derived mesh */
+	BKE_object_free_derived_caches(ob);
+	EXPECT_EQ(ob->array_instances, (ObjectArrayInstances *)NULL);
+
+	/* the following modifier needs all copies */
+	ModifierData *md_next = modifier_new(eModifierType_Triangulate);
+	BLI_addtail(&ob->modifiers, md_next);
+	Mesh *result_stack = array_apply(mesh, MOD_APPLY_ALLOW_INSTANCES);
+	EXPECT_EQ(result_stack->totpoly, result->totpoly);
+	EXPECT_EQ(ob->array_instances, (ObjectArrayInstances *)NULL);
+	test_mesh_free(result_stack);
+
+	test_mesh_free(result);
+}
+
+TEST_F(modifier_array, DerivedFinalRealized)
+{
+	Mesh *mesh = (Mesh *)ob->data;
+	amd->flags |= MOD_ARR_INSTANCE;
+
+	DerivedMesh *dm_full = mesh_create_derived_view(depsgraph, scene, ob, CD_MASK_BAREMESH);
+	EXPECT_EQ(dm_full->getNumPolys(dm_full), mesh->totpoly * 10);
+	EXPECT_FALSE(ob->transflag & OB_DUPLIARRAY);
+
+	DerivedMesh *dm = mesh_get_derived_final(depsgraph, scene, ob, CD_MASK_BAREMESH);
+	EXPECT_TRUE(ob->transflag & OB_DUPLIARRAY);
+	EXPECT_EQ(ob->derivedFinal->getNumPolys(ob->derivedFinal), mesh->totpoly);
+	EXPECT_EQ(object_get_derived_final(ob, false), dm);
+
+	/* code reading the final mesh gets the same geometry as without instancing */
+	ASSERT_EQ(dm->getNumVerts(dm), dm_full->getNumVerts(dm_full));
+	ASSERT_EQ(dm->getNumEdges(dm), dm_full->getNumEdges(dm_full));
+	ASSERT_EQ(dm->getNumLoops(dm), dm_full->getNumLoops(dm_full));
+	ASSERT_EQ(dm->getNumPolys(dm), dm_full->getNumPolys(dm_full));
+	MVert *mvert = dm->getVertArray(dm), *mvert_full = dm_full->getVertArray(dm_full);
+	for (int i = 0; i < dm->getNumVerts(dm); i++) {
+		EXPECT_V3_NEAR(mvert[i].co, mvert_full[i].co, 1e-5f);
+	}
+	MLoop *mloop = dm->getLoopArray(dm), *mloop_full = dm_full->getLoopArray(dm_full);
+	for (int i = 0; i < dm->getNumLoops(dm); i++) {
+		EXPECT_EQ(mloop[i].v, mloop_full[i].v);
+	}
+	MPoly *mpoly = dm->getPolyArray(dm), *mpoly_full = dm_full->getPolyArray(dm_full);
+	for (int i = 0; i < dm->getNumPolys(dm); i++) {
+		EXPECT_EQ(mpoly[i].loopstart, mpoly_full[i].loopstart);
+	}
+
+	/* the object's own mesh is the first copy */
+	ListBase *lb = object_duplilist(depsgraph, scene, ob);
+	EXPECT_EQ(BLI_listbase_count(lb), 9);
+	free_object_duplilist(lb);
+
+	BKE_object_free_derived_caches(ob);
+	EXPECT_FALSE(ob->transflag & OB_DUPLIARRAY);
+
+	dm_full->release(dm_full);
+}
@@ -0,0 +1,260 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "DNA_color_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "BKE_cdderivedmesh.h"
+#include "BKE_colortools.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_modifier_cache.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "IMB_imbuf.h"
+}
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#include "BKE_test_util.h"
+
+static DerivedMesh *cache_test_dm(int totvert)
+{
+	DerivedMesh *dm = CDDM_new(totvert, 0, 0, 0, 0);
+	MVert *mvert = CDDM_get_verts(dm);
+
+	for (int i = 0; i < totvert; i++) {
+		copy_v3_fl3(mvert[i].co, (float)i, 0.0f, 0.0f);
+	}
+	return dm;
+}
+
+TEST(modifier_cache, Hit)
+{
+	ModifierResultCache *cache = BKE_modifier_result_cache_new();
+	const char key[] = "settings";
+	DerivedMesh *dm = cache_test_dm(10);
+
+	BKE_modifier_result_cache_store(cache, key, sizeof(key), dm, 1.0);
+	EXPECT_GT(BKE_modifier_result_cache_memory_get(cache), 0);
+
+	DerivedMesh *result = BKE_modifier_result_cache_lookup(cache, key, sizeof(key));
+	ASSERT_NE(result, (DerivedMesh *)NULL);
+	EXPECT_NE(result, dm);
+	EXPECT_EQ(result->getNumVerts(result), 10);
+	EXPECT_EQ(CDDM_get_verts(result)[9].co[0], 9.0f);
+
+	result->release(result);
+	dm->release(dm);
+	BKE_modifier_result_cache_free(cache);
+}
+
+TEST(modifier_cache, Miss)
+{
+	ModifierResultCache *cache = BKE_modifier_result_cache_new();
+	const char key[] = "settings";
+	const char key_other[] = "settingz";
+	DerivedMesh *dm = cache_test_dm(10);
+
+	BKE_modifier_result_cache_store(cache, key, sizeof(key), dm, 1.0);
+	EXPECT_EQ(BKE_modifier_result_cache_lookup(cache, key_other, sizeof(key_other)), (DerivedMesh *)NULL);
+	/* a prefix of the key is a different key */
+	EXPECT_EQ(BKE_modifier_result_cache_lookup(cache, key, sizeof(key) - 1), (DerivedMesh *)NULL);
+
+	/* results which were fast to compute are not stored */
+	BKE_modifier_result_cache_store(cache, key_other, sizeof(key_other), dm, 0.0);
+	EXPECT_EQ(BKE_modifier_result_cache_lookup(cache, key_other, sizeof(key_other)), (DerivedMesh *)NULL);
+
+	dm->release(dm);
+	BKE_modifier_result_cache_free(cache);
+}
+
+TEST(modifier_cache, LeastRecentlyUsed)
+{
+	ModifierResultCache *cache = BKE_modifier_result_cache_new();
+	const int keys[3] = {0, 1, 2};
+	DerivedMesh *dm = cache_test_dm(100);
+
+	BKE_modifier_result_cache_store(cache, &keys[0], sizeof(int), dm, 1.0);
+	const size_t memory = BKE_modifier_result_cache_memory_get(cache);
+	BKE_modifier_result_cache_limit_set(cache, memory * 2);
+	BKE_modifier_result_cache_store(cache, &keys[1], sizeof(int), dm, 1.0);
+
+	/* using the first result makes the second one the least recently used */
+	DerivedMesh *result = BKE_modifier_result_cache_lookup(cache, &keys[0], sizeof(int));
+	result->release(result);
+	BKE_modifier_result_cache_store(cache, &keys[2], sizeof(int), dm, 1.0);
+	EXPECT_EQ(BKE_modifier_result_cache_memory_get(cache), memory * 2);
+
+	result = BKE_modifier_result_cache_lookup(cache, &keys[0], sizeof(int));
+	ASSERT_NE(result, (DerivedMesh *)NULL);
+	result->release(result);
+	EXPECT_EQ(BKE_modifier_result_cache_lookup(cache, &keys[1], sizeof(int)), (DerivedMesh *)NULL);
+	result = BKE_modifier_result_cache_lookup(cache, &keys[2], sizeof(int));
+	ASSERT_NE(result, (DerivedMesh *)NULL);
+	result->release(result);
+
+	BKE_modifier_result_cache_clear(cache);
+	EXPECT_EQ(BKE_modifier_result_cache_memory_get(cache), 0);
+	EXPECT_EQ(BKE_modifier_result_cache_lookup(cache, &keys[0], sizeof(int)), (DerivedMesh *)NULL);
+
+	dm->release(dm);
+	BKE_modifier_result_cache_free(cache);
+}
+
+/* Evaluating the modifier stack with the cache of a depsgraph. */
+class modifier_cache_stack : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+		BKE_modifier_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		/* Freeing a scene looks for its users in G.main. */
+		G.main = bmain;
+		scene = BKE_scene_add(bmain, "Scene");
+		ViewLayer *view_layer = (ViewLayer *)scene->view_layers.first;
+
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Mesh");
+		ob->data = grid_create(10);
+		BKE_defgroup_new(ob, "Group");
+		unit_m4(ob->obmat);
+
+		depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_VIEWPORT);
+		cache = DEG_get_modifier_result_cache(depsgraph);
+		/* store every result, the test meshes are quick to compute */
+		BKE_modifier_result_cache_min_time_set(cache, 0.0);
+	}
+
+	void TearDown()
+	{
+		DEG_graph_free(depsgraph);
+		BKE_main_free(bmain);
+		G.main = NULL;
+	}
+
+	/* Grid of size x size vertices in the XY plane, all in the vertex group. */
+	Mesh *grid_create(int size)
+	{
+		Mesh *mesh = test_mesh_grid(bmain, size, 0.0f);
+		CustomData_add_layer(&mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, NULL, mesh->totvert);
+		BKE_mesh_update_customdata_pointers(mesh, false);
+
+		for (int i = 0; i < mesh->totvert; i++) {
+			defvert_add_index_notest(&mesh->dvert[i], 0, mesh->mvert[i].co[0]);
+		}
+		return mesh;
+	}
+
+	ModifierData *modifier_add(int type)
+	{
+		ModifierData *md = modifier_new(type);
+		BLI_addtail(&ob->modifiers, md);
+		return md;
+	}
+
+	/* Whether evaluating the stack stored a new result, which means it
+	 * wasn't found in the cache. */
+	bool evaluate_stores_result()
+	{
+		const size_t memory = BKE_modifier_result_cache_memory_get(cache);
+		DerivedMesh *dm = mesh_create_derived_view(depsgraph, scene, ob, CD_MASK_BAREMESH);
+		dm->release(dm);
+		return BKE_modifier_result_cache_memory_get(cache) != memory;
+	}
+
+	Main *bmain;
+	Scene *scene;
+	Object *ob;
+	Depsgraph *depsgraph;
+	ModifierResultCache *cache;
+};
+
+TEST_F(modifier_cache_stack, SettingsChanged)
+{
+	ArrayModifierData *amd = (ArrayModifierData *)modifier_add(eModifierType_Array);
+	amd->count = 2;
+
+	EXPECT_TRUE(evaluate_stores_result());
+	EXPECT_FALSE(evaluate_stores_result());
+
+	amd->count = 3;
+	EXPECT_TRUE(evaluate_stores_result());
+	EXPECT_FALSE(evaluate_stores_result());
+
+	/* back to earlier settings */
+	amd->count = 2;
+	EXPECT_FALSE(evaluate_stores_result());
+}
+
+TEST_F(modifier_cache_stack, MeshChanged)
+{
+	modifier_add(eModifierType_Array);
+
+	EXPECT_TRUE(evaluate_stores_result());
+	((Mesh *)ob->data)->mvert[0].co[2] = 1.0f;
+	EXPECT_TRUE(evaluate_stores_result());
+	EXPECT_FALSE(evaluate_stores_result());
+}
+
+TEST_F(modifier_cache_stack, WeightChanged)
+{
+	WeightVGEditModifierData *wmd = (WeightVGEditModifierData *)modifier_add(eModifierType_WeightVGEdit);
+	BLI_strncpy(wmd->defgrp_name, "Group", sizeof(wmd->defgrp_name));
+	modifier_add(eModifierType_Array);
+
+	EXPECT_TRUE(evaluate_stores_result());
+	((Mesh *)ob->data)->dvert[0].dw[0].weight = 0.5f;
+	EXPECT_TRUE(evaluate_stores_result());
+	EXPECT_FALSE(evaluate_stores_result());
+}
+
+TEST_F(modifier_cache_stack, CurveChanged)
+{
+	WeightVGEditModifierData *wmd = (WeightVGEditModifierData *)modifier_add(eModifierType_WeightVGEdit);
+	BLI_strncpy(wmd->defgrp_name, "Group", sizeof(wmd->defgrp_name));
+	wmd->falloff_type = MOD_WVG_MAPPING_CURVE;
+	modifier_add(eModifierType_Array);
+
+	EXPECT_TRUE(evaluate_stores_result());
+	EXPECT_FALSE(evaluate_stores_result());
+
+	/* the curve is compared by its points, not by its address */
+	CurveMap *cuma = &wmd->cmap_curve->cm[0];
+	cuma->curve[0].y = 0.5f;
+	curvemapping_changed(wmd->cmap_curve, false);
+	EXPECT_TRUE(evaluate_stores_result());
+
+	CurveMapping *cmap_copy = curvemapping_copy(wmd->cmap_curve);
+	curvemapping_free(wmd->cmap_curve);
+	wmd->cmap_curve = cmap_copy;
+	EXPECT_FALSE(evaluate_stores_result());
+}
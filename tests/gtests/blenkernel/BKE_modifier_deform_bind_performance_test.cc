@@ -0,0 +1,180 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "BKE_cdderivedmesh.h"
+#include "BKE_customdata.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "ED_armature.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "BKE_test_util.h"
+
+/* Run the longest tests! */
+//#define DEFORM_BIND_RUN_BIG
+
+#ifdef DEFORM_BIND_RUN_BIG
+#  define SDEF_TARGET_SIZE 317
+#  define SDEF_SOURCE_SIZE 633
+#  define MDEF_CAGE_SUBDIV 8
+#  define MDEF_SOURCE_SIZE 317
+#  define MDEF_GRIDSIZE 6
+#else
+#  define SDEF_TARGET_SIZE 101
+#  define SDEF_SOURCE_SIZE 201
+#  define MDEF_CAGE_SUBDIV 3
+#  define MDEF_SOURCE_SIZE 101
+#  define MDEF_GRIDSIZE 5
+#endif
+
+#define DEFORM_EVAL_ITER 10
+
+class modifier_deform_bind : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		BKE_modifier_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Deform");
+		ob_target = BKE_object_add_only_object(bmain, OB_MESH, "Target");
+		mesh = NULL;
+		mesh_target = NULL;
+	}
+
+	void TearDown()
+	{
+		if (ob_target->derivedFinal) {
+			ob_target->derivedFinal->needsFree = 1;
+			ob_target->derivedFinal->release(ob_target->derivedFinal);
+			ob_target->derivedFinal = NULL;
+		}
+		BKE_main_free(bmain);
+		if (mesh) {
+			test_mesh_free(mesh);
+		}
+		if (mesh_target) {
+			test_mesh_free(mesh_target);
+		}
+	}
+
+	/* Like an evaluated object, the derived mesh is owned by the target. */
+	void target_set(Mesh *me)
+	{
+		ob_target->derivedFinal = CDDM_from_mesh(me);
+		ob_target->derivedFinal->needsFree = 0;
+	}
+
+	/* Bend the target so evaluation does real work. */
+	void target_bend()
+	{
+		DerivedMesh *dm = ob_target->derivedFinal;
+		MVert *mvert = dm->getVertArray(dm);
+		for (int i = 0; i < dm->getNumVerts(dm); i++) {
+			mvert[i].co[2] += 0.1f * sinf(4.0f * mvert[i].co[0]);
+		}
+	}
+
+	void deform(ModifierData *md, float (*co)[3], int totvert)
+	{
+		const ModifierEvalContext mectx = {NULL, ob, MOD_APPLY_USECACHE};
+		modifier_deformVerts_DM_deprecated(md, &mectx, NULL, co, totvert);
+	}
+
+	Main *bmain;
+	Object *ob, *ob_target;
+	Mesh *mesh, *mesh_target;
+};
+
+TEST_F(modifier_deform_bind, SurfaceDeformPerformance)
+{
+	mesh = test_mesh_grid(NULL, SDEF_SOURCE_SIZE, 0.05f);
+	mesh_target = test_mesh_grid(NULL, SDEF_TARGET_SIZE, 0.0f);
+	ob->data = mesh;
+	target_set(mesh_target);
+
+	SurfaceDeformModifierData *smd = (SurfaceDeformModifierData *)modifier_new(eModifierType_SurfaceDeform);
+	BLI_addtail(&ob->modifiers, smd);
+	smd->target = ob_target;
+	smd->flags |= MOD_SDEF_BIND;
+
+	printf("\n========== %d verts bound to %d faces ==========\n", mesh->totvert, mesh_target->totpoly);
+
+	float (*co)[3] = test_mesh_vert_cos(mesh);
+	TIMEIT_START(surfacedeform_bind);
+	deform(&smd->modifier, co, mesh->totvert);
+	TIMEIT_END(surfacedeform_bind);
+	ASSERT_TRUE(smd->verts != NULL);
+
+	target_bend();
+	TIMEIT_START(surfacedeform_eval);
+	for (int iter = 0; iter < DEFORM_EVAL_ITER; iter++) {
+		for (int i = 0; i < mesh->totvert; i++) {
+			copy_v3_v3(co[i], mesh->mvert[i].co);
+		}
+		deform(&smd->modifier, co, mesh->totvert);
+	}
+	TIMEIT_END(surfacedeform_eval);
+
+	MEM_freeN(co);
+}
+
+TEST_F(modifier_deform_bind, MeshDeformPerformance)
+{
+	mesh = test_mesh_grid(NULL, MDEF_SOURCE_SIZE, 0.0f);
+	mesh_target = test_mesh_box(NULL, MDEF_CAGE_SUBDIV);
+	ob->data = mesh;
+	target_set(mesh_target);
+
+	MeshDeformModifierData *mmd = (MeshDeformModifierData *)modifier_new(eModifierType_MeshDeform);
+	BLI_addtail(&ob->modifiers, mmd);
+	mmd->object = ob_target;
+	mmd->gridsize = MDEF_GRIDSIZE;
+	mmd->bindfunc = ED_mesh_deform_bind_callback;
+
+	printf("\n========== %d verts bound to %d cage verts ==========\n", mesh->totvert, mesh_target->totvert);
+
+	float (*co)[3] = test_mesh_vert_cos(mesh);
+	TIMEIT_START(meshdeform_bind);
+	deform(&mmd->modifier, co, mesh->totvert);
+	TIMEIT_END(meshdeform_bind);
+	ASSERT_TRUE(mmd->bindcagecos != NULL);
+	ASSERT_TRUE(mmd->bindinfluences != NULL);
+
+	target_bend();
+	TIMEIT_START(meshdeform_eval);
+	for (int iter = 0; iter < DEFORM_EVAL_ITER; iter++) {
+		for (int i = 0; i < mesh->totvert; i++) {
+			copy_v3_v3(co[i], mesh->mvert[i].co);
+		}
+		deform(&mmd->modifier, co, mesh->totvert);
+	}
+	TIMEIT_END(meshdeform_eval);
+
+	MEM_freeN(co);
+}
@@ -0,0 +1,174 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "BKE_cdderivedmesh.h"
+#include "BKE_customdata.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "ED_armature.h"
+}
+
+#include "BKE_test_util.h"
+
+class modifier_deform_bind : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		BKE_modifier_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Deform");
+		ob_target = BKE_object_add_only_object(bmain, OB_MESH, "Target");
+		mesh = NULL;
+		mesh_target = NULL;
+	}
+
+	void TearDown()
+	{
+		if (ob_target->derivedFinal) {
+			ob_target->derivedFinal->needsFree = 1;
+			ob_target->derivedFinal->release(ob_target->derivedFinal);
+			ob_target->derivedFinal = NULL;
+		}
+		BKE_main_free(bmain);
+		if (mesh) {
+			test_mesh_free(mesh);
+		}
+		if (mesh_target) {
+			test_mesh_free(mesh_target);
+		}
+	}
+
+	/* Like an evaluated object, the derived mesh is owned by the target. */
+	void target_set(Mesh *me)
+	{
+		ob_target->derivedFinal = CDDM_from_mesh(me);
+		ob_target->derivedFinal->needsFree = 0;
+	}
+
+	/* Bend the target so evaluation does real work. */
+	void target_bend()
+	{
+		DerivedMesh *dm = ob_target->derivedFinal;
+		MVert *mvert = dm->getVertArray(dm);
+		for (int i = 0; i < dm->getNumVerts(dm); i++) {
+			mvert[i].co[2] += 0.1f * sinf(4.0f * mvert[i].co[0]);
+		}
+	}
+
+	void deform(ModifierData *md, float (*co)[3], int totvert)
+	{
+		const ModifierEvalContext mectx = {NULL, ob, MOD_APPLY_USECACHE};
+		modifier_deformVerts_DM_deprecated(md, &mectx, NULL, co, totvert);
+	}
+
+	Main *bmain;
+	Object *ob, *ob_target;
+	Mesh *mesh, *mesh_target;
+};
+
+TEST_F(modifier_deform_bind, SurfaceDeform)
+{
+	mesh = test_mesh_grid(NULL, 21, 0.05f);
+	mesh_target = test_mesh_grid(NULL, 11, 0.0f);
+	ob->data = mesh;
+	target_set(mesh_target);
+
+	SurfaceDeformModifierData *smd = (SurfaceDeformModifierData *)modifier_new(eModifierType_SurfaceDeform);
+	BLI_addtail(&ob->modifiers, smd);
+	smd->target = ob_target;
+	smd->flags |= MOD_SDEF_BIND;
+
+	float (*co)[3] = test_mesh_vert_cos(mesh);
+	deform(&smd->modifier, co, mesh->totvert);
+	ASSERT_TRUE(smd->verts != NULL);
+	EXPECT_EQ(smd->numverts, (unsigned int)mesh->totvert);
+	EXPECT_EQ(smd->numpoly, (unsigned int)mesh_target->totpoly);
+
+	/* binding to an unchanged target keeps the positions */
+	for (int i = 0; i < mesh->totvert; i++) {
+		EXPECT_V3_NEAR(co[i], mesh->mvert[i].co, 1e-4f);
+	}
+
+	target_bend();
+	for (int i = 0; i < mesh->totvert; i++) {
+		copy_v3_v3(co[i], mesh->mvert[i].co);
+	}
+	deform(&smd->modifier, co, mesh->totvert);
+
+	/* vertices over the middle of the target follow it */
+	const int mid = (21 / 2) * 21 + 21 / 2;
+	EXPECT_NEAR(co[mid][2], 0.05f + 0.1f * sinf(4.0f * mesh->mvert[mid].co[0]), 1e-2f);
+
+	MEM_freeN(co);
+}
+
+TEST_F(modifier_deform_bind, MeshDeform)
+{
+	mesh = test_mesh_grid(NULL, 11, 0.0f);
+	mesh_target = test_mesh_box(NULL, 2);
+	ob->data = mesh;
+	target_set(mesh_target);
+
+	MeshDeformModifierData *mmd = (MeshDeformModifierData *)modifier_new(eModifierType_MeshDeform);
+	BLI_addtail(&ob->modifiers, mmd);
+	mmd->object = ob_target;
+	mmd->gridsize = 3;
+	mmd->bindfunc = ED_mesh_deform_bind_callback;
+
+	float (*co)[3] = test_mesh_vert_cos(mesh);
+	deform(&mmd->modifier, co, mesh->totvert);
+	ASSERT_TRUE(mmd->bindcagecos != NULL);
+	ASSERT_TRUE(mmd->bindinfluences != NULL);
+	EXPECT_EQ(mmd->totvert, mesh->totvert);
+	EXPECT_EQ(mmd->totcagevert, mesh_target->totvert);
+
+	/* every vertex is inside the cage and its weights form a partition of unity */
+	for (int i = 0; i < mesh->totvert; i++) {
+		float totweight = 0.0f;
+		for (int j = mmd->bindoffsets[i]; j < mmd->bindoffsets[i + 1]; j++) {
+			totweight += mmd->bindinfluences[j].weight;
+		}
+		EXPECT_NEAR(totweight, 1.0f, 1e-3f);
+		EXPECT_V3_NEAR(co[i], mesh->mvert[i].co, 1e-5f);
+	}
+
+	/* moving the cage moves the vertices inside it */
+	target_bend();
+	for (int i = 0; i < mesh->totvert; i++) {
+		copy_v3_v3(co[i], mesh->mvert[i].co);
+	}
+	deform(&mmd->modifier, co, mesh->totvert);
+
+	float totdelta = 0.0f;
+	for (int i = 0; i < mesh->totvert; i++) {
+		totdelta += fabsf(co[i][2] - mesh->mvert[i].co[2]);
+	}
+	EXPECT_GT(totdelta, 0.0f);
+
+	MEM_freeN(co);
+}
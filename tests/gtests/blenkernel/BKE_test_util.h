@@ -0,0 +1,371 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __BLENDER_TESTING_BKE_TEST_UTIL_H__
+#define __BLENDER_TESTING_BKE_TEST_UTIL_H__
+
+/* Fixture factories shared by the blenkernel correctness and performance tests. */
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_listbase.h"
+#include "BLI_rand.h"
+#include "BLI_string.h"
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "BKE_action.h"
+#include "BKE_armature.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+}
+
+/* -------------------------------------------------------------------- */
+/* Mesh Arrays */
+
+/* Bare mesh arrays, for functions which don't take a #Mesh. */
+struct TestMesh {
+	MVert *mvert;
+	MLoop *mloop;
+	MPoly *mpoly;
+	int totvert, totloop, totpoly;
+};
+
+/* Noisy grid of size x size vertices, every other row of faces is split into
+ * triangles so both the quad and triangle code paths are used. */
+inline void test_mesh_arrays_grid(TestMesh *mesh, int size)
+{
+	const int faces = size - 1;
+	RNG *rng = BLI_rng_new(0);
+
+	mesh->totvert = size * size;
+	mesh->totpoly = 0;
+	mesh->totloop = 0;
+	for (int y = 0; y < faces; y++) {
+		mesh->totpoly += (y & 1) ? faces * 2 : faces;
+		mesh->totloop += faces * ((y & 1) ? 6 : 4);
+	}
+
+	mesh->mvert = (MVert *)MEM_calloc_arrayN(mesh->totvert, sizeof(MVert), __func__);
+	mesh->mloop = (MLoop *)MEM_calloc_arrayN(mesh->totloop, sizeof(MLoop), __func__);
+	mesh->mpoly = (MPoly *)MEM_calloc_arrayN(mesh->totpoly, sizeof(MPoly), __func__);
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			copy_v3_fl3(mesh->mvert[y * size + x].co, x, y, BLI_rng_get_float(rng));
+		}
+	}
+
+	MPoly *mp = mesh->mpoly;
+	MLoop *ml = mesh->mloop;
+	for (int y = 0; y < faces; y++) {
+		for (int x = 0; x < faces; x++) {
+			const unsigned int v[4] = {
+			    (unsigned int)(y * size + x), (unsigned int)(y * size + x + 1),
+			    (unsigned int)((y + 1) * size + x + 1), (unsigned int)((y + 1) * size + x)};
+			if (y & 1) {
+				const int tris[2][3] = {{0, 1, 2}, {0, 2, 3}};
+				for (int t = 0; t < 2; t++, mp++) {
+					mp->loopstart = (int)(ml - mesh->mloop);
+					mp->totloop = 3;
+					for (int i = 0; i < 3; i++, ml++) {
+						ml->v = v[tris[t][i]];
+					}
+				}
+			}
+			else {
+				mp->loopstart = (int)(ml - mesh->mloop);
+				mp->totloop = 4;
+				for (int i = 0; i < 4; i++, ml++) {
+					ml->v = v[i];
+				}
+				mp++;
+			}
+		}
+	}
+
+	BLI_rng_free(rng);
+}
+
+inline void test_mesh_arrays_free(TestMesh *mesh)
+{
+	MEM_freeN(mesh->mvert);
+	MEM_freeN(mesh->mloop);
+	MEM_freeN(mesh->mpoly);
+}
+
+/* -------------------------------------------------------------------- */
+/* Meshes */
+
+/* Mesh of quads with edges and normals calculated. It is added to bmain when given,
+ * otherwise it's outside of any Main and freed with #test_mesh_free. */
+inline Mesh *test_mesh_from_quads(
+        Main *bmain, const float (*co)[3], int totvert, const int (*quads)[4], int totquad)
+{
+	Mesh *me;
+	if (bmain) {
+		me = BKE_mesh_add(bmain, "Mesh");
+	}
+	else {
+		me = (Mesh *)BKE_libblock_alloc_notest(ID_ME);
+		BKE_mesh_init(me);
+	}
+	me->totvert = totvert;
+	me->totloop = totquad * 4;
+	me->totpoly = totquad;
+	CustomData_add_layer(&me->vdata, CD_MVERT, CD_CALLOC, NULL, me->totvert);
+	CustomData_add_layer(&me->ldata, CD_MLOOP, CD_CALLOC, NULL, me->totloop);
+	CustomData_add_layer(&me->pdata, CD_MPOLY, CD_CALLOC, NULL, me->totpoly);
+	BKE_mesh_update_customdata_pointers(me, false);
+
+	for (int i = 0; i < totvert; i++) {
+		copy_v3_v3(me->mvert[i].co, co[i]);
+	}
+	for (int i = 0; i < totquad; i++) {
+		me->mpoly[i].loopstart = i * 4;
+		me->mpoly[i].totloop = 4;
+		for (int j = 0; j < 4; j++) {
+			me->mloop[i * 4 + j].v = (unsigned int)quads[i][j];
+		}
+	}
+
+	BKE_mesh_calc_edges(me, false, false);
+	BKE_mesh_calc_normals(me);
+	return me;
+}
+
+/* Grid of size x size vertices from 0 to 1 in the XY plane at height z. */
+inline Mesh *test_mesh_grid(Main *bmain, int size, float z)
+{
+	const int faces = size - 1;
+	float (*co)[3] = (float (*)[3])MEM_malloc_arrayN(size * size, sizeof(*co), __func__);
+	int (*quads)[4] = (int (*)[4])MEM_malloc_arrayN(faces * faces, sizeof(*quads), __func__);
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			copy_v3_fl3(co[y * size + x], (float)x / faces, (float)y / faces, z);
+		}
+	}
+	for (int y = 0, i = 0; y < faces; y++) {
+		for (int x = 0; x < faces; x++, i++) {
+			quads[i][0] = y * size + x;
+			quads[i][1] = y * size + x + 1;
+			quads[i][2] = (y + 1) * size + x + 1;
+			quads[i][3] = (y + 1) * size + x;
+		}
+	}
+
+	Mesh *me = test_mesh_from_quads(bmain, co, size * size, quads, faces * faces);
+	MEM_freeN(co);
+	MEM_freeN(quads);
+	return me;
+}
+
+/* Closed box around the unit grid with each side split into subdiv x subdiv quads,
+ * faces point outwards. */
+inline Mesh *test_mesh_box(Main *bmain, int subdiv)
+{
+	const int n = subdiv, len = subdiv + 1;
+	const int totvert = len * len * len - (n - 1) * (n - 1) * (n - 1);
+	int *lattice = (int *)MEM_malloc_arrayN(len * len * len, sizeof(int), __func__);
+	float (*co)[3] = (float (*)[3])MEM_malloc_arrayN(totvert, sizeof(*co), __func__);
+	int (*quads)[4] = (int (*)[4])MEM_malloc_arrayN(6 * n * n, sizeof(*quads), __func__);
+	int totco = 0, totquad = 0;
+
+	for (int k = 0; k < len; k++) {
+		for (int j = 0; j < len; j++) {
+			for (int i = 0; i < len; i++) {
+				int *index = &lattice[(k * len + j) * len + i];
+				if (ELEM(i, 0, n) || ELEM(j, 0, n) || ELEM(k, 0, n)) {
+					copy_v3_fl3(co[totco],
+					            -0.25f + 1.5f * i / n,
+					            -0.25f + 1.5f * j / n,
+					            -0.5f + 1.0f * k / n);
+					*index = totco++;
+				}
+				else {
+					*index = -1;
+				}
+			}
+		}
+	}
+
+	for (int a = 0; a < 3; a++) {
+		const int b = (a + 1) % 3, c = (a + 2) % 3;
+		for (int side = 0; side < 2; side++) {
+			for (int v = 0; v < n; v++) {
+				for (int u = 0; u < n; u++) {
+					const int corner[4][2] = {{u, v}, {u + 1, v}, {u + 1, v + 1}, {u, v + 1}};
+					for (int q = 0; q < 4; q++) {
+						int ijk[3];
+						ijk[a] = side * n;
+						ijk[b] = corner[q][0];
+						ijk[c] = corner[q][1];
+						/* (b, c) winding points along +a, flip it for the low side */
+						const int q_dst = side ? q : 3 - q;
+						quads[totquad][q_dst] = lattice[(ijk[2] * len + ijk[1]) * len + ijk[0]];
+					}
+					totquad++;
+				}
+			}
+		}
+	}
+
+	Mesh *me = test_mesh_from_quads(bmain, co, totvert, quads, totquad);
+	MEM_freeN(lattice);
+	MEM_freeN(co);
+	MEM_freeN(quads);
+	return me;
+}
+
+inline float (*test_mesh_vert_cos(Mesh *me))[3]
+{
+	float (*co)[3] = (float (*)[3])MEM_malloc_arrayN(me->totvert, sizeof(*co), __func__);
+	for (int i = 0; i < me->totvert; i++) {
+		copy_v3_v3(co[i], me->mvert[i].co);
+	}
+	return co;
+}
+
+/* Free a mesh created outside of Main. */
+inline void test_mesh_free(Mesh *me)
+{
+	BKE_mesh_free(me);
+	MEM_freeN(me);
+}
+
+/* -------------------------------------------------------------------- */
+/* Armatures */
+
+/* A row of totbone unconnected bones along X, each posed with a small random rotation
+ * and offset, and a mesh of totvert random vertices which are each weighted to totweight
+ * neighboring bones, like a skinned character. The mesh is outside of bmain. */
+inline Mesh *test_armature_skin_create(
+        Main *bmain, Object *ob_arm, Object *ob, int totvert, int totbone, int totweight)
+{
+	RNG *rng = BLI_rng_new(0);
+
+	Mesh *mesh = (Mesh *)BKE_libblock_alloc_notest(ID_ME);
+	BKE_mesh_init(mesh);
+	mesh->totvert = totvert;
+	CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, NULL, mesh->totvert);
+	CustomData_add_layer(&mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, NULL, mesh->totvert);
+	BKE_mesh_update_customdata_pointers(mesh, false);
+	ob->data = mesh;
+
+	bArmature *arm = BKE_armature_add(bmain, "Armature");
+	ob_arm->data = arm;
+	for (int i = 0; i < totbone; i++) {
+		Bone *bone = (Bone *)MEM_callocN(sizeof(Bone), __func__);
+		BLI_snprintf(bone->name, sizeof(bone->name), "Bone%d", i);
+		copy_v3_fl3(bone->head, (float)i / totbone, 0.0f, 0.0f);
+		copy_v3_fl3(bone->tail, (float)i / totbone, 0.0f, 0.1f);
+		bone->weight = 1.0f;
+		bone->dist = 0.25f;
+		bone->rad_head = bone->rad_tail = 0.1f;
+		bone->layer = 1;
+		BLI_addtail(&arm->bonebase, bone);
+
+		BKE_defgroup_new(ob, bone->name);
+	}
+	BKE_armature_where_is(arm);
+	BKE_pose_rebuild(ob_arm, arm);
+
+	for (bPoseChannel *pchan = (bPoseChannel *)ob_arm->pose->chanbase.first; pchan; pchan = pchan->next) {
+		float axis[3], rot[3][3], loc[3], tmat[4][4];
+		BLI_rng_get_float_unit_v3(rng, axis);
+		axis_angle_normalized_to_mat3(rot, axis, 0.5f * BLI_rng_get_float(rng));
+		BLI_rng_get_float_unit_v3(rng, loc);
+		mul_v3_fl(loc, 0.1f);
+
+		/* rotate around the bone head, like a posed bone would */
+		unit_m4(pchan->chan_mat);
+		copy_v3_v3(pchan->chan_mat[3], pchan->bone->arm_head);
+		copy_m4_m3(tmat, rot);
+		mul_m4_m4m4(pchan->chan_mat, pchan->chan_mat, tmat);
+		unit_m4(tmat);
+		negate_v3_v3(tmat[3], pchan->bone->arm_head);
+		mul_m4_m4m4(pchan->chan_mat, pchan->chan_mat, tmat);
+		add_v3_v3(pchan->chan_mat[3], loc);
+	}
+
+	for (int i = 0; i < mesh->totvert; i++) {
+		const float x = BLI_rng_get_float(rng);
+		copy_v3_fl3(mesh->mvert[i].co, x, BLI_rng_get_float(rng) * 0.2f - 0.1f, BLI_rng_get_float(rng) * 0.1f);
+
+		const int first = min_ii((int)(x * totbone), totbone - totweight);
+		for (int j = 0; j < totweight; j++) {
+			defvert_add_index_notest(&mesh->dvert[i], first + j, 0.05f + BLI_rng_get_float(rng));
+		}
+	}
+
+	BLI_rng_free(rng);
+	return mesh;
+}
+
+/* -------------------------------------------------------------------- */
+/* Custom Data */
+
+/* Adds layers of random UVs, colors and normals for totelem elements. */
+inline void test_customdata_random_layers(
+        CustomData *data, int totelem, int uv_layers, int col_layers, int nor_layers, RNG *rng)
+{
+	for (int i = 0; i < uv_layers; i++) {
+		MLoopUV *luv = (MLoopUV *)CustomData_add_layer(data, CD_MLOOPUV, CD_CALLOC, NULL, totelem);
+		for (int j = 0; j < totelem; j++) {
+			luv[j].uv[0] = BLI_rng_get_float(rng);
+			luv[j].uv[1] = BLI_rng_get_float(rng);
+			luv[j].flag = (BLI_rng_get_int(rng) & 1) ? MLOOPUV_PINNED : 0;
+		}
+	}
+	for (int i = 0; i < col_layers; i++) {
+		MLoopCol *mcol = (MLoopCol *)CustomData_add_layer(data, CD_MLOOPCOL, CD_CALLOC, NULL, totelem);
+		for (int j = 0; j < totelem; j++) {
+			mcol[j].r = (unsigned char)BLI_rng_get_int(rng);
+			mcol[j].g = (unsigned char)BLI_rng_get_int(rng);
+			mcol[j].b = (unsigned char)BLI_rng_get_int(rng);
+			mcol[j].a = (unsigned char)BLI_rng_get_int(rng);
+		}
+	}
+	for (int i = 0; i < nor_layers; i++) {
+		float (*nor)[3] = (float (*)[3])CustomData_add_layer(data, CD_NORMAL, CD_CALLOC, NULL, totelem);
+		for (int j = 0; j < totelem; j++) {
+			BLI_rng_get_float_unit_v3(rng, nor[j]);
+		}
+	}
+}
+
+/* Interpolates each of totelem elements from random sources out of totsrc_elem,
+ * with normalized weights. Elements use totsrc_max sources, or when vary_totsrc
+ * is set, a number going from 1 to totsrc_max. */
+inline CustomDataInterpPlan *test_customdata_interp_plan(
+        int totelem, int totsrc_elem, int totsrc_max, bool vary_totsrc, RNG *rng)
+{
+	CustomDataInterpPlan *plan = CustomData_interp_plan_new(totelem, totelem * totsrc_max);
+	int offset = 0;
+	for (int i = 0; i < totelem; i++) {
+		const int totsrc = vary_totsrc ? 1 + i % totsrc_max : totsrc_max;
+		float totweight = 0.0f;
+		for (int j = 0; j < totsrc; j++) {
+			plan->src_indices[offset + j] = BLI_rng_get_int(rng) % totsrc_elem;
+			plan->weights[offset + j] = BLI_rng_get_float(rng) + 0.01f;
+			totweight += plan->weights[offset + j];
+		}
+		for (int j = 0; j < totsrc; j++) {
+			plan->weights[offset + j] /= totweight;
+		}
+		plan->offsets[i] = offset;
+		offset += totsrc;
+	}
+	plan->offsets[totelem] = offset;
+	return plan;
+}
+
+#endif  /* __BLENDER_TESTING_BKE_TEST_UTIL_H__ */
@@ -0,0 +1,110 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_kdtree.h"
+#include "BLI_spatial_hash.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "BLI_math_vector.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Run the longest tests! */
+//#define SPATIAL_HASH_RUN_BIG
+
+#ifdef SPATIAL_HASH_RUN_BIG
+#  define POINTS_LEN 20000000
+#else
+#  define POINTS_LEN 1000000
+#endif
+
+#define MERGE_DIST 0.0001f
+
+/* Noisy height-field (like a scan), every 50th point is doubled within the merge distance. */
+static float (*points_scan_create(int points_len))[3]
+{
+	RNG *rng = BLI_rng_new(0);
+	float (*points)[3] = (float (*)[3])MEM_malloc_arrayN(points_len, sizeof(float[3]), __func__);
+	const int size = (int)sqrtf((float)points_len);
+
+	for (int i = 0; i < points_len; i++) {
+		if ((i % 50) == 49) {
+			copy_v3_v3(points[i], points[i - 1]);
+			points[i][0] += MERGE_DIST * 0.5f * BLI_rng_get_float(rng);
+		}
+		else {
+			const float x = (float)(i % size) / size;
+			const float y = (float)(i / size) / size;
+			copy_v3_fl3(points[i], x, y, 0.1f * sinf(x * 20.0f) * cosf(y * 20.0f) + 0.001f * BLI_rng_get_float(rng));
+		}
+	}
+
+	BLI_rng_free(rng);
+	return points;
+}
+
+static void spatial_hash_duplicates(const float (*points)[3], int points_len, int *duplicates)
+{
+	SpatialHash *hash = BLI_spatial_hash_new(points_len, MERGE_DIST * 2.0f);
+	for (int i = 0; i < points_len; i++) {
+		BLI_spatial_hash_insert(hash, i, points[i]);
+		duplicates[i] = -1;
+	}
+	BLI_spatial_hash_balance(hash);
+	BLI_spatial_hash_calc_duplicates(hash, MERGE_DIST, duplicates);
+	BLI_spatial_hash_free(hash);
+}
+
+TEST(spatial_hash, CalcDuplicatesPerformance)
+{
+	float (*points)[3] = points_scan_create(POINTS_LEN);
+	int *duplicates = (int *)MEM_malloc_arrayN(POINTS_LEN, sizeof(int), __func__);
+	int *duplicates_ref = (int *)MEM_malloc_arrayN(POINTS_LEN, sizeof(int), __func__);
+
+	BLI_threadapi_init();
+
+	printf("\n========== %d points ==========\n", POINTS_LEN);
+
+	{
+		TIMEIT_START(kdtree);
+		KDTree *tree = BLI_kdtree_new(POINTS_LEN);
+		for (int i = 0; i < POINTS_LEN; i++) {
+			BLI_kdtree_insert(tree, i, points[i]);
+			duplicates_ref[i] = -1;
+		}
+		BLI_kdtree_balance(tree);
+		BLI_kdtree_calc_duplicates_fast(tree, MERGE_DIST, true, duplicates_ref);
+		BLI_kdtree_free(tree);
+		TIMEIT_END(kdtree);
+	}
+
+	/* Thread count is only read when the task scheduler is created. */
+	const int threads_max = BLI_system_thread_count();
+	for (int threads = 1; ; threads = min_ii(threads * 2, threads_max)) {
+		BLI_threadapi_exit();
+		BLI_system_num_threads_override_set(threads);
+		BLI_threadapi_init();
+
+		printf("%d threads:\n", threads);
+		TIMEIT_START(spatial_hash);
+		spatial_hash_duplicates(points, POINTS_LEN, duplicates);
+		TIMEIT_END(spatial_hash);
+
+		EXPECT_EQ_ARRAY(duplicates_ref, duplicates, POINTS_LEN);
+
+		if (threads == threads_max) {
+			break;
+		}
+	}
+
+	BLI_threadapi_exit();
+	BLI_system_num_threads_override_set(0);
+
+	MEM_freeN(points);
+	MEM_freeN(duplicates);
+	MEM_freeN(duplicates_ref);
+}
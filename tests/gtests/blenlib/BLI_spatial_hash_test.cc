@@ -0,0 +1,158 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_compiler_attrs.h"
+#include "BLI_kdtree.h"
+#include "BLI_spatial_hash.h"
+#include "BLI_rand.h"
+#include "BLI_math_vector.h"
+#include "MEM_guardedalloc.h"
+}
+
+#include <float.h>
+#include <math.h>
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static void rng_v3_round(
+        float *coords, int coords_len,
+        struct RNG *rng, int round, float scale)
+{
+	for (int i = 0; i < coords_len; i++) {
+		float f = BLI_rng_get_float(rng) * 2.0f - 1.0f;
+		coords[i] = ((float)((int)(f * round)) / (float)round) * scale;
+	}
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+TEST(spatial_hash, Empty)
+{
+	SpatialHash *hash = BLI_spatial_hash_new(0, 0.1f);
+	const float co[3] = {0.0f, 0.0f, 0.0f};
+	BLI_spatial_hash_balance(hash);
+	EXPECT_EQ(-1, BLI_spatial_hash_find_nearest(hash, co, 1.0f, NULL));
+	BLI_spatial_hash_free(hash);
+}
+
+TEST(spatial_hash, Single)
+{
+	SpatialHash *hash = BLI_spatial_hash_new(1, 0.1f);
+	const float co[3] = {1.0f, 2.0f, 3.0f};
+	const float co_near[3] = {1.05f, 2.0f, 3.0f};
+	const float co_far[3] = {1.2f, 2.0f, 3.0f};
+	float dist_sq;
+	BLI_spatial_hash_insert(hash, 0, co);
+	BLI_spatial_hash_balance(hash);
+	EXPECT_EQ(0, BLI_spatial_hash_find_nearest(hash, co_near, 0.1f, &dist_sq));
+	EXPECT_NEAR(0.05f * 0.05f, dist_sq, 1e-6f);
+	EXPECT_EQ(-1, BLI_spatial_hash_find_nearest(hash, co_far, 0.1f, NULL));
+	/* ranges much larger than the cell size */
+	EXPECT_EQ(0, BLI_spatial_hash_find_nearest(hash, co_far, 100.0f, NULL));
+	BLI_spatial_hash_free(hash);
+}
+
+/* Points which aren't finite are never found or merged. */
+TEST(spatial_hash, NonFinite)
+{
+	SpatialHash *hash = BLI_spatial_hash_new(4, 0.1f);
+	const float co[3] = {0.0f, 0.0f, 0.0f};
+	const float co_nan[3] = {NAN, 0.0f, 0.0f};
+	const float co_inf[3] = {INFINITY, 0.0f, 0.0f};
+	const float co_huge[3] = {FLT_MAX, -FLT_MAX, 0.0f};
+	int duplicates[4] = {-1, -1, -1, -1};
+	BLI_spatial_hash_insert(hash, 0, co_nan);
+	BLI_spatial_hash_insert(hash, 1, co_inf);
+	BLI_spatial_hash_insert(hash, 2, co);
+	BLI_spatial_hash_insert(hash, 3, co_huge);
+	BLI_spatial_hash_balance(hash);
+	EXPECT_EQ(2, BLI_spatial_hash_find_nearest(hash, co, 1.0f, NULL));
+	EXPECT_EQ(3, BLI_spatial_hash_find_nearest(hash, co_huge, 1.0f, NULL));
+	EXPECT_EQ(-1, BLI_spatial_hash_find_nearest(hash, co_nan, 1.0f, NULL));
+	EXPECT_EQ(-1, BLI_spatial_hash_find_nearest(hash, co_inf, FLT_MAX, NULL));
+	/* ranges beyond the cell coordinates */
+	EXPECT_EQ(2, BLI_spatial_hash_find_nearest(hash, co, FLT_MAX, NULL));
+	EXPECT_EQ(0, BLI_spatial_hash_calc_duplicates(hash, 0.1f, duplicates));
+	BLI_spatial_hash_free(hash);
+}
+
+static void find_nearest_test(int points_len, float range, int round, int random_seed)
+{
+	struct RNG *rng = BLI_rng_new(random_seed);
+	SpatialHash *hash = BLI_spatial_hash_new(points_len, range);
+
+	float (*points)[3] = (float (*)[3])MEM_malloc_arrayN(points_len, sizeof(float[3]), __func__);
+
+	for (int i = 0; i < points_len; i++) {
+		rng_v3_round(points[i], 3, rng, round, 1.0f);
+		BLI_spatial_hash_insert(hash, i, points[i]);
+	}
+	BLI_spatial_hash_balance(hash);
+
+	for (int i = 0; i < points_len; i++) {
+		float co[3];
+		rng_v3_round(co, 3, rng, round, 1.0f);
+
+		int j_expect = -1;
+		float dist_sq_expect = range * range;
+		for (int j = 0; j < points_len; j++) {
+			const float dist_sq = len_squared_v3v3(co, points[j]);
+			if ((dist_sq < dist_sq_expect) || (dist_sq == dist_sq_expect && j_expect == -1)) {
+				j_expect = j;
+				dist_sq_expect = dist_sq;
+			}
+		}
+		EXPECT_EQ(j_expect, BLI_spatial_hash_find_nearest(hash, co, range, NULL));
+	}
+
+	BLI_spatial_hash_free(hash);
+	BLI_rng_free(rng);
+	MEM_freeN(points);
+}
+
+TEST(spatial_hash, FindNearest_500)		{ find_nearest_test(500, 0.15f, 1000, 12); }
+TEST(spatial_hash, FindNearest_Dense)	{ find_nearest_test(2000, 0.0155f, 50, 123); }
+
+/**
+ * Duplicates are expected to match the kd-tree looping over points in index order.
+ */
+static void calc_duplicates_test(int points_len, float range, int round, bool use_keep, int random_seed)
+{
+	struct RNG *rng = BLI_rng_new(random_seed);
+	SpatialHash *hash = BLI_spatial_hash_new(points_len, range);
+	KDTree *tree = BLI_kdtree_new(points_len);
+
+	int *duplicates_hash = (int *)MEM_malloc_arrayN(points_len, sizeof(int), __func__);
+	int *duplicates_tree = (int *)MEM_malloc_arrayN(points_len, sizeof(int), __func__);
+
+	for (int i = 0; i < points_len; i++) {
+		float co[3];
+		rng_v3_round(co, 3, rng, round, 1.0f);
+		BLI_spatial_hash_insert(hash, i, co);
+		BLI_kdtree_insert(tree, i, co);
+		duplicates_hash[i] = duplicates_tree[i] = (use_keep && (i % 7) == 0) ? i : -1;
+	}
+	BLI_spatial_hash_balance(hash);
+	BLI_kdtree_balance(tree);
+
+	const int found_hash = BLI_spatial_hash_calc_duplicates(hash, range, duplicates_hash);
+	const int found_tree = BLI_kdtree_calc_duplicates_fast(tree, range, true, duplicates_tree);
+
+	EXPECT_GT(found_hash, 0);
+	EXPECT_EQ(found_tree, found_hash);
+	EXPECT_EQ_ARRAY(duplicates_tree, duplicates_hash, points_len);
+
+	BLI_spatial_hash_free(hash);
+	BLI_kdtree_free(tree);
+	BLI_rng_free(rng);
+	MEM_freeN(duplicates_hash);
+	MEM_freeN(duplicates_tree);
+}
+
+TEST(spatial_hash, CalcDuplicates_Exact)	{ calc_duplicates_test(5000, 1e-5f, 10, false, 1234); }
+TEST(spatial_hash, CalcDuplicates_Range)	{ calc_duplicates_test(20000, 0.0415f, 100, false, 12); }
+TEST(spatial_hash, CalcDuplicates_Keep)		{ calc_duplicates_test(20000, 0.0415f, 100, true, 123); }
@@ -0,0 +1,174 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "bmesh.h"
+#include "tools/bmesh_decimate.h"
+}
+
+class bmesh_decimate : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+/* Triangulated UV sphere with some noise, similar to a scan. */
+static BMesh *test_bmesh_uvsphere(int segments)
+{
+	const int rings = segments / 2;
+	BMVert **verts = (BMVert **)MEM_malloc_arrayN((rings - 1) * segments, sizeof(BMVert *), __func__);
+	BMVert *v_pole[2];
+	RNG *rng = BLI_rng_new(0);
+	float co[3];
+
+	BMeshCreateParams create_params = {0};
+	BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+
+	for (int r = 1; r < rings; r++) {
+		const float phi = (float)M_PI * r / rings;
+		for (int u = 0; u < segments; u++) {
+			const float theta = 2.0f * (float)M_PI * u / segments;
+			const float radius = 1.0f + BLI_rng_get_float(rng) * 0.01f;
+			copy_v3_fl3(co, sinf(phi) * cosf(theta), sinf(phi) * sinf(theta), cosf(phi));
+			mul_v3_fl(co, radius);
+			verts[(r - 1) * segments + u] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+		}
+	}
+	for (int i = 0; i < 2; i++) {
+		copy_v3_fl3(co, 0.0f, 0.0f, i ? -1.0f : 1.0f);
+		v_pole[i] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+	}
+
+	for (int u = 0; u < segments; u++) {
+		const int u_next = (u + 1) % segments;
+		BMVert *v_tri[3];
+		v_tri[0] = v_pole[0];
+		v_tri[1] = verts[u];
+		v_tri[2] = verts[u_next];
+		BM_face_create_verts(bm, v_tri, 3, NULL, BM_CREATE_NOP, true);
+
+		for (int r = 1; r < rings - 1; r++) {
+			BMVert *v_quad[4] = {
+			    verts[(r - 1) * segments + u], verts[r * segments + u],
+			    verts[r * segments + u_next], verts[(r - 1) * segments + u_next]};
+			v_tri[0] = v_quad[0];
+			v_tri[1] = v_quad[1];
+			v_tri[2] = v_quad[2];
+			BM_face_create_verts(bm, v_tri, 3, NULL, BM_CREATE_NOP, true);
+			v_tri[1] = v_quad[2];
+			v_tri[2] = v_quad[3];
+			BM_face_create_verts(bm, v_tri, 3, NULL, BM_CREATE_NOP, true);
+		}
+
+		v_tri[0] = v_pole[1];
+		v_tri[1] = verts[(rings - 2) * segments + u_next];
+		v_tri[2] = verts[(rings - 2) * segments + u];
+		BM_face_create_verts(bm, v_tri, 3, NULL, BM_CREATE_NOP, true);
+	}
+
+	BM_mesh_normals_update(bm);
+	BM_mesh_elem_index_ensure(bm, BM_ALL);
+
+	MEM_freeN(verts);
+	BLI_rng_free(rng);
+	return bm;
+}
+
+/* Every edge uses two faces and every face is a triangle
+ * (#BM_mesh_validate is only available in debug builds). */
+static bool test_bmesh_is_closed_tris(BMesh *bm)
+{
+	BMIter iter;
+	BMEdge *e;
+	BMFace *f;
+	BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
+		if (!BM_edge_is_manifold(e) || BM_edge_find_double(e)) {
+			return false;
+		}
+	}
+	BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+		if (f->len != 3) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Largest distance from the unit sphere. */
+static float test_bmesh_sphere_error(BMesh *bm)
+{
+	BMIter iter;
+	BMVert *v;
+	float error = 0.0f;
+	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+		error = max_ff(error, fabsf(len_v3(v->co) - 1.0f));
+	}
+	return error;
+}
+
+TEST_F(bmesh_decimate, Target)
+{
+	BMesh *bm = test_bmesh_uvsphere(64);
+	const int face_tot_target = (int)(bm->totface * 0.25f);
+
+	BM_mesh_decimate_collapse(bm, 0.25f, NULL, 0.0f, true, -1, 0.0f);
+
+	EXPECT_LE(bm->totface, face_tot_target);
+	EXPECT_GE(bm->totface, face_tot_target - 1);
+	EXPECT_TRUE(test_bmesh_is_closed_tris(bm));
+	EXPECT_EQ(bm->totvert - bm->totedge + bm->totface, 2);
+	EXPECT_LT(test_bmesh_sphere_error(bm), 0.02f);
+
+	BM_mesh_free(bm);
+}
+
+/* Vertices with no weight are kept. */
+TEST_F(bmesh_decimate, Weights)
+{
+	BMesh *bm = test_bmesh_uvsphere(64);
+	BMIter iter;
+	BMVert *v;
+	int i;
+
+	float *vweights = (float *)MEM_malloc_arrayN(bm->totvert, sizeof(float), __func__);
+	float (*keep_cos)[3] = (float (*)[3])MEM_malloc_arrayN(bm->totvert, sizeof(float[3]), __func__);
+	int keep_tot = 0;
+	BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+		vweights[i] = (v->co[2] > 0.0f) ? 0.0f : 1.0f;
+		if (vweights[i] == 0.0f) {
+			copy_v3_v3(keep_cos[keep_tot++], v->co);
+		}
+	}
+
+	BM_mesh_decimate_collapse(bm, 0.75f, vweights, 1.0f, true, -1, 0.0f);
+
+	EXPECT_LT(bm->totvert, keep_tot * 2);
+	for (i = 0; i < keep_tot; i++) {
+		bool found = false;
+		BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+			if (equals_v3v3(v->co, keep_cos[i])) {
+				found = true;
+				break;
+			}
+		}
+		EXPECT_TRUE(found);
+	}
+	EXPECT_TRUE(test_bmesh_is_closed_tris(bm));
+
+	MEM_freeN(vweights);
+	MEM_freeN(keep_cos);
+	BM_mesh_free(bm);
+}
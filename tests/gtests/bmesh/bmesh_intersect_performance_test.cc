@@ -0,0 +1,95 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_threads.h"
+#include "bmesh.h"
+#include "tools/bmesh_intersect.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "bmesh_test_util.h"
+
+/* Run the longest tests! */
+//#define INTERSECT_RUN_BIG
+
+#ifdef INTERSECT_RUN_BIG
+#  define MESH_ITERATIONS 10
+#else
+#  define MESH_ITERATIONS 1
+#endif
+
+class bmesh_intersect : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(bmesh_intersect, Performance)
+{
+	for (int i = 0; i < MESH_ITERATIONS; i++) {
+		{
+			/* Two dense spheres, few overlapping pairs intersect. */
+			const float loc_a[3] = {0.0f, 0.0f, 0.0f};
+			const float loc_b[3] = {0.3f, 0.2f, 0.1f};
+			BMesh *bm = test_bmesh_new();
+			test_bmesh_add_uvsphere(bm, 512, 2.0f, loc_b);
+			test_bmesh_tag_operand(bm);
+			test_bmesh_add_uvsphere(bm, 512, 2.0f, loc_a);
+
+			printf("\n========== sphere union, %d faces ==========\n", bm->totface);
+			TIMEIT_START(sphere_union);
+			test_bmesh_intersect(bm, BMESH_ISECT_BOOLEAN_UNION);
+			TIMEIT_END(sphere_union);
+			printf("result: %d vertices, %d faces\n", bm->totvert, bm->totface);
+			BM_mesh_free(bm);
+		}
+
+		{
+			/* Nested spheres, overlapping pairs which never intersect. */
+			const float loc[3] = {0.0f, 0.0f, 0.0f};
+			BMesh *bm = test_bmesh_new();
+			test_bmesh_add_uvsphere(bm, 512, 2.0f, loc);
+			test_bmesh_tag_operand(bm);
+			test_bmesh_add_uvsphere(bm, 512, 1.99f, loc);
+
+			printf("\n========== nested spheres, %d faces ==========\n", bm->totface);
+			TIMEIT_START(sphere_nested);
+			test_bmesh_intersect(bm, BMESH_ISECT_BOOLEAN_NONE);
+			TIMEIT_END(sphere_nested);
+			printf("result: %d vertices, %d faces\n", bm->totvert, bm->totface);
+			BM_mesh_free(bm);
+		}
+
+		{
+			/* Dense panel with many small cutters, many islands. */
+			BMesh *bm = test_bmesh_new();
+			for (int x = 0; x < 16; x++) {
+				for (int y = 0; y < 16; y++) {
+					const float loc[3] = {x * 0.12f - 0.9f, y * 0.12f - 0.9f, 0.0f};
+					test_bmesh_add_cube(bm, 0.05f, loc);
+				}
+			}
+			test_bmesh_tag_operand(bm);
+			test_bmesh_add_grid(bm, 400, 1.0f);
+
+			printf("\n========== panel difference, %d faces ==========\n", bm->totface);
+			TIMEIT_START(panel_difference);
+			test_bmesh_intersect(bm, BMESH_ISECT_BOOLEAN_DIFFERENCE);
+			TIMEIT_END(panel_difference);
+			printf("result: %d vertices, %d faces\n", bm->totvert, bm->totface);
+			BM_mesh_free(bm);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_threads.h"
+#include "bmesh.h"
+#include "tools/bmesh_intersect.h"
+}
+
+#include "bmesh_test_util.h"
+
+class bmesh_intersect : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+static bool test_bmesh_is_manifold(BMesh *bm)
+{
+	BMIter iter;
+	BMEdge *e;
+	BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
+		if (!BM_edge_is_manifold(e)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_F(bmesh_intersect, CubeUnion)
+{
+	const float loc_a[3] = {0.0f, 0.0f, 0.0f};
+	const float loc_b[3] = {0.5f, 0.5f, 0.5f};
+	BMesh *bm = test_bmesh_new();
+
+	test_bmesh_add_cube(bm, 1.0f, loc_b);
+	test_bmesh_tag_operand(bm);
+	test_bmesh_add_cube(bm, 1.0f, loc_a);
+
+	EXPECT_TRUE(test_bmesh_intersect(bm, BMESH_ISECT_BOOLEAN_UNION));
+	EXPECT_TRUE(test_bmesh_is_manifold(bm));
+	/* 3 faces of each cube are cut into an L shape, the other 3 are kept. */
+	EXPECT_EQ(bm->totface, 12);
+
+	BM_mesh_free(bm);
+}
+
+/* Bounding boxes of the inner spheres triangles overlap the outer sphere,
+ * but none of the triangles intersect. */
+TEST_F(bmesh_intersect, NestedNoIntersection)
+{
+	const float loc[3] = {0.0f, 0.0f, 0.0f};
+	BMesh *bm = test_bmesh_new();
+
+	test_bmesh_add_uvsphere(bm, 32, 1.0f, loc);
+	test_bmesh_tag_operand(bm);
+	test_bmesh_add_uvsphere(bm, 32, 0.95f, loc);
+
+	const int totvert = bm->totvert, totface = bm->totface;
+	EXPECT_FALSE(test_bmesh_intersect(bm, BMESH_ISECT_BOOLEAN_NONE));
+	EXPECT_EQ(bm->totvert, totvert);
+	EXPECT_EQ(bm->totface, totface);
+
+	BM_mesh_free(bm);
+}
@@ -0,0 +1,148 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"  /* SELECT */
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+#include "bmesh.h"
+}
+
+class bmesh_mesh_conv : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+/* Noisy grid of size x size vertices with UVs, every other vertex is selected. */
+static Mesh *test_mesh_grid(int size)
+{
+	const int faces = size - 1;
+	const int totvert = size * size;
+	const int totpoly = faces * faces;
+	const int totloop = totpoly * 4;
+	RNG *rng = BLI_rng_new(0);
+
+	Mesh *me = (Mesh *)MEM_callocN(sizeof(Mesh), __func__);
+	BKE_mesh_init(me);
+
+	CustomData_add_layer(&me->vdata, CD_MVERT, CD_CALLOC, NULL, totvert);
+	CustomData_add_layer(&me->ldata, CD_MLOOP, CD_CALLOC, NULL, totloop);
+	CustomData_add_layer(&me->ldata, CD_MLOOPUV, CD_CALLOC, NULL, totloop);
+	CustomData_add_layer(&me->pdata, CD_MPOLY, CD_CALLOC, NULL, totpoly);
+	me->totvert = totvert;
+	me->totloop = totloop;
+	me->totpoly = totpoly;
+	BKE_mesh_update_customdata_pointers(me, false);
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			MVert *mv = &me->mvert[y * size + x];
+			copy_v3_fl3(mv->co, x, y, BLI_rng_get_float(rng));
+			mv->no[2] = SHRT_MAX;
+			mv->flag = (x & 1) ? SELECT : 0;
+		}
+	}
+
+	MPoly *mp = me->mpoly;
+	MLoop *ml = me->mloop;
+	MLoopUV *mluv = me->mloopuv;
+	for (int y = 0; y < faces; y++) {
+		for (int x = 0; x < faces; x++, mp++) {
+			const int v[4] = {y * size + x, y * size + x + 1, (y + 1) * size + x + 1, (y + 1) * size + x};
+			mp->loopstart = (int)(ml - me->mloop);
+			mp->totloop = 4;
+			mp->flag = ME_SMOOTH;
+			for (int i = 0; i < 4; i++, ml++, mluv++) {
+				ml->v = v[i];
+				copy_v2_fl2(mluv->uv, (float)(v[i] % size) / faces, (float)(v[i] / size) / faces);
+			}
+		}
+	}
+
+	BKE_mesh_calc_edges(me, false, false);
+
+	BLI_rng_free(rng);
+	return me;
+}
+
+static void test_mesh_free(Mesh *me)
+{
+	BKE_mesh_free(me);
+	MEM_freeN(me);
+}
+
+static BMesh *test_bmesh_from_mesh(Mesh *me)
+{
+	const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(me);
+	BMeshCreateParams create_params = {0};
+	BMeshFromMeshParams convert_params = {0};
+	create_params.use_toolflags = true;
+	convert_params.calc_face_normal = true;
+
+	BMesh *bm = BM_mesh_create(&allocsize, &create_params);
+	BM_mesh_bm_from_me(bm, me, &convert_params);
+	return bm;
+}
+
+/* Converting to BMesh and back must give the same mesh. */
+TEST_F(bmesh_mesh_conv, RoundTrip)
+{
+	Mesh *me = test_mesh_grid(50);
+	Mesh *me_dst = (Mesh *)MEM_callocN(sizeof(Mesh), __func__);
+	BKE_mesh_init(me_dst);
+
+	BMesh *bm = test_bmesh_from_mesh(me);
+	EXPECT_EQ(bm->totvert, me->totvert);
+	EXPECT_EQ(bm->totedge, me->totedge);
+	EXPECT_EQ(bm->totface, me->totpoly);
+	EXPECT_EQ(bm->totloop, me->totloop);
+	EXPECT_EQ(bm->totvertsel, me->totvert / 2);
+
+	BMeshToMeshParams to_params = {0};
+	BM_mesh_bm_to_me(bm, me_dst, &to_params);
+	BM_mesh_free(bm);
+
+	ASSERT_EQ(me_dst->totvert, me->totvert);
+	ASSERT_EQ(me_dst->totedge, me->totedge);
+	ASSERT_EQ(me_dst->totpoly, me->totpoly);
+	ASSERT_EQ(me_dst->totloop, me->totloop);
+	ASSERT_TRUE(me_dst->mloopuv != NULL);
+
+	for (int i = 0; i < me->totvert; i++) {
+		EXPECT_TRUE(equals_v3v3(me->mvert[i].co, me_dst->mvert[i].co));
+		EXPECT_EQ(me->mvert[i].flag & SELECT, me_dst->mvert[i].flag & SELECT);
+	}
+	for (int i = 0; i < me->totedge; i++) {
+		EXPECT_EQ(me->medge[i].v1, me_dst->medge[i].v1);
+		EXPECT_EQ(me->medge[i].v2, me_dst->medge[i].v2);
+	}
+	for (int i = 0; i < me->totpoly; i++) {
+		EXPECT_EQ(me->mpoly[i].loopstart, me_dst->mpoly[i].loopstart);
+		EXPECT_EQ(me->mpoly[i].totloop, me_dst->mpoly[i].totloop);
+		EXPECT_EQ(me->mpoly[i].flag & ME_SMOOTH, me_dst->mpoly[i].flag & ME_SMOOTH);
+	}
+	for (int i = 0; i < me->totloop; i++) {
+		EXPECT_EQ(me->mloop[i].v, me_dst->mloop[i].v);
+		EXPECT_EQ(me->mloop[i].e, me_dst->mloop[i].e);
+		EXPECT_TRUE(equals_v2v2(me->mloopuv[i].uv, me_dst->mloopuv[i].uv));
+	}
+
+	test_mesh_free(me_dst);
+	test_mesh_free(me);
+}
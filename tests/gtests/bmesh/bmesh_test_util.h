@@ -0,0 +1,146 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __BLENDER_TESTING_BMESH_TEST_UTIL_H__
+#define __BLENDER_TESTING_BMESH_TEST_UTIL_H__
+
+/* Fixture factories shared by the bmesh correctness and performance tests. */
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "bmesh.h"
+#include "tools/bmesh_intersect.h"
+}
+
+/* Faces of the second operand, same as the boolean modifier. */
+#define BM_FACE_TAG BM_ELEM_DRAW
+
+inline int bm_face_isect_pair(BMFace *f, void *UNUSED(user_data))
+{
+	return BM_elem_flag_test(f, BM_FACE_TAG) ? 1 : 0;
+}
+
+inline BMesh *test_bmesh_new(void)
+{
+	BMeshCreateParams create_params = {0};
+	create_params.use_toolflags = true;
+	return BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+}
+
+/* Faces added since the last call are tagged as the second operand. */
+inline void test_bmesh_tag_operand(BMesh *bm)
+{
+	BMIter iter;
+	BMFace *f;
+	BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+		BM_elem_flag_enable(f, BM_FACE_TAG);
+	}
+}
+
+/* UV sphere around the Z axis,
+ * the "create_uvsphere" operator is too slow for dense spheres. */
+inline void test_bmesh_add_uvsphere(BMesh *bm, int segments, float diameter, const float loc[3])
+{
+	const int rings = segments / 2;
+	const float radius = diameter * 0.5f;
+	BMVert **verts = (BMVert **)MEM_malloc_arrayN((rings - 1) * segments, sizeof(BMVert *), __func__);
+	BMVert *v_pole[2];
+	float co[3];
+
+	for (int r = 1; r < rings; r++) {
+		const float phi = (float)M_PI * r / rings;
+		for (int u = 0; u < segments; u++) {
+			const float theta = 2.0f * (float)M_PI * u / segments;
+			copy_v3_fl3(co, sinf(phi) * cosf(theta), sinf(phi) * sinf(theta), cosf(phi));
+			madd_v3_v3v3fl(co, loc, co, radius);
+			verts[(r - 1) * segments + u] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+		}
+	}
+	for (int i = 0; i < 2; i++) {
+		copy_v3_fl3(co, 0.0f, 0.0f, i ? -radius : radius);
+		add_v3_v3(co, loc);
+		v_pole[i] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+	}
+
+	for (int u = 0; u < segments; u++) {
+		const int u_next = (u + 1) % segments;
+		BMVert *v_tri[3];
+		v_tri[0] = v_pole[0];
+		v_tri[1] = verts[u];
+		v_tri[2] = verts[u_next];
+		BM_face_create_verts(bm, v_tri, 3, NULL, BM_CREATE_NOP, true);
+
+		for (int r = 1; r < rings - 1; r++) {
+			BMVert *v_quad[4] = {
+			    verts[(r - 1) * segments + u], verts[r * segments + u],
+			    verts[r * segments + u_next], verts[(r - 1) * segments + u_next]};
+			BM_face_create_verts(bm, v_quad, 4, NULL, BM_CREATE_NOP, true);
+		}
+
+		v_tri[0] = v_pole[1];
+		v_tri[1] = verts[(rings - 2) * segments + u_next];
+		v_tri[2] = verts[(rings - 2) * segments + u];
+		BM_face_create_verts(bm, v_tri, 3, NULL, BM_CREATE_NOP, true);
+	}
+
+	MEM_freeN(verts);
+}
+
+inline void test_bmesh_add_cube(BMesh *bm, float size, const float loc[3])
+{
+	float mat[4][4];
+	unit_m4(mat);
+	copy_v3_v3(mat[3], loc);
+	BMO_op_callf(bm, BMO_FLAG_DEFAULTS,
+	             "create_cube size=%f matrix=%m4 calc_uvs=%b",
+	             size, mat, false);
+}
+
+/* Grid in the XY plane from -size to size. */
+inline void test_bmesh_add_grid(BMesh *bm, int segments, float size)
+{
+	const int size_v = segments + 1;
+	BMVert **verts = (BMVert **)MEM_malloc_arrayN(size_v * size_v, sizeof(BMVert *), __func__);
+
+	for (int y = 0; y < size_v; y++) {
+		for (int x = 0; x < size_v; x++) {
+			const float co[3] = {
+			    size * (2.0f * x / segments - 1.0f), size * (2.0f * y / segments - 1.0f), 0.0f};
+			verts[y * size_v + x] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+		}
+	}
+	for (int y = 0; y < segments; y++) {
+		for (int x = 0; x < segments; x++) {
+			BMVert *v_quad[4] = {
+			    verts[y * size_v + x], verts[y * size_v + x + 1],
+			    verts[(y + 1) * size_v + x + 1], verts[(y + 1) * size_v + x]};
+			BM_face_create_verts(bm, v_quad, 4, NULL, BM_CREATE_NOP, true);
+		}
+	}
+
+	MEM_freeN(verts);
+}
+
+inline bool test_bmesh_intersect(BMesh *bm, const int boolean_mode)
+{
+	const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
+	BMLoop *(*looptris)[3] = (BMLoop *(*)[3])MEM_malloc_arrayN(looptris_tot, sizeof(*looptris), __func__);
+	int tottri;
+	bool has_isect;
+
+	BM_mesh_elem_hflag_disable_all(bm, BM_VERT | BM_EDGE, BM_ELEM_TAG, false);
+	BM_mesh_normals_update(bm);
+	BM_mesh_calc_tessellation_beauty(bm, looptris, &tottri);
+
+	has_isect = BM_mesh_intersect(
+	        bm, looptris, tottri,
+	        bm_face_isect_pair, NULL,
+	        false, false, true, true, false,
+	        boolean_mode, 1e-6f);
+
+	MEM_freeN(looptris);
+	return has_isect;
+}
+
+#endif  /* __BLENDER_TESTING_BMESH_TEST_UTIL_H__ */
@@ -0,0 +1,194 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_threads.h"
+#include "DNA_constraint_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "BKE_constraint.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "IMB_imbuf.h"
+}
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_types.h"
+#include "intern/nodes/deg_node_component.h"
+#include "intern/nodes/deg_node_id.h"
+#include "intern/nodes/deg_node_operation.h"
+
+#include "util/deg_util_foreach.h"
+
+class depsgraph_builder_partial : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+		DEG_register_node_types();
+	}
+
+	static void TearDownTestCase()
+	{
+		DEG_free_node_types();
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		/* Freeing a scene looks for its users in G.main. */
+		G.main = bmain;
+		scene = BKE_scene_add(bmain, "Scene");
+		view_layer = (ViewLayer *)scene->view_layers.first;
+		ob_a = BKE_object_add(bmain, scene, view_layer, OB_EMPTY, "A");
+		ob_b = BKE_object_add(bmain, scene, view_layer, OB_EMPTY, "B");
+		ob_c = BKE_object_add(bmain, scene, view_layer, OB_EMPTY, "C");
+		/* Stored in the scene, so relations update tags reach it. */
+		depsgraph = BKE_scene_get_depsgraph(scene, view_layer, true);
+	}
+
+	void TearDown()
+	{
+		BKE_main_free(bmain);
+		G.main = NULL;
+	}
+
+	void graph_build()
+	{
+		DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+	}
+
+	/* Partial rebuild, as done after editing constraints of the object. */
+	void graph_relations_update(Object *object)
+	{
+		DEG_id_relations_tag_update(bmain, &object->id);
+		DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
+	}
+
+	bConstraint *copy_location_add(Object *object, Object *target)
+	{
+		bConstraint *con = BKE_constraint_add_for_object(object, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+		((bLocateLikeConstraint *)con->data)->tar = target;
+		return con;
+	}
+
+	DEG::Depsgraph *deg_graph()
+	{
+		return (DEG::Depsgraph *)depsgraph;
+	}
+
+	/* Whether any operation of object_to depends on an operation of object_from. */
+	bool has_relation(Object *object_from, Object *object_to)
+	{
+		DEG::IDDepsNode *id_node = deg_graph()->find_id_node(&object_from->id);
+		bool found = false;
+		GHASH_FOREACH_BEGIN(DEG::ComponentDepsNode *, comp_node, id_node->components)
+		{
+			foreach (DEG::OperationDepsNode *op_node, comp_node->operations) {
+				foreach (DEG::DepsRelation *rel, op_node->outlinks) {
+					DEG::OperationDepsNode *to = (DEG::OperationDepsNode *)rel->to;
+					if (to->owner->owner->id_orig == &object_to->id) {
+						found = true;
+					}
+				}
+			}
+		}
+		GHASH_FOREACH_END();
+		return found;
+	}
+
+	/* Whether two relations link the same operations of the object by the same name. */
+	bool has_duplicate_relations(Object *object)
+	{
+		DEG::IDDepsNode *id_node = deg_graph()->find_id_node(&object->id);
+		bool found = false;
+		GHASH_FOREACH_BEGIN(DEG::ComponentDepsNode *, comp_node, id_node->components)
+		{
+			foreach (DEG::OperationDepsNode *op_node, comp_node->operations) {
+				const DEG::DepsNode::Relations& links = op_node->outlinks;
+				for (size_t i = 0; i < links.size(); i++) {
+					for (size_t j = i + 1; j < links.size(); j++) {
+						if (links[i]->to == links[j]->to && STREQ(links[i]->name, links[j]->name)) {
+							found = true;
+						}
+					}
+				}
+			}
+		}
+		GHASH_FOREACH_END();
+		return found;
+	}
+
+	bool has_cycles()
+	{
+		foreach (DEG::OperationDepsNode *op_node, deg_graph()->operations) {
+			foreach (DEG::DepsRelation *rel, op_node->outlinks) {
+				if (rel->flag & DEG::DEPSREL_FLAG_CYCLIC) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	Main *bmain;
+	Scene *scene;
+	ViewLayer *view_layer;
+	Object *ob_a, *ob_b, *ob_c;
+	Depsgraph *depsgraph;
+};
+
+TEST_F(depsgraph_builder_partial, ConstraintTargetRemoved)
+{
+	bConstraint *con = copy_location_add(ob_a, ob_b);
+	graph_build();
+	EXPECT_TRUE(has_relation(ob_b, ob_a));
+
+	BKE_constraint_remove(&ob_a->constraints, con);
+	graph_relations_update(ob_a);
+	EXPECT_FALSE(has_relation(ob_b, ob_a));
+	EXPECT_FALSE(has_cycles());
+}
+
+TEST_F(depsgraph_builder_partial, ConstraintTargetSwapped)
+{
+	/* With the old relation kept, B -> A and A -> B would form a cycle. */
+	bConstraint *con = copy_location_add(ob_a, ob_b);
+	graph_build();
+
+	BKE_constraint_remove(&ob_a->constraints, con);
+	graph_relations_update(ob_a);
+	copy_location_add(ob_b, ob_a);
+	graph_relations_update(ob_b);
+
+	EXPECT_TRUE(has_relation(ob_a, ob_b));
+	EXPECT_FALSE(has_relation(ob_b, ob_a));
+	EXPECT_FALSE(has_cycles());
+}
+
+TEST_F(depsgraph_builder_partial, DependentKept)
+{
+	/* Relations built by objects which are not rebuilt are restored. */
+	copy_location_add(ob_c, ob_a);
+	copy_location_add(ob_a, ob_b);
+	graph_build();
+	EXPECT_TRUE(has_relation(ob_a, ob_c));
+
+	graph_relations_update(ob_a);
+	EXPECT_TRUE(has_relation(ob_a, ob_c));
+	EXPECT_TRUE(has_relation(ob_b, ob_a));
+	/* Restored relations which were built again are not duplicated. */
+	EXPECT_FALSE(has_duplicate_relations(ob_a));
+	EXPECT_FALSE(has_cycles());
+}
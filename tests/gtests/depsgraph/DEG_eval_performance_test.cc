@@ -0,0 +1,110 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "IMB_imbuf.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+/* Run the longest tests! */
+//#define DEG_EVAL_RUN_BIG
+
+#ifdef DEG_EVAL_RUN_BIG
+#  define DEG_EVAL_TOTCHAIN 2000
+#else
+#  define DEG_EVAL_TOTCHAIN 200
+#endif
+
+/* One long parent chain, the other chains are short, so the order
+ * in which ready operations are picked matters. */
+#define DEG_EVAL_LONG_CHAIN 200
+#define DEG_EVAL_SHORT_CHAIN 4
+#define DEG_EVAL_ITER 1000
+
+class depsgraph_eval : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+		DEG_register_node_types();
+	}
+
+	static void TearDownTestCase()
+	{
+		DEG_free_node_types();
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+
+	void SetUp()
+	{
+		bmain = BKE_main_new();
+		/* Freeing a scene looks for its users in G.main. */
+		G.main = bmain;
+		scene = BKE_scene_add(bmain, "Scene");
+		view_layer = (ViewLayer *)scene->view_layers.first;
+
+		for (int chain = 0; chain < DEG_EVAL_TOTCHAIN; chain++) {
+			const int length = (chain == 0) ? DEG_EVAL_LONG_CHAIN : DEG_EVAL_SHORT_CHAIN;
+			Object *parent = NULL;
+			for (int i = 0; i < length; i++) {
+				char name[MAX_ID_NAME - 2];
+				BLI_snprintf(name, sizeof(name), "Empty%d.%d", chain, i);
+				Object *ob = BKE_object_add(bmain, scene, view_layer, OB_EMPTY, name);
+				ob->parent = parent;
+				parent = ob;
+			}
+		}
+
+		depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_VIEWPORT);
+		DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+		DEG_evaluate_on_refresh(depsgraph);
+	}
+
+	void TearDown()
+	{
+		DEG_graph_free(depsgraph);
+		BKE_main_free(bmain);
+		G.main = NULL;
+	}
+
+	void tag_all_objects()
+	{
+		for (Object *ob = (Object *)bmain->object.first; ob; ob = (Object *)ob->id.next) {
+			DEG_graph_id_tag_update(bmain, depsgraph, &ob->id, OB_RECALC_OB);
+		}
+	}
+
+	Main *bmain;
+	Scene *scene;
+	ViewLayer *view_layer;
+	Depsgraph *depsgraph;
+};
+
+TEST_F(depsgraph_eval, Performance)
+{
+	printf("\n========== %d objects, %d threads ==========\n",
+	       BLI_listbase_count(&bmain->object), BLI_system_thread_count());
+
+	TIMEIT_START(depsgraph_eval_transform);
+	for (int iter = 0; iter < DEG_EVAL_ITER; iter++) {
+		tag_all_objects();
+		DEG_evaluate_on_refresh(depsgraph);
+	}
+	TIMEIT_END(depsgraph_eval_transform);
+}
@@ -0,0 +1,65 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_filter.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "IMB_test_util.h"
+
+/* Run the longest tests! Uses an 8K image. */
+//#define CONVERSION_RUN_BIG
+
+#ifdef CONVERSION_RUN_BIG
+#  define IMB_WIDTH 7680
+#  define IMB_HEIGHT 4320
+#else
+#  define IMB_WIDTH 1920
+#  define IMB_HEIGHT 1080
+#endif
+
+TEST(imbuf_conversion, Performance)
+{
+	float *rect_float = random_float_rect(IMB_WIDTH, IMB_HEIGHT);
+	uchar *rect_byte = (uchar *)MEM_mallocN(sizeof(uchar) * IMB_WIDTH * IMB_HEIGHT * 4, __func__);
+
+	printf("\n========== %dx%d RGBA ==========\n", IMB_WIDTH, IMB_HEIGHT);
+
+	TIMEIT_START(byte_from_float);
+	IMB_buffer_byte_from_float(rect_byte, rect_float, 4, 0.0f, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false,
+	                           IMB_WIDTH, IMB_HEIGHT, IMB_WIDTH, IMB_WIDTH);
+	TIMEIT_END(byte_from_float);
+
+	TIMEIT_START(byte_from_float_predivide);
+	IMB_buffer_byte_from_float(rect_byte, rect_float, 4, 0.0f, IB_PROFILE_SRGB, IB_PROFILE_SRGB, true,
+	                           IMB_WIDTH, IMB_HEIGHT, IMB_WIDTH, IMB_WIDTH);
+	TIMEIT_END(byte_from_float_predivide);
+
+	TIMEIT_START(byte_from_float_dither);
+	IMB_buffer_byte_from_float(rect_byte, rect_float, 4, 1.0f, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false,
+	                           IMB_WIDTH, IMB_HEIGHT, IMB_WIDTH, IMB_WIDTH);
+	TIMEIT_END(byte_from_float_dither);
+
+	TIMEIT_START(byte_from_float_linear_to_srgb);
+	IMB_buffer_byte_from_float(rect_byte, rect_float, 4, 0.0f, IB_PROFILE_SRGB, IB_PROFILE_LINEAR_RGB, false,
+	                           IMB_WIDTH, IMB_HEIGHT, IMB_WIDTH, IMB_WIDTH);
+	TIMEIT_END(byte_from_float_linear_to_srgb);
+
+	TIMEIT_START(float_from_byte);
+	IMB_buffer_float_from_byte(rect_float, rect_byte, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false,
+	                           IMB_WIDTH, IMB_HEIGHT, IMB_WIDTH, IMB_WIDTH);
+	TIMEIT_END(float_from_byte);
+
+	TIMEIT_START(premultiply_float);
+	IMB_premultiply_rect_float(rect_float, 4, IMB_WIDTH, IMB_HEIGHT);
+	TIMEIT_END(premultiply_float);
+
+	MEM_freeN(rect_float);
+	MEM_freeN(rect_byte);
+}
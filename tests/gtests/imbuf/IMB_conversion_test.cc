@@ -0,0 +1,155 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math_color.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_filter.h"
+#include "IMB_conversion_intern.h"
+}
+
+#include "IMB_test_util.h"
+
+/* Widths which are not a multiple of the 4 pixels the SIMD kernels process at once. */
+static const int test_widths[] = {1, 2, 3, 4, 5, 7, 1923};
+#define TEST_HEIGHT 3
+
+static void byte_from_float(uchar *rect_byte, const float *rect_float, int width,
+                            float dither, int profile_from, bool predivide)
+{
+	IMB_buffer_byte_from_float(rect_byte, rect_float, 4, dither, IB_PROFILE_SRGB, profile_from, predivide,
+	                           width, TEST_HEIGHT, width, width);
+}
+
+#ifdef __SSE2__
+static void byte_from_float_compare(float dither, bool to_srgb, bool predivide, int max_diff)
+{
+	for (int w = 0; w < ARRAY_SIZE(test_widths); w++) {
+		const int width = test_widths[w];
+		const size_t len = ((size_t)width) * 4;
+		float *rect_float = random_float_rect(width, TEST_HEIGHT);
+		uchar *row_simd = (uchar *)MEM_mallocN(sizeof(uchar) * len, __func__);
+		uchar *row_scalar = (uchar *)MEM_mallocN(sizeof(uchar) * len, __func__);
+
+		for (int y = 0; y < TEST_HEIGHT; y++) {
+			const float *from = rect_float + y * len;
+			const float t = (float)y / TEST_HEIGHT;
+
+			imb_float_to_byte_row_sse(row_simd, from, width, to_srgb, predivide, dither, 1.0f / width, t);
+			imb_float_to_byte_row(row_scalar, from, width, to_srgb, predivide, dither, 1.0f / width, t);
+
+			for (size_t i = 0; i < len; i++) {
+				EXPECT_NEAR(row_simd[i], row_scalar[i], max_diff) << "width " << width << ", row " << y << ", index " << i;
+			}
+		}
+
+		MEM_freeN(rect_float);
+		MEM_freeN(row_simd);
+		MEM_freeN(row_scalar);
+	}
+}
+#endif
+
+TEST(imbuf_conversion, ByteFromFloat)
+{
+	const int width = 1923;
+	const size_t len = ((size_t)width) * TEST_HEIGHT;
+	float *rect_float = random_float_rect(width, TEST_HEIGHT);
+	uchar *rect_byte = (uchar *)MEM_mallocN(sizeof(uchar) * len * 4, __func__);
+
+	byte_from_float(rect_byte, rect_float, width, 0.0f, IB_PROFILE_SRGB, false);
+	for (size_t i = 0; i < len * 4; i++) {
+		EXPECT_EQ(rect_byte[i], (uchar)FTOCHAR(rect_float[i]));
+	}
+
+	byte_from_float(rect_byte, rect_float, width, 0.0f, IB_PROFILE_LINEAR_RGB, false);
+	for (size_t i = 0; i < len; i++) {
+		uchar expected[4];
+		linearrgb_to_srgb_uchar4(expected, &rect_float[i * 4]);
+		for (int j = 0; j < 4; j++) {
+			EXPECT_NEAR(rect_byte[i * 4 + j], expected[j], 1);
+		}
+	}
+
+	MEM_freeN(rect_float);
+	MEM_freeN(rect_byte);
+}
+
+#ifdef __SSE2__
+TEST(imbuf_conversion, ByteFromFloatPlain)
+{
+	byte_from_float_compare(0.0f, false, false, 0);
+}
+
+TEST(imbuf_conversion, ByteFromFloatPredivide)
+{
+	byte_from_float_compare(0.0f, false, true, 0);
+}
+
+TEST(imbuf_conversion, ByteFromFloatDither)
+{
+	byte_from_float_compare(1.0f, false, false, 0);
+}
+
+TEST(imbuf_conversion, ByteFromFloatDitherPredivide)
+{
+	byte_from_float_compare(1.0f, false, true, 0);
+}
+
+/* The SIMD kernel approximates the power function and the scalar code uses a lookup table,
+ * both can be one level off from the exact conversion in opposite directions. */
+TEST(imbuf_conversion, ByteFromFloatLinear)
+{
+	BLI_init_srgb_conversion();
+	byte_from_float_compare(0.0f, true, false, 2);
+	byte_from_float_compare(0.0f, true, true, 2);
+	byte_from_float_compare(1.0f, true, false, 2);
+	byte_from_float_compare(1.0f, true, true, 2);
+}
+
+TEST(imbuf_conversion, FloatFromByte)
+{
+	for (int w = 0; w < ARRAY_SIZE(test_widths); w++) {
+		const int width = test_widths[w];
+		const size_t len = ((size_t)width) * 4;
+		uchar *row_byte = (uchar *)MEM_mallocN(sizeof(uchar) * len, __func__);
+		float *row_simd = (float *)MEM_mallocN(sizeof(float) * len, __func__);
+		float *row_scalar = (float *)MEM_mallocN(sizeof(float) * len, __func__);
+
+		for (size_t i = 0; i < len; i++) {
+			row_byte[i] = (uchar)(i * 37);
+		}
+
+		imb_byte_to_float_row_sse(row_simd, row_byte, width);
+		imb_byte_to_float_row(row_scalar, row_byte, width);
+
+		EXPECT_EQ(memcmp(row_simd, row_scalar, sizeof(float) * len), 0) << "width " << width;
+
+		MEM_freeN(row_byte);
+		MEM_freeN(row_simd);
+		MEM_freeN(row_scalar);
+	}
+}
+
+TEST(imbuf_conversion, PremultiplyFloat)
+{
+	for (int w = 0; w < ARRAY_SIZE(test_widths); w++) {
+		const int width = test_widths[w];
+		const size_t len = ((size_t)width) * TEST_HEIGHT * 4;
+		float *rect_simd = random_float_rect(width, TEST_HEIGHT);
+		float *rect_scalar = (float *)MEM_dupallocN(rect_simd);
+
+		imb_premultiply_float_row_sse(rect_simd, ((size_t)width) * TEST_HEIGHT);
+		imb_premultiply_float_row(rect_scalar, ((size_t)width) * TEST_HEIGHT);
+
+		EXPECT_EQ(memcmp(rect_simd, rect_scalar, sizeof(float) * len), 0) << "width " << width;
+
+		MEM_freeN(rect_simd);
+		MEM_freeN(rect_scalar);
+	}
+}
+#endif
@@ -0,0 +1,86 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_threads.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "IMB_test_util.h"
+
+/* Run the longest tests! */
+//#define SCALING_RUN_BIG
+
+#ifdef SCALING_RUN_BIG
+#  define SCALING_ITERATIONS 10
+#else
+#  define SCALING_ITERATIONS 1
+#endif
+
+class imbuf_scaling : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(imbuf_scaling, Performance)
+{
+	const struct {
+		const char *name;
+		IMB_ScaleFilter filter;
+	} filters[] = {
+	    {"box", IMB_SCALE_FILTER_BOX},
+	    {"bilinear", IMB_SCALE_FILTER_BILINEAR},
+	    {"mitchell", IMB_SCALE_FILTER_MITCHELL},
+	    {"lanczos", IMB_SCALE_FILTER_LANCZOS},
+	};
+	const struct {
+		const char *name;
+		int flags;
+	} buffers[] = {
+	    {"byte", IB_rect},
+	    {"float", IB_rectfloat},
+	};
+
+	printf("\n========== 7680x4320 to 1920x1080 ==========\n");
+
+	for (int b = 0; b < ARRAY_SIZE(buffers); b++) {
+		ImBuf *ibuf_src = random_imbuf(7680, 4320, buffers[b].flags);
+
+		{
+			ImBuf *ibuf = IMB_dupImBuf(ibuf_src);
+			printf("%s, IMB_scaleImBuf:\n", buffers[b].name);
+			TIMEIT_START(scale);
+			IMB_scaleImBuf(ibuf, 1920, 1080);
+			TIMEIT_END(scale);
+			IMB_freeImBuf(ibuf);
+		}
+
+		for (int f = 0; f < ARRAY_SIZE(filters); f++) {
+			printf("%s, %s:\n", buffers[b].name, filters[f].name);
+			TIMEIT_START(scale_filter);
+			for (int i = 0; i < SCALING_ITERATIONS; i++) {
+				ImBuf *ibuf = IMB_dupImBuf(ibuf_src);
+				IMB_scaleImBuf_filter(ibuf, 1920, 1080, filters[f].filter);
+				IMB_freeImBuf(ibuf);
+			}
+			TIMEIT_END(scale_filter);
+		}
+
+		IMB_freeImBuf(ibuf_src);
+	}
+}
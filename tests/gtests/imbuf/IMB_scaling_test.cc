@@ -0,0 +1,96 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <string.h>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+#include "IMB_test_util.h"
+
+class imbuf_scaling : public testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(imbuf_scaling, ConstantColor)
+{
+	const IMB_ScaleFilter filters[] = {
+	    IMB_SCALE_FILTER_BOX, IMB_SCALE_FILTER_BILINEAR, IMB_SCALE_FILTER_MITCHELL, IMB_SCALE_FILTER_LANCZOS};
+	const int sizes[][2] = {{37, 21}, {200, 150}, {1, 1}};
+
+	for (int f = 0; f < ARRAY_SIZE(filters); f++) {
+		for (int s = 0; s < ARRAY_SIZE(sizes); s++) {
+			ImBuf *ibuf = IMB_allocImBuf(100, 75, 32, IB_rect | IB_rectfloat);
+			const unsigned char color[4] = {200, 100, 50, 255};
+
+			for (int i = 0; i < ibuf->x * ibuf->y; i++) {
+				memcpy(&ibuf->rect[i], color, sizeof(color));
+				copy_v4_fl4(&ibuf->rect_float[i * 4], 0.25f, 0.5f, 0.75f, 1.0f);
+			}
+
+			EXPECT_TRUE(IMB_scaleImBuf_filter(ibuf, sizes[s][0], sizes[s][1], filters[f]));
+			EXPECT_EQ(ibuf->x, sizes[s][0]);
+			EXPECT_EQ(ibuf->y, sizes[s][1]);
+
+			for (int i = 0; i < ibuf->x * ibuf->y; i++) {
+				const unsigned char *cp = (unsigned char *)&ibuf->rect[i];
+				for (int c = 0; c < 4; c++) {
+					EXPECT_NEAR(cp[c], color[c], 1);
+				}
+				EXPECT_NEAR(ibuf->rect_float[i * 4 + 0], 0.25f, 1e-5f);
+				EXPECT_NEAR(ibuf->rect_float[i * 4 + 3], 1.0f, 1e-5f);
+			}
+
+			IMB_freeImBuf(ibuf);
+		}
+	}
+}
+
+/* Buffers not owned by the ImBuf can't be reused, the result must match the in place scaling. */
+TEST_F(imbuf_scaling, InPlace)
+{
+	const int sizes[][2] = {{37, 21}, {100, 20}, {300, 10}, {150, 100}};
+
+	for (int s = 0; s < ARRAY_SIZE(sizes); s++) {
+		ImBuf *ibuf = random_imbuf(100, 75, IB_rect | IB_rectfloat);
+		ImBuf *ibuf_ref = IMB_dupImBuf(ibuf);
+		unsigned int *rect_ref = ibuf_ref->rect;
+		float *rect_float_ref = ibuf_ref->rect_float;
+
+		ibuf_ref->mall &= ~(IB_rect | IB_rectfloat);
+
+		EXPECT_TRUE(IMB_scaleImBuf_filter(ibuf, sizes[s][0], sizes[s][1], IMB_SCALE_FILTER_MITCHELL));
+		EXPECT_TRUE(IMB_scaleImBuf_filter(ibuf_ref, sizes[s][0], sizes[s][1], IMB_SCALE_FILTER_MITCHELL));
+		EXPECT_NE(ibuf_ref->rect, rect_ref);
+		EXPECT_NE(ibuf_ref->rect_float, rect_float_ref);
+
+		const size_t len = ((size_t)sizes[s][0]) * sizes[s][1];
+		EXPECT_EQ(MEM_allocN_len(ibuf->rect), sizeof(unsigned int) * len);
+		EXPECT_EQ(MEM_allocN_len(ibuf->rect_float), sizeof(float) * 4 * len);
+		EXPECT_EQ(memcmp(ibuf->rect, ibuf_ref->rect, sizeof(unsigned int) * len), 0);
+		EXPECT_EQ(memcmp(ibuf->rect_float, ibuf_ref->rect_float, sizeof(float) * 4 * len), 0);
+
+		MEM_freeN(rect_ref);
+		MEM_freeN(rect_float_ref);
+		IMB_freeImBuf(ibuf);
+		IMB_freeImBuf(ibuf_ref);
+	}
+}
@@ -0,0 +1,56 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __BLENDER_TESTING_IMB_TEST_UTIL_H__
+#define __BLENDER_TESTING_IMB_TEST_UTIL_H__
+
+/* Fixture factories shared by the imbuf correctness and performance tests. */
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_rand.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+/* Image with random byte and float pixels, for the buffers in flags. */
+inline ImBuf *random_imbuf(int width, int height, int flags)
+{
+	ImBuf *ibuf = IMB_allocImBuf(width, height, 32, flags);
+	RNG *rng = BLI_rng_new(0);
+	const size_t len = ((size_t)width) * height * 4;
+
+	if (ibuf->rect) {
+		unsigned char *cp = (unsigned char *)ibuf->rect;
+		for (size_t i = 0; i < len; i++) {
+			cp[i] = BLI_rng_get_uint(rng) & 0xff;
+		}
+	}
+	if (ibuf->rect_float) {
+		for (size_t i = 0; i < len; i++) {
+			ibuf->rect_float[i] = BLI_rng_get_float(rng);
+		}
+	}
+	BLI_rng_free(rng);
+	return ibuf;
+}
+
+/* Random premultiplied RGBA pixels, slightly out of range to test clamping, with some zero alpha. */
+inline float *random_float_rect(int width, int height)
+{
+	const size_t len = ((size_t)width) * height;
+	float *rect = (float *)MEM_mallocN(sizeof(float) * 4 * len, __func__);
+	RNG *rng = BLI_rng_new(0);
+
+	for (size_t i = 0; i < len; i++) {
+		const float alpha = (i % 7 == 0) ? 0.0f : BLI_rng_get_float(rng);
+		for (int j = 0; j < 3; j++) {
+			rect[i * 4 + j] = (BLI_rng_get_float(rng) * 1.2f - 0.1f) * ((alpha != 0.0f) ? alpha : 1.0f);
+		}
+		rect[i * 4 + 3] = alpha;
+	}
+	BLI_rng_free(rng);
+	return rect;
+}
+
+#endif  /* __BLENDER_TESTING_IMB_TEST_UTIL_H__ */
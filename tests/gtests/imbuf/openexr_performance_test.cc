@@ -0,0 +1,107 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "DNA_scene_types.h"
+#include "PIL_time_utildefines.h"
+#include "openexr/openexr_api.h"
+#include "openexr/openexr_multi.h"
+}
+
+/* Run the longest tests! Writes an 8K file of several GB. */
+//#define EXR_RUN_BIG
+
+#ifdef EXR_RUN_BIG
+#  define EXR_WIDTH 7680
+#  define EXR_HEIGHT 4320
+#else
+#  define EXR_WIDTH 1920
+#  define EXR_HEIGHT 1080
+#endif
+
+#define EXR_TOT_PASS 40
+#define EXR_LAYER "RenderLayer"
+#define EXR_FILEPATH "openexr_performance_test.exr"
+
+static const char *exr_chan_ids = "RGBA";
+
+static void exr_pass_name(char *name, size_t maxlen, int pass, int chan)
+{
+	BLI_snprintf(name, maxlen, "Pass%02d.%c", pass, exr_chan_ids[chan]);
+}
+
+/* All passes share the same buffer, only the file size matters here. */
+static void exr_write_test_file(float *rect)
+{
+	void *exrhandle = IMB_exr_get_handle();
+	char name[64];
+
+	for (int pass = 0; pass < EXR_TOT_PASS; pass++) {
+		for (int chan = 0; chan < 4; chan++) {
+			exr_pass_name(name, sizeof(name), pass, chan);
+			IMB_exr_add_channel(exrhandle, EXR_LAYER, name, "", 4, 4 * EXR_WIDTH, rect + chan, true);
+		}
+	}
+
+	TIMEIT_START(exr_write);
+	EXPECT_TRUE(IMB_exr_begin_write(exrhandle, EXR_FILEPATH, EXR_WIDTH, EXR_HEIGHT, R_IMF_EXR_CODEC_ZIP, NULL));
+	IMB_exr_write_channels(exrhandle);
+	IMB_exr_close(exrhandle);
+	TIMEIT_END(exr_write);
+}
+
+static void exr_read_test_file(float *rect, int totpass)
+{
+	void *exrhandle = IMB_exr_get_handle();
+	int width, height;
+	char name[64];
+
+	EXPECT_TRUE(IMB_exr_begin_read(exrhandle, EXR_FILEPATH, &width, &height));
+	EXPECT_EQ(width, EXR_WIDTH);
+	EXPECT_EQ(height, EXR_HEIGHT);
+
+	for (int pass = 0; pass < totpass; pass++) {
+		for (int chan = 0; chan < 4; chan++) {
+			exr_pass_name(name, sizeof(name), pass, chan);
+			IMB_exr_set_channel(exrhandle, EXR_LAYER, name, 4, 4 * width, rect + chan);
+		}
+	}
+
+	IMB_exr_read_channels(exrhandle);
+	IMB_exr_close(exrhandle);
+}
+
+TEST(openexr, ReadSinglePass)
+{
+	const size_t size = sizeof(float) * 4 * EXR_WIDTH * EXR_HEIGHT;
+	float *rect = (float *)MEM_mapallocN(size, __func__);
+
+	imb_initopenexr();
+
+	for (size_t i = 0; i < size / sizeof(float); i++) {
+		rect[i] = (float)(i % 1024) / 1024.0f;
+	}
+	exr_write_test_file(rect);
+
+	printf("\n========== %d passes of %dx%d ==========\n", EXR_TOT_PASS, EXR_WIDTH, EXR_HEIGHT);
+
+	/* every pass is read into the same buffer */
+	TIMEIT_START(exr_read_all_passes);
+	exr_read_test_file(rect, EXR_TOT_PASS);
+	TIMEIT_END(exr_read_all_passes);
+
+	TIMEIT_START(exr_read_one_pass);
+	exr_read_test_file(rect, 1);
+	TIMEIT_END(exr_read_one_pass);
+
+	/* half float round trip */
+	EXPECT_NEAR(rect[4 * (EXR_WIDTH / 3) + 1], (float)((4 * (EXR_WIDTH / 3) + 1) % 1024) / 1024.0f, 1e-3f);
+
+	BLI_delete(EXR_FILEPATH, false, false);
+	MEM_freeN(rect);
+}